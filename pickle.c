@@ -22,7 +22,7 @@
 // - Requires that the vc4 KMS driver is active (dtoverlay=vc4-kms-v3d in config.txt).
 // - Executes fullscreen on the first connected display.
 // - Uses DRM master (needs root or CAP_SYS_ADMIN typically unless logind grants).
-// - Simplified: No vsync timing logic beyond drmModePageFlip blocking event.
+// - Frames are scheduled against kernel vblank timestamps (sched_* helpers, PICKLE_SCHED=0 disables).
 // - Error handling is compressed into CHECK()/RET() helpers for brevity.
 //
 // If mpv was built without OpenGL/EGL support this will fail.
@@ -40,15 +40,27 @@
 #include <signal.h>
 #include <execinfo.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <stddef.h>
+#include <stdarg.h>
 #include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <termios.h>
 #include <linux/joystick.h>
+#include <linux/input.h>
+#include <sys/timerfd.h>
 #include <getopt.h>
 
 #include <xf86drm.h>
 #include <xf86drmMode.h>
+#include <drm_fourcc.h>
 #include <gbm.h>
 #include <sys/ioctl.h>
 
@@ -63,6 +75,8 @@
 #include <mpv/render.h>
 #include <mpv/render_gl.h>
 
+#include "warp.h"
+
 // Version information for production debugging
 #define PICKLE_VERSION_MAJOR 1
 #define PICKLE_VERSION_MINOR 0
@@ -198,6 +212,20 @@ struct kms_ctx {
 	uint32_t crtc_id;
 	uint32_t connector_id;
 	drmModeModeInfo mode;
+	// Atomic modesetting (set by init_atomic; legacy SetCrtc/PageFlip used when 0)
+	int atomic;
+	int crtc_index;              // index of crtc_id in res->crtcs (for plane possible_crtcs)
+	uint32_t plane_id;           // primary plane driving crtc_id
+	int overlay_planes;          // overlay planes usable on this CRTC
+	uint32_t overlay_plane_id;   // first of them (the one mpv's drmprime-overlay interop picks)
+	struct { uint32_t fb_id, crtc_id; } overlay_prop;
+	uint32_t mode_blob_id;       // MODE_ID blob for the selected mode
+	struct {
+		uint32_t fb_id, crtc_id, src_x, src_y, src_w, src_h;
+		uint32_t crtc_x, crtc_y, crtc_w, crtc_h, in_fence_fd;
+	} plane_prop;
+	struct { uint32_t active, mode_id; } crtc_prop;
+	uint32_t conn_prop_crtc_id;
 };
 
 struct egl_ctx {
@@ -207,19 +235,81 @@ struct egl_ctx {
 	EGLConfig config;
 	EGLContext ctx;
 	EGLSurface surf;
+	// EGL_ANDROID_native_fence_sync: GPU completion fence handed to KMS as IN_FENCE_FD
+	int native_fence;
+	PFNEGLCREATESYNCKHRPROC create_sync;
+	PFNEGLDESTROYSYNCKHRPROC destroy_sync;
+	PFNEGLDUPNATIVEFENCEFDANDROIDPROC dup_native_fence_fd;
+	// EGLImage render targets for the scanout FB ring
+	int dmabuf_modifiers;        // EGL_EXT_image_dma_buf_import_modifiers
+	PFNEGLCREATEIMAGEKHRPROC create_image;
+	PFNEGLDESTROYIMAGEKHRPROC destroy_image;
+	PFNGLEGLIMAGETARGETRENDERBUFFERSTORAGEOESPROC image_target_renderbuffer;
 };
 
 // Forward declaration for vsync toggle used before its definition
 static int g_vsync_enabled;
 
-// --- Preallocated FB ring (optional) ---
-struct fb_ring_entry { struct gbm_bo *bo; uint32_t fb_id; };
+// Zero-copy hwdec support (set during init_gbm_egl/main, consumed by init_mpv)
+static int g_egl_dmabuf_import = 0;           // EGL can import DMA-BUF frames as EGLImages
+static const struct kms_ctx *g_kms_for_mpv = NULL; // DRM handles passed to mpv for drmprime interop
+
+// Atomic KMS state shared between the scanout tail and mpv's drmprime-overlay interop
+static _Atomic int g_video_plane = 0;         // mpv puts decoded frames on a KMS overlay plane right now
+static _Atomic int g_video_plane_wanted = 0;  // PICKLE_VIDEO_PLANE and still possible (whenever no GL overlay is on)
+static drmModeAtomicReq *g_atomic_req = NULL; // request for the next commit (mpv adds its plane props here)
+static int g_video_plane_detach = 0;          // next primary-plane commit also switches the overlay plane off
+static int g_video_plane_refill = 0;          // render thread: black primary frame queued, the video frame follows
+
+// --- Scanout FB ring (PICKLE_FB_RING) ---
+// Explicitly allocated scanout BOs, each with its FB id and an EGLImage-backed FBO
+// created at startup. Frames are composed straight into the next entry, so the
+// per-frame path does no allocation or drmModeAddFB.
+struct fb_ring_entry {
+    struct gbm_bo *bo;
+    uint32_t fb_id;
+    EGLImageKHR image;  // bo imported through its DMA-BUF
+    GLuint rbo;         // colour renderbuffer bound to image
+    GLuint fbo;         // render target for this entry
+    int busy;           // rendering, queued, in flight or on screen
+};
 struct fb_ring {
     struct fb_ring_entry *entries;
-    int count;      // allocated entries
-    int produced;   // how many unique BOs discovered during prealloc
-    int active;     // number of BOs currently in use (for triple buffering)
-    int next_index; // next index to use
+    int count;      // allocated entries (0 = render through the EGL window surface)
+    int active;     // number of entries currently busy
+    int next_index; // next entry handed out (entries are released in flip order)
+    int drm_fd;     // for drmModeRmFB on teardown
+};
+
+// --- Page flip queue ---
+// Frames that finished rendering, oldest first. KMS accepts one pending flip per CRTC,
+// so only the head is ever in flight; the rest wait and are submitted from the flip
+// event. Completions are dispatched by the render loop's poll(); nothing waits for one.
+// A BO is never released on a guess: a flip whose event is lost (or that a reset retires)
+// is parked with the BO on screen kept locked until the kernel accepts the next commit or
+// the late event arrives (either proves it landed), and the queue moves on meanwhile.
+#define FLIP_QUEUE_MAX 3
+#define FLIP_TIMEOUT_US 100000 // In-flight flip with no event after this is counted as late
+#define FLIP_LOST_US 500000    // ... and after this it is parked so later frames can go out
+struct flip_entry {
+	struct gbm_bo *bo;  // NULL for video plane commits (mpv owns those buffers)
+	uint32_t fb_id;     // 0 leaves the primary plane untouched
+	int in_fence;       // IN_FENCE_FD for atomic commits, -1 if none
+	int64_t queued_us;  // Render finished (CLOCK_MONOTONIC)
+	int64_t submit_us;  // Handed to KMS, 0 while still waiting
+	int late;           // Counted in g_wd.flip_timeouts already
+};
+struct flip_queue {
+	struct flip_entry slot[FLIP_QUEUE_MAX];
+	int head;
+	int len;
+	bool in_flight;          // slot[head] has been submitted
+	uintptr_t seq;           // Submission counter, passed as flip event user data
+	struct gbm_bo *scanout;  // BO on screen; released once the next flip lands
+	struct gbm_bo *retired;  // Flip retired by a reset with no event yet (may still be pending)
+	uintptr_t retired_seq;   // Its sequence number
+	struct kms_ctx *kms;
+	struct egl_ctx *egl;
 };
 
 // Keystone correction structure
@@ -227,31 +317,107 @@ typedef struct {
     float points[4][2];      // Normalized corner coordinates [0.0-1.0]
     int active_corner;       // Which corner is currently being adjusted (-1 = none)
     bool enabled;            // Whether keystone correction is enabled
-    float matrix[16];        // The transformation matrix for rendering
+    float matrix[16];        // Homography unit square -> clip space (column-major mat4)
+    float matrix_points[4][2];// Corner positions matrix was computed from (staleness check)
     bool mesh_enabled;       // Whether to use mesh-based warping instead of simple 4-point
     int mesh_size;           // Mesh grid size (e.g., 4 = 4x4 grid)
-    float **mesh_points;     // Dynamic mesh control points [mesh_size][mesh_size][2]
+    float *mesh_x;           // Mesh control points (SoA, row-major): x[r * mesh_size + c]
+    float *mesh_y;           // y coordinates; same 16-byte aligned block as mesh_x (see keystone_mesh_alloc)
     int active_mesh_point[2];// Active mesh point coordinates (x,y) or (-1,-1) for none
     bool perspective_pins[4];// Whether each corner is pinned (fixed) during adjustments
+    float blend[4];          // Soft-edge widths (left, right, top, bottom) as image fractions, 0 = hard edge
+    unsigned geom_gen;       // Bumped on every geometry change (corners, pins or config); never cleared
 } keystone_t;
 
+// Persistent keystone quad: 4 interleaved vertices (TL, TR, BL, BR) of x, y, u*q, v*q, 0, q.
+// Uploaded once and re-uploaded only when the keystone's geom_gen or the texcoord range changes.
+typedef struct {
+    GLuint vbo;
+    GLuint vao;              // OES_vertex_array_object with cached attribute bindings (0 = unsupported)
+    float tex[4];            // u0, u1, v0, v1 baked into the texcoords
+    unsigned gen;            // Keystone geom_gen last uploaded
+} quad_geom_t;
+
+// Tessellated mesh-warp geometry built from keystone_t mesh_x/mesh_y.
+// Kept in a static VBO/IBO and rebuilt only when a control point or texcoord range changes.
+typedef struct {
+    GLuint vbo;              // Interleaved x,y,u,v per vertex
+    GLuint ibo;              // GL_TRIANGLES, 16-bit indices
+    GLsizei index_count;
+    int grid;                // Tessellated vertices per side
+    int src_size;            // mesh_size the geometry was built from (0 = not built)
+    float *src_points;       // Copy of control points (x plane, then y) for change detection
+    float tex[4];            // u0, u1, v0, v1 baked into the texcoords
+} mesh_geom_t;
+
+// Edge-blend mask for multi-projector overlaps: a luminance LUT over the quad's unit
+// square holding the gamma-corrected falloff, regenerated only when the blend widths change
+#define BLEND_LUT_SIZE 256
+#define BLEND_MAX_WIDTH 0.5f     // Widest soft edge, as a fraction of the image
+typedef struct {
+    GLuint tex;
+    int w, h;                // LUT size (1 along an axis without blending)
+    float built[4];          // Blend widths the LUT holds
+} blend_lut_t;
+
+// Offscreen mpv render target at GOV_LEVELS preallocated sizes (see the FBO governor).
+// Switching level never reallocates; the pool is rebuilt only when its base size changes.
+#define GOV_LEVELS 4
+typedef struct {
+    GLuint tex[GOV_LEVELS];
+    GLuint fbo[GOV_LEVELS];
+    int w[GOV_LEVELS], h[GOV_LEVELS];
+    int base_w, base_h;      // Level 0 size (0 = not allocated)
+    int format;              // Index into g_fbo_formats the levels were allocated with
+    int levels;              // Levels allocated: GOV_LEVELS, or 1 at gov_level's scale (low-memory mode)
+    int gov_level;           // Governor level the single low-memory level was sized for
+    uint64_t bytes;          // GPU memory held by the levels
+} fbo_pool_t;
+
+// Colour formats for the offscreen mpv targets, cheapest first. None needs alpha: mpv
+// draws opaque frames and the keystone passes blend with the sampled alpha, which reads
+// as 1 from an RGB texture. The Pi GPUs store RGB8 padded to 32 bits, so only RGB565
+// actually halves the write-then-read traffic; mpv dithers to the target depth it is given.
+typedef struct {
+    const char *name;
+    GLenum format, type;     // glTexImage2D format and type
+    GLenum internal;         // Sized format reported to mpv (mpv_opengl_fbo.internal_format)
+    int bytes;               // Bytes per pixel as stored by the GPU
+} fbo_format_t;
+static const fbo_format_t g_fbo_formats[] = {
+    { "rgb565", GL_RGB,  GL_UNSIGNED_SHORT_5_6_5, GL_RGB565,    2 },
+    { "rgb8",   GL_RGB,  GL_UNSIGNED_BYTE,        GL_RGB8_OES,  4 },
+    { "rgba8",  GL_RGBA, GL_UNSIGNED_BYTE,        GL_RGBA8_OES, 4 },
+};
+#define FBO_FORMATS ((int)(sizeof(g_fbo_formats) / sizeof(g_fbo_formats[0])))
+static int g_fbo_format = 0;  // Format new pools try first (PICKLE_FBO_FORMAT); moves down on rejection
+
 // Forward declaration for mpv player structure (matches typedef below)
 typedef struct mpv_player_struct mpv_player_t;
 
 // Video instance structure - encapsulates one video + keystone pair
-#define MAX_VIDEOS 2
+#ifndef MAX_VIDEOS
+#define MAX_VIDEOS 9              // Video wall: up to a 3x3 grid of warped sources
+#endif
 typedef struct video_instance {
-    mpv_player_t *player;         // Pointer to mpv player (allocated separately)
+    mpv_player_t *player;         // Pointer to mpv player (allocated separately); render thread only once it runs
     keystone_t keystone;          // Keystone settings for this video
-    GLuint fbo;                   // FBO for mpv render target
+    GLuint fbo;                   // FBO for mpv render target (current pool level)
     GLuint fbo_texture;           // Texture attached to FBO
     int fbo_w, fbo_h;             // FBO dimensions
+    fbo_pool_t pool;              // Preallocated FBO sizes the governor picks from
     char config_path[512];        // Path to keystone config file
-    int index;                    // Instance index (0 or 1)
+    int index;                    // Instance index (0..MAX_VIDEOS-1)
     const char *video_file;       // Path to video file
     volatile uint64_t update_flags; // mpv update flags for this instance
 	int use_subrect;              // Use texture sub-rectangle (single-mpv mode)
 	float u0, u1, v0, v1;         // Texture coordinates when use_subrect=1
+	mesh_geom_t mesh;             // Mesh-warp geometry for this instance's keystone
+	quad_geom_t quad;             // Persistent 4-corner quad for this instance's keystone
+	blend_lut_t blend;            // Edge-blend mask for this instance's keystone
+	int64_t pending_since_us;     // When the undrawn mpv frame became pending (0 = none)
+	int skipped;                  // Composites passed over while a frame was pending
+	int fbo_want_w, fbo_want_h;   // FBO base size from the budget and source (mv_assign_fbo_budgets)
 } video_instance_t;
 
 // Typedefs for clarity
@@ -259,6 +425,8 @@ typedef struct kms_ctx kms_ctx_t;
 typedef struct egl_ctx egl_ctx_t;
 typedef struct fb_ring fb_ring_t;
 typedef struct fb_ring_entry fb_ring_entry_t;
+typedef struct flip_entry flip_entry_t;
+typedef struct flip_queue flip_queue_t;
 
 // Forward declarations for keystone functions
 static void keystone_update_matrix(void);
@@ -274,30 +442,45 @@ static bool keystone_save_config(const char* path);
 static bool keystone_save_config_from(const char* path, const keystone_t *ks);
 static bool keystone_save_instance_config(video_instance_t *inst);
 static void cleanup_mesh_resources(void);
+static int mesh_grid_for(int n);
+static float *mesh_tessellate(const keystone_t *ks, float u0, float u1, float v0, float v1, float *out, int *grid_out);
+static bool mesh_geom_build_indices(mesh_geom_t *m, int grid);
+static void fbo_pool_destroy(fbo_pool_t *pool);
 
 // Global state 
 static fb_ring_t g_fb_ring = {0};
+static GLuint g_scanout_fbo = 0;    // Framebuffer the frame is composed into (current ring entry, or 0)
+static int g_scanout_y_flip = 0;    // Ring FBOs are scanned out top-row-first: flip GL's bottom-left origin
+static flip_queue_t g_flipq = {0};
 static int g_have_master = 0; // set if we successfully become DRM master
+static int g_scanout_disabled = 0; // when set, we skip page flips/modeset and just let mpv decode & render offscreen
 
 // Multi-video instance management
 static video_instance_t g_videos[MAX_VIDEOS] = {0};  // Array of video instances
-static int g_num_videos = 0;                          // Number of active video instances (1 or 2)
-static int g_active_corner_global = 0;                // Global corner index (0-7 for 2 videos, 0-3 for 1)
-                                                      // Corners 0-3 = video 0, corners 4-7 = video 1
-
-// Alternate frame rendering for dual-video performance
-static int g_alternate_frame_mode = 1;                // 1=enabled (default for dual video)
-static int g_render_frame_count = 0;                  // Frame counter for alternation
+static int g_num_videos = 0;                          // Number of active video instances (1..MAX_VIDEOS)
+static int g_active_corner_global = 0;                // Global corner index (0..4*g_num_videos-1)
+static int g_selected_video = 0;                      // Instance whose corners keys 1-4 select (multi-video)
+static bool g_select_video_pending = false;           // 'v' pressed: the next digit picks the instance
+                                                      // Corners 0-3 = video 0, corners 4-7 = video 1, ...
+
+// Multi-video update scheduling: only some instances re-render their mpv FBO per composite
+static int g_alternate_frame_mode = 1;                // 1=update about half the instances per frame (default)
+static int g_mv_updates_per_frame = 0;                // mpv FBO renders per composite (0 = derive from above)
+static float g_mv_fbo_budget = 0.5f;                  // Screen fraction of pixels shared by all instance FBOs
+static int g_mv_backlog = 0;                          // Pending instance frames were deferred to the next composite
 static int g_single_mpv_mode = 0;                     // 1=use single mpv with lavfi-complex
+static int g_dual_split = 0;                          // PICKLE_DUAL_SPLIT: two hwdec cores, the second following the first
 
 // Composite FBO/texture when using single mpv for dual videos
 static GLuint g_composite_fbo = 0;
 static GLuint g_composite_texture = 0;
 static int g_composite_w = 0;
 static int g_composite_h = 0;
+static fbo_pool_t g_composite_pool;
+static fbo_pool_t g_shared_pool;             // Low-memory multi-video: the one target all instances render through
 
 // Helper macros for multi-video corner management
-#define CORNER_VIDEO(c) ((c) / 4)                     // Which video instance (0 or 1)
+#define CORNER_VIDEO(c) ((c) / 4)                     // Which video instance
 #define CORNER_LOCAL(c) ((c) % 4)                     // Local corner within video (0-3)
 #define CORNER_GLOBAL(v, c) ((v) * 4 + (c))           // Global corner from video + local
 
@@ -313,7 +496,8 @@ static keystone_t g_keystone = {
     .enabled = false,
     .mesh_enabled = false,
     .mesh_size = 4,    // 4x4 mesh by default
-    .mesh_points = NULL,
+    .mesh_x = NULL,
+    .mesh_y = NULL,
     .active_mesh_point = {-1, -1},
     .perspective_pins = {false, false, false, false}
 }; // Keystone correction settings (used for single-video mode)
@@ -324,26 +508,27 @@ static bool g_show_background = false; // Deprecated: background is always black
 static bool g_show_corner_markers = true; // Show keystone corner highlights
 static int g_loop_playback = 0; // Whether to loop video playback
 static GLuint g_keystone_shader_program = 0; // Shader program for keystone correction (shared)
-static GLuint g_keystone_vertex_shader = 0;
-static GLuint g_keystone_fragment_shader = 0;
-static GLuint g_keystone_vertex_buffer = 0;  // Shared vertex buffer
-static GLuint g_keystone_texcoord_buffer = 0; // Shared texcoord buffer
 static GLuint g_keystone_index_buffer = 0;   // Shared index buffer for quad
+static quad_geom_t g_quad_geom;              // Persistent quad for g_keystone (single video mode)
+// OES_vertex_array_object entry points (NULL when the extension is missing)
+static PFNGLGENVERTEXARRAYSOESPROC g_gl_gen_vertex_arrays = NULL;
+static PFNGLBINDVERTEXARRAYOESPROC g_gl_bind_vertex_array = NULL;
+static PFNGLDELETEVERTEXARRAYSOESPROC g_gl_delete_vertex_arrays = NULL;
+// OES_mapbuffer entry points: mesh warps are tessellated straight into the VBO (NULL when missing)
+static PFNGLMAPBUFFEROESPROC g_gl_map_buffer = NULL;
+static PFNGLUNMAPBUFFEROESPROC g_gl_unmap_buffer = NULL;
 // Note: FBO is now per-instance in video_instance_t, these are kept for single-video backward compat
 static GLuint g_keystone_fbo = 0;            // Cached FBO for mpv render target (single video mode)
 static GLuint g_keystone_fbo_texture = 0;    // Texture attached to FBO (single video mode)
 static int g_keystone_fbo_w = 0;             // FBO width
 static int g_keystone_fbo_h = 0;             // FBO height
+static fbo_pool_t g_keystone_pool;           // Sizes g_keystone_fbo is picked from
 static GLint g_keystone_a_position_loc = -1;
 static GLint g_keystone_a_texcoord_loc = -1;
 static GLint g_keystone_u_texture_loc = -1;
-
-// Simple solid-color shader for drawing outlines/borders around keystone quad
-static GLuint g_border_shader_program = 0;
-static GLuint g_border_vertex_shader = 0;
-static GLuint g_border_fragment_shader = 0;
-static GLint  g_border_a_position_loc = -1;
-static GLint  g_border_u_color_loc = -1;
+static mesh_geom_t g_mesh_geom;               // Mesh-warp geometry for g_keystone (single video mode)
+static int g_mesh_subdiv = 8;                 // Catmull-Rom subdivisions per mesh cell (PICKLE_MESH_SUBDIV)
+static blend_lut_t g_blend_lut;               // Edge-blend mask for g_keystone (single video mode)
 
 // Joystick/gamepad support
 static int g_joystick_fd = -1;        // File descriptor for joystick
@@ -356,12 +541,14 @@ static struct timeval g_last_js_event_time = {0}; // For debouncing joystick eve
 typedef enum { GP_LAYOUT_AUTO = 0, GP_LAYOUT_XBOX, GP_LAYOUT_NINTENDO } gp_layout_t;
 static gp_layout_t g_gamepad_layout = GP_LAYOUT_AUTO;
 
-// Track Start+Select hold for safe quit
+// Track Start+Select hold for safe quit (the hold itself is timed by g_input_quit_fd)
 static bool g_js_start_down = false;
 static bool g_js_select_down = false;
-static struct timeval g_js_start_time = {0};
-static struct timeval g_js_select_time = {0};
-static bool g_js_quit_fired = false;
+
+// evdev input path and control-loop input timers (see evdev_open)
+static bool g_input_evdev = false;    // g_joystick_fd is an evdev node, not joydev
+static int g_input_quit_fd = -1;      // timerfd: START+SELECT hold
+static int g_input_repeat_fd = -1;    // timerfd: held stick/d-pad direction repeat
 
 // 8BitDo controller button mappings (may vary by model/mode)
 #define JS_BUTTON_A        0
@@ -529,6 +716,7 @@ static void configure_special_buttons(void) {
 // Forward declarations
 static void cleanup_keystone_shader(void);
 static bool init_joystick(void);
+static void cleanup_joystick(void);
 static bool handle_joystick_event(struct js_event *event);
 
 static bool ensure_drm_master(int fd) {
@@ -543,6 +731,120 @@ static bool ensure_drm_master(int fd) {
 	return false;
 }
 
+/**
+ * Look up a KMS property id by name on an object, optionally returning its current value
+ *
+ * @return property id, or 0 if the object does not expose the property
+ */
+static uint32_t drm_find_prop(int fd, uint32_t obj_id, uint32_t obj_type, const char *name, uint64_t *value_out) {
+	drmModeObjectProperties *props = drmModeObjectGetProperties(fd, obj_id, obj_type);
+	if (!props) return 0;
+	uint32_t id = 0;
+	for (uint32_t i = 0; i < props->count_props && !id; i++) {
+		drmModePropertyRes *prop = drmModeGetProperty(fd, props->props[i]);
+		if (!prop) continue;
+		if (strcmp(prop->name, name) == 0) {
+			id = prop->prop_id;
+			if (value_out) *value_out = props->prop_values[i];
+		}
+		drmModeFreeProperty(prop);
+	}
+	drmModeFreeObjectProperties(props);
+	return id;
+}
+
+/**
+ * Enable atomic modesetting and resolve the primary plane + property ids we commit.
+ * Non-fatal: on any failure the legacy drmModeSetCrtc/drmModePageFlip path is used.
+ * Disabled with PICKLE_NO_ATOMIC=1.
+ *
+ * @param d Pointer to an initialized kms_ctx (connector/crtc selected)
+ * @return true if atomic commits are available
+ */
+static bool init_atomic(kms_ctx_t *d) {
+	d->atomic = 0;
+	const char *no_atomic = getenv("PICKLE_NO_ATOMIC");
+	if (no_atomic && *no_atomic && strcmp(no_atomic, "0") != 0) {
+		LOG_DRM("Atomic modesetting disabled via PICKLE_NO_ATOMIC");
+		return false;
+	}
+	if (drmSetClientCap(d->fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0 ||
+		drmSetClientCap(d->fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+		LOG_DRM("Atomic modesetting unavailable (%s); using legacy page flips", strerror(errno));
+		return false;
+	}
+
+	d->crtc_index = -1;
+	for (int i = 0; i < d->res->count_crtcs; i++) {
+		if (d->res->crtcs[i] == d->crtc_id) { d->crtc_index = i; break; }
+	}
+	if (d->crtc_index < 0) {
+		LOG_DRM("CRTC %u not in resource list; using legacy page flips", d->crtc_id);
+		return false;
+	}
+
+	drmModePlaneRes *pres = drmModeGetPlaneResources(d->fd);
+	if (!pres) {
+		LOG_DRM("drmModeGetPlaneResources failed (%s); using legacy page flips", strerror(errno));
+		return false;
+	}
+	d->plane_id = 0;
+	d->overlay_planes = 0;
+	for (uint32_t i = 0; i < pres->count_planes; i++) {
+		drmModePlane *pl = drmModeGetPlane(d->fd, pres->planes[i]);
+		if (!pl) continue;
+		if (pl->possible_crtcs & (1u << d->crtc_index)) {
+			uint64_t type = 0;
+			if (drm_find_prop(d->fd, pl->plane_id, DRM_MODE_OBJECT_PLANE, "type", &type)) {
+				if (type == DRM_PLANE_TYPE_PRIMARY && !d->plane_id) d->plane_id = pl->plane_id;
+				else if (type == DRM_PLANE_TYPE_OVERLAY && !d->overlay_planes++) d->overlay_plane_id = pl->plane_id;
+			}
+		}
+		drmModeFreePlane(pl);
+	}
+	drmModeFreePlaneResources(pres);
+	if (!d->plane_id) {
+		LOG_DRM("No primary plane for CRTC %u; using legacy page flips", d->crtc_id);
+		return false;
+	}
+
+	int fd = d->fd;
+	uint32_t pl = d->plane_id;
+	d->plane_prop.fb_id   = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "FB_ID", NULL);
+	d->plane_prop.crtc_id = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "CRTC_ID", NULL);
+	d->plane_prop.src_x   = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "SRC_X", NULL);
+	d->plane_prop.src_y   = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "SRC_Y", NULL);
+	d->plane_prop.src_w   = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "SRC_W", NULL);
+	d->plane_prop.src_h   = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "SRC_H", NULL);
+	d->plane_prop.crtc_x  = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "CRTC_X", NULL);
+	d->plane_prop.crtc_y  = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "CRTC_Y", NULL);
+	d->plane_prop.crtc_w  = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "CRTC_W", NULL);
+	d->plane_prop.crtc_h  = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "CRTC_H", NULL);
+	d->plane_prop.in_fence_fd = drm_find_prop(fd, pl, DRM_MODE_OBJECT_PLANE, "IN_FENCE_FD", NULL);
+	d->crtc_prop.active   = drm_find_prop(fd, d->crtc_id, DRM_MODE_OBJECT_CRTC, "ACTIVE", NULL);
+	d->crtc_prop.mode_id  = drm_find_prop(fd, d->crtc_id, DRM_MODE_OBJECT_CRTC, "MODE_ID", NULL);
+	d->conn_prop_crtc_id  = drm_find_prop(fd, d->connector_id, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID", NULL);
+	if (d->overlay_plane_id) {
+		d->overlay_prop.fb_id = drm_find_prop(fd, d->overlay_plane_id, DRM_MODE_OBJECT_PLANE, "FB_ID", NULL);
+		d->overlay_prop.crtc_id = drm_find_prop(fd, d->overlay_plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_ID", NULL);
+	}
+
+	if (!d->plane_prop.fb_id || !d->plane_prop.crtc_id || !d->plane_prop.src_w || !d->plane_prop.crtc_w ||
+		!d->crtc_prop.active || !d->crtc_prop.mode_id || !d->conn_prop_crtc_id) {
+		LOG_DRM("Missing required atomic properties; using legacy page flips");
+		return false;
+	}
+	if (drmModeCreatePropertyBlob(fd, &d->mode, sizeof(d->mode), &d->mode_blob_id) != 0) {
+		LOG_DRM("drmModeCreatePropertyBlob failed (%s); using legacy page flips", strerror(errno));
+		return false;
+	}
+
+	d->atomic = 1;
+	LOG_DRM("Atomic modesetting enabled (primary plane %u, %d overlay plane(s), IN_FENCE_FD=%s)",
+		d->plane_id, d->overlay_planes, d->plane_prop.in_fence_fd ? "yes" : "no");
+	return true;
+}
+
 /**
  * Initialize DRM by scanning available cards and finding one with a connected display
  * 
@@ -559,6 +861,7 @@ static bool init_drm(kms_ctx_t *d) {
 	// all to stay generic across distro kernels.
 	char path[32];
 	bool found_card = false;
+	int headless_idx = -1; // offscreen only: first card with resources, used if no display is connected
 	
 	for (int idx=0; idx<16; ++idx) {
 		snprintf(path, sizeof(path), "/dev/dri/card%d", idx);
@@ -588,6 +891,7 @@ static bool init_drm(kms_ctx_t *d) {
 		if (!chosen) {
 			drmModeFreeResources(res);
 			close(fd);
+			if (headless_idx < 0) headless_idx = idx;
 			continue; // try next card
 		}
 		
@@ -612,6 +916,20 @@ static bool init_drm(kms_ctx_t *d) {
 		break;
 	}
 	
+	if (!found_card && g_scanout_disabled && headless_idx >= 0) {
+		// Offscreen rendering (--bench) needs no display: open the first card that had mode
+		// resources (its primary node, for GBM/EGL) and use a fixed 1080p60 mode
+		snprintf(path, sizeof(path), "/dev/dri/card%d", headless_idx);
+		d->fd = open(path, O_RDWR | O_CLOEXEC);
+		if (d->fd >= 0) {
+			d->res = drmModeGetResources(d->fd);
+			d->mode = (drmModeModeInfo){ .clock = 148500, .hdisplay = 1920, .hsync_start = 2008, .hsync_end = 2052,
+				.htotal = 2200, .vdisplay = 1080, .vsync_start = 1084, .vsync_end = 1089, .vtotal = 1125,
+				.vrefresh = 60, .name = "1920x1080" };
+			LOG_DRM("No connected display; offscreen on %s at %ux%u", path, d->mode.hdisplay, d->mode.vdisplay);
+			return true;
+		}
+	}
 	if (!found_card || d->fd < 0 || !d->connector) {
 		LOG_ERROR("Failed to locate a usable DRM device");
 		LOG_ERROR("Troubleshooting: Ensure vc4 KMS overlay enabled and you have permission (try sudo or be in 'video' group)");
@@ -647,6 +965,9 @@ static bool init_drm(kms_ctx_t *d) {
 		d->fd, d->connector_id, d->mode.name, 
 		d->mode.hdisplay, d->mode.vdisplay, d->mode.vrefresh);
 
+	// Prefer atomic commits; falls back to legacy modeset/page flip transparently
+	init_atomic(d);
+
 	return true;
 }
 
@@ -666,6 +987,16 @@ static void deinit_drm(kms_ctx_t *d) {
 		d->orig_crtc = NULL;
 	}
 	
+	if (g_atomic_req) {
+		drmModeAtomicFree(g_atomic_req);
+		g_atomic_req = NULL;
+	}
+	if (d->mode_blob_id) {
+		drmModeDestroyPropertyBlob(d->fd, d->mode_blob_id);
+		d->mode_blob_id = 0;
+	}
+	d->atomic = 0;
+	
 	if (d->encoder) {
 		drmModeFreeEncoder(d->encoder);
 		d->encoder = NULL;
@@ -815,10 +1146,31 @@ static bool init_gbm_egl(const kms_ctx_t *d, egl_ctx_t *e) {
 	if (!eglMakeCurrent(e->dpy, e->surf, e->surf, e->ctx)) {
 		RETURN_ERROR_EGL("eglMakeCurrent failed");
 	}
+	const char *egl_exts = eglQueryString(e->dpy, EGL_EXTENSIONS);
 	
 	// Set swap interval to control vsync behavior
 	eglSwapInterval(e->dpy, g_vsync_enabled ? 1 : 0);
 
+	// Native fence sync lets KMS wait for GPU completion (IN_FENCE_FD) instead of us
+	if (egl_exts && strstr(egl_exts, "EGL_ANDROID_native_fence_sync")) {
+		e->create_sync = (PFNEGLCREATESYNCKHRPROC)eglGetProcAddress("eglCreateSyncKHR");
+		e->destroy_sync = (PFNEGLDESTROYSYNCKHRPROC)eglGetProcAddress("eglDestroySyncKHR");
+		e->dup_native_fence_fd = (PFNEGLDUPNATIVEFENCEFDANDROIDPROC)eglGetProcAddress("eglDupNativeFenceFDANDROID");
+		e->native_fence = (e->create_sync && e->destroy_sync && e->dup_native_fence_fd) ? 1 : 0;
+	}
+	LOG_EGL("EGL_ANDROID_native_fence_sync %s", e->native_fence ? "available" : "missing");
+
+	// Zero-copy hwdec needs the decoder's DMA-BUFs importable as EGLImages
+	g_egl_dmabuf_import = (egl_exts && strstr(egl_exts, "EGL_EXT_image_dma_buf_import")) ? 1 : 0;
+	LOG_EGL("EGL_EXT_image_dma_buf_import %s", g_egl_dmabuf_import ? "available" : "missing (zero-copy hwdec disabled)");
+	e->dmabuf_modifiers = (egl_exts && strstr(egl_exts, "EGL_EXT_image_dma_buf_import_modifiers")) ? 1 : 0;
+	const char *gl_exts = (const char *)glGetString(GL_EXTENSIONS);
+	if (g_egl_dmabuf_import && gl_exts && strstr(gl_exts, "GL_OES_EGL_image")) {
+		e->create_image = (PFNEGLCREATEIMAGEKHRPROC)eglGetProcAddress("eglCreateImageKHR");
+		e->destroy_image = (PFNEGLDESTROYIMAGEKHRPROC)eglGetProcAddress("eglDestroyImageKHR");
+		e->image_target_renderbuffer = (PFNGLEGLIMAGETARGETRENDERBUFFERSTORAGEOESPROC)eglGetProcAddress("glEGLImageTargetRenderbufferStorageOES");
+	}
+
 	// Log GL info
 	const char *gl_vendor = (const char*)glGetString(GL_VENDOR);
 	const char *gl_renderer = (const char*)glGetString(GL_RENDERER);
@@ -844,9 +1196,16 @@ static void deinit_gbm_egl(egl_ctx_t *e) {
 		cleanup_keystone_shader();
 	}
 	// Ensure any cached FBO/texture are cleaned even if shader program wasn't created
-	if (g_keystone_fbo) { glDeleteFramebuffers(1, &g_keystone_fbo); g_keystone_fbo = 0; }
-	if (g_keystone_fbo_texture) { glDeleteTextures(1, &g_keystone_fbo_texture); g_keystone_fbo_texture = 0; }
+	fbo_pool_destroy(&g_keystone_pool);
+	g_keystone_fbo = g_keystone_fbo_texture = 0;
 	g_keystone_fbo_w = g_keystone_fbo_h = 0;
+	fbo_pool_destroy(&g_composite_pool);
+	g_composite_fbo = g_composite_texture = 0;
+	fbo_pool_destroy(&g_shared_pool);
+	for (int i = 0; i < MAX_VIDEOS; i++) {
+		fbo_pool_destroy(&g_videos[i].pool);
+		g_videos[i].fbo = g_videos[i].fbo_texture = 0;
+	}
 	
 	if (e->dpy != EGL_NO_DISPLAY) {
 		// Release current context
@@ -880,13 +1239,128 @@ static void deinit_gbm_egl(egl_ctx_t *e) {
 	}
 }
 
+// --- Demuxer cache profiles ---
+// Picked per source from its URL (PICKLE_CACHE_PROFILE overrides). Local files read far
+// faster than they play, so they get a small packet queue; network sources get the
+// stream cache, with readahead and back buffer adapted at runtime (cache_adapt()).
+typedef struct {
+	const char *name;
+	int cache;               // mpv stream cache ("cache" option)
+	int adapt;               // Readahead follows the measured input rate
+	double readahead_min;    // Seconds ahead of playback (cache-secs / demuxer-readahead-secs)
+	double readahead_max;
+	double back_secs;        // Media kept behind playback for short seeks
+	int64_t max_bytes_min;   // demuxer-max-bytes bounds
+	int64_t max_bytes_max;
+	int64_t back_bytes_max;  // demuxer-max-back-bytes upper bound
+} cache_profile_t;
+
+#define CACHE_MIB ((int64_t)1 << 20)
+static const cache_profile_t g_cache_profiles[] = {
+	{ "local", 0, 0, 1.0, 1.0, 0.0, 16 * CACHE_MIB, 16 * CACHE_MIB, 0 },
+	{ "vod",   1, 1, 5.0, 30.0, 10.0, 16 * CACHE_MIB, 96 * CACHE_MIB, 32 * CACHE_MIB },
+	{ "live",  1, 1, 2.0, 10.0, 0.0, 8 * CACHE_MIB, 32 * CACHE_MIB, 0 },
+};
+#define CACHE_PROFILES ((int)(sizeof(g_cache_profiles) / sizeof(g_cache_profiles[0])))
+
 // MPV rendering integration
 struct mpv_player_struct {
 	mpv_handle *mpv;             // MPV API handle
 	mpv_render_context *rctx;    // MPV render context for OpenGL rendering
 	int using_libmpv;            // Flag indicating fallback to vo=libmpv occurred
+	int zero_copy;               // Requested zero-copy DRM-PRIME hwdec (falls back to drm-copy)
+	int hwdec_fallback_done;     // Set once we have switched away from a failed zero-copy path
+	char hwdec_current[32];      // Last observed hwdec-current ("no" = software decode)
+	int use_adv;                 // MPV_RENDER_PARAM_ADVANCED_CONTROL requested (vo=gpu + PICKLE_GL_ADV)
+	int plane_interop;           // Render context uses drmprime-overlay (frames go to the video plane)
+	_Atomic int src_w, src_h;    // video-params size (set on VIDEO_RECONFIG; 0 = unknown)
+	const cache_profile_t *cache; // Demuxer cache profile of the loaded source (NULL = not set)
+	int cache_follower;          // Dual-split follower: cache capped (dual_split_follower_setup)
+	double cache_readahead;      // Readahead currently applied (s)
+	int64_t cache_max_bytes;     // demuxer-max-bytes currently applied
+	int64_t cache_back_bytes;    // demuxer-max-back-bytes currently applied
+	double cache_fill_s;         // Last sampled media ahead of playback
+	int64_t cache_fill_bytes;    // Last sampled bytes ahead of playback
+	double cache_in_rate;        // Last sampled demuxer input rate (bytes/s)
+	double cache_headroom;       // Input rate over media bitrate, last measured while filling
+	uint64_t cache_underruns;    // Times the demuxer ran dry or playback paused for cache
+	int cache_underrun;          // Underrun flag at the last sample (edge detection)
+	int cache_calm;              // Consecutive adapt ticks with ample headroom
+	int64_t cache_adapt_us;      // Last cache_adapt() tick
 };
 
+// --- Gapless playlist (-p/--playlist FILE, single video) ---
+// Two player slots: the current item plays in one while the next is created, given its
+// render context by the render thread and pre-rolled paused in the other. The swap is
+// armed when at most one frame of the current item is left, so the standby's first
+// frame follows its last one without a repeat; keep-open holds the last frame if the
+// swap is late. Only the render thread switches g_videos[0].player (RCMD_PLAYER_SWAP);
+// the control thread follows g_pl.cur once the swap has been acknowledged.
+#define PLAYLIST_MAX 256
+typedef enum {
+	PL_IDLE,        // Standby slot empty
+	PL_ATTACHING,   // Core created; render thread creating its render context
+	PL_PREROLL,     // Loading paused, waiting for the first frame
+	PL_READY,       // First frame ready; swap at the current item's end
+	PL_SWAPPING,    // Render thread switching to the standby
+	PL_DROP,        // Standby failed; being retired
+	PL_DETACHING,   // Render thread freeing a failed standby's render context
+} pl_state_t;
+static struct {
+	char *items[PLAYLIST_MAX];
+	int count;               // 0 = no playlist
+	int loop;                // Start over after the last item (-l / PICKLE_LOOP)
+	int index;               // Item playing now
+	int next;                // Item to pre-roll next (-1 = none)
+	int standby_item;        // Item in the standby slot
+	int fails;               // Consecutive items that failed to load
+	int cur;                 // Slot of the current item
+	int eof;                 // Current item is holding its last frame
+	int poll_ms;             // Control loop poll timeout while a swap is armed (0 = default)
+	pl_state_t state;        // Progress of the standby slot
+	mpv_player_t *slot[2];
+} g_pl;
+static _Atomic int g_pl_attached = 0; // 1 = standby render context ready, -1 = failed (render thread)
+static _Atomic int g_pl_swapped = 0;  // Render thread finished RCMD_PLAYER_SWAP / RCMD_PLAYER_DETACH (release)
+
+/**
+ * Classify the decode path for stats/logging from mpv's hwdec-current value
+ */
+static const char *hwdec_path_str(const mpv_player_t *p) {
+	if (!p || !p->mpv) return "n/a";
+	const char *cur = p->hwdec_current;
+	if (!cur[0]) return "pending";
+	if (!strcmp(cur, "no")) return "software";
+	if (g_video_plane) return "plane";
+	size_t n = strlen(cur);
+	if (n > 5 && !strcmp(cur + n - 5, "-copy")) return "copy";
+	return "zero-copy";
+}
+
+/**
+ * Refresh hwdec-current after a video reconfig; if a zero-copy request did not
+ * yield a hardware decoder (EGL import or interop failed), switch to drm-copy.
+ */
+static void hwdec_check_fallback(mpv_player_t *p) {
+	if (!p || !p->mpv) return;
+	char *cur = mpv_get_property_string(p->mpv, "hwdec-current");
+	snprintf(p->hwdec_current, sizeof(p->hwdec_current), "%s", (cur && *cur) ? cur : "no");
+	if (cur) mpv_free(cur);
+	LOG_MPV("hwdec-current=%s (%s path)", p->hwdec_current, hwdec_path_str(p));
+	if (p->zero_copy && !p->hwdec_fallback_done && !strcmp(p->hwdec_current, "no")) {
+		p->hwdec_fallback_done = 1;
+		p->zero_copy = 0;
+		LOG_WARN("Zero-copy DRM-PRIME import failed; falling back to hwdec=drm-copy");
+		if (g_video_plane) {
+			// Copied frames are composed by GL again, so the primary plane must be flipped
+			LOG_WARN("Video plane scanout disabled; returning to GL composition");
+			g_video_plane = g_video_plane_wanted = 0;
+		}
+		int r = mpv_set_property_string(p->mpv, "hwdec", "drm-copy");
+		if (r < 0) LOG_WARN("Setting hwdec=drm-copy failed (%d)", r);
+	}
+}
+
 // Wakeup callback sets a flag so main loop knows mpv wants processing.
 static volatile int g_mpv_wakeup = 0;
 static int g_mpv_pipe[2] = {-1,-1}; // pipe to integrate mpv wakeups into poll loop
@@ -899,13 +1373,26 @@ static void mpv_wakeup_cb(void *ctx) {
 	}
 }
 static volatile uint64_t g_mpv_update_flags = 0; // bitmask from mpv_render_context_update
-static void on_mpv_events(void *data) { (void)data; g_mpv_wakeup = 1; }
+static _Atomic int g_render_update = 1;   // mpv render update pending (render thread calls mpv_render_context_update)
+static int g_render_wake[2] = {-1,-1};   // wakes the render thread's poll() for commands and render updates
+static void render_wake(void) {
+	if (g_render_wake[1] >= 0) {
+		unsigned char b = 0;
+		if (write(g_render_wake[1], &b, 1) < 0) { /* ignore EAGAIN */ }
+	}
+}
+static void on_mpv_events(void *data) { (void)data; atomic_store(&g_render_update, 1); render_wake(); }
 
 // Debug / instrumentation control (enabled with PICKLE_DEBUG env)
 static int g_debug = 0;
 
 // Performance controls
 static int g_triple_buffer = 1;         // Enable triple buffering by default
+static int g_low_mem = 0;               // Memory-footprint mode for 512 MB boards (PICKLE_LOW_MEM, see mem_budget_report)
+#define LOW_MEM_FBO_MAX_PX (1280 * 720)  // Low-memory cap on one offscreen target
+#define LOW_MEM_HWDEC_EXTRA_FRAMES "2"   // Decoder surfaces beyond the codec's references (mpv default 6)
+static _Atomic uint64_t g_mem_fbo_bytes = 0; // GPU memory held by offscreen targets (render thread writes)
+static _Atomic uint64_t g_mem_fbo_peak = 0;
 static int g_vsync_enabled = 1;         // Enable vsync by default
 static int g_frame_timing_enabled = 0;  // Detailed frame timing metrics (when PICKLE_TIMING=1)
 
@@ -922,16 +1409,77 @@ static int g_help_visible = 0; // toggle state for help overlay
 // --- Statistics ---
 static int g_stats_enabled = 0;
 static double g_stats_interval_sec = 2.0; // default
-static uint64_t g_stats_frames = 0;
+static _Atomic uint64_t g_stats_frames = 0; // incremented by the render thread
+static _Atomic uint64_t g_stats_composed = 0; // frames recomposited from cached mpv output (no mpv render)
+static _Atomic uint64_t g_stats_idle = 0;     // render opportunities skipped because nothing changed
+static _Atomic uint64_t g_stats_fbo_bytes = 0; // estimated offscreen FBO traffic: mpv writes plus warp reads
+static _Atomic uint64_t g_stats_fbo_saved = 0; // the same traffic avoided against RGBA8 targets
 static struct timeval g_stats_start = {0};
 static struct timeval g_stats_last = {0};
 static uint64_t g_stats_last_frames = 0;
+static uint64_t g_stats_last_fbo_bytes = 0;
+static uint64_t g_stats_last_fbo_saved = 0;
+
+// --- Benchmark mode (--bench[=frames]) ---
+// The parent forks one fresh player per scenario; each child plays the (synthetic)
+// source offscreen and unpaced, then reports its measurement through a pipe.
+#define BENCH_DEFAULT_FRAMES 600
+#define BENCH_WARMUP 60                 // Frames rendered before measuring starts
+#define BENCH_TIMEOUT_S 30              // Base time limit per scenario (plus 1 s per 10 frames)
+#define BENCH_REAP_MS 3000              // Wait for a child to exit before escalating SIGTERM -> SIGKILL
+#define BENCH_DEFAULT_SOURCE "av://lavfi:testsrc2=size=1920x1080:rate=60"
+typedef struct {
+	const char *name;
+	int videos;       // 1 or 2
+	int keystone;     // fixed trapezoid on the single video
+	int mesh;         // curved mesh warp instead of the 4-corner quad
+	int single_mpv;   // dual video through one lavfi-complex mpv (g_single_mpv_mode)
+	int dual_split;   // dual video through two synchronized cores (g_dual_split)
+} bench_scenario_t;
+static const bench_scenario_t g_bench_scenarios[] = {
+	{ "single",          1, 0, 0, 0, 0 },
+	{ "single-keystone", 1, 1, 0, 0, 0 },
+	{ "dual-alternate",  2, 0, 0, 0, 0 },
+	{ "dual-single-mpv", 2, 0, 0, 1, 0 },
+	{ "dual-split",      2, 0, 0, 0, 1 },
+	{ "mesh",            1, 1, 1, 0, 0 },
+};
+static int g_bench_frames = 0;      // Measured frames per scenario (0 = normal playback)
+static int g_bench_scenario = -1;   // Scenario run by this process (benchmark child only)
+static int g_bench_fd = -1;         // Result pipe to the --bench parent
 // Program start (for watchdogs)
 static struct timeval g_prog_start = {0};
-// Playback monitoring
-static struct timeval g_last_frame_time = {0};
-static int g_stall_reset_count = 0;
+// Startup phase timestamps (mono_now_us(); CLOCK_MONOTONIC counts from boot), logged once
+// the first video frame is on screen
+static struct {
+	int64_t start_us;            // main() entered
+	int64_t drm_us;              // init_drm() done
+	int64_t egl_us;              // init_gbm_egl() done
+	int64_t ring_us;             // Scanout FB ring allocated
+	int64_t core_us;             // mpv cores initialized (worker thread; 0 = not started)
+	int64_t mpv_us;              // Render contexts created, files loading
+	_Atomic int64_t decoded_us;  // First mpv frame available (render thread)
+	_Atomic int64_t render_us;   // Render start of the first frame showing it
+	_Atomic int64_t shown_us;    // Flip of that frame completed (or its render, without scanout)
+	int logged;
+} g_boot;
+// Playback monitoring (written by the render thread, read by the watchdog)
+static _Atomic int64_t g_last_frame_us = 0;  // mono_now_us() of the last rendered frame or playback restart
+static _Atomic int g_render_frames = 0;      // Frames rendered so far
+static int g_stall_reset_count = 0;  // Recovery attempts in the current stall
 static int g_max_stall_resets = 3; // Maximum stall recovery attempts before giving up
+// Stall classifier inputs (render thread writes, watchdog reads; relaxed atomics)
+static struct {
+	_Atomic int64_t frame_ready_us;  // mpv last reported a new frame (MPV_RENDER_UPDATE_FRAME)
+	_Atomic int64_t render_us;       // Last frame rendered
+	_Atomic int64_t flip_us;         // Last page-flip event
+	_Atomic int64_t idle_us;         // Last render opportunity passed with nothing to draw or flip
+	_Atomic uint64_t flip_timeouts;  // In-flight flips with no event after FLIP_TIMEOUT_US
+} g_wd;
+typedef enum { STALL_DEMUX, STALL_DECODE, STALL_SCANOUT, STALL_CLASSES } stall_class_t;
+static const char *g_stall_names[STALL_CLASSES] = { "demux", "decode", "scanout" };
+static uint64_t g_stall_count[STALL_CLASSES]; // Stalls seen per class (control thread)
+static uint64_t g_stall_recoveries = 0;       // Recovery actions taken, all classes
 // Watchdog timeouts
 static int g_wd_first_ms = 1500; // 1.5s
 static int g_wd_ongoing_ms = 3000; // 3s max between frames during playback (adjustable for looping)
@@ -943,7 +1491,34 @@ static double g_min_flip_time = 1000.0;
 static double g_max_flip_time = 0.0;
 static double g_avg_flip_time = 0.0;
 static int g_flip_count = 0;
-static int g_pending_flips = 0;  // Track number of page flips in flight
+
+// Presentation scheduling on kernel vblank timestamps (CLOCK_MONOTONIC); PICKLE_SCHED=0 disables
+#define SCHED_MARGIN_US 2000            // Safety margin between commit and the target vblank
+static int g_sched_enabled = 1;
+static int g_vblank_monotonic = 0;      // DRM_CAP_TIMESTAMP_MONOTONIC: flip timestamps use our clock
+static int64_t g_vblank_last_us = 0;    // Timestamp of the most recent completed flip
+static unsigned int g_vblank_last_seq = 0; // vblank sequence number of that flip
+static int64_t g_vblank_period_us = 0;  // Refresh period (seeded from the mode, refined from timestamps)
+static int64_t g_render_cost_us = 0;    // Smoothed time from render start to commit
+static int64_t g_sched_defer_until_us = 0; // Pending frame held back until this time (0 = none)
+static int g_mpv_block_for_target = 1;  // MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME (0 while we schedule)
+static mpv_render_context *g_sched_rctx[MAX_VIDEOS]; // Render contexts told about each completed swap
+
+// Adaptive FBO resolution governor (render thread). Offscreen mpv targets render at a
+// base size from the source resolution and the warped quad's screen area, scaled by a
+// shared level that steps down on missed deadlines and back up when the GPU has headroom.
+#define GOV_WINDOW 30                   // Frames per governor decision
+static const float g_gov_scales[GOV_LEVELS] = { 1.0f, 0.75f, 0.5f, 0.375f };
+static struct {
+	int enabled;             // PICKLE_FBO_GOVERNOR=0 pins level 0
+	int level;               // Index into g_gov_scales
+	int fence_fd;            // GPU fence of the frame being timed (-1 = none)
+	int64_t fence_start_us;  // Render start of that frame
+	int64_t gpu_us;          // Smoothed render start -> GPU completion (0 = no fence timing)
+	int frames;              // Frames in the current window
+	int misses;              // Late GPU completions or late flips in the current window
+	int calm_windows;        // Consecutive windows with room for the next level up
+} g_gov = { .enabled = 1, .fence_fd = -1 };
 
 // Saved OSD settings for help overlay placement
 static struct {
@@ -959,6 +1534,605 @@ static double tv_diff(const struct timeval *a, const struct timeval *b) {
 	return (double)(a->tv_sec - b->tv_sec) + (double)(a->tv_usec - b->tv_usec)/1e6;
 }
 
+static int64_t mono_now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// --- Render / control thread split ---
+// The render thread owns the EGL context, the mpv render contexts and scanout; the
+// main (control) thread handles input, mpv events, config I/O, stats and the watchdog.
+// Control -> render traffic is a single-producer/single-consumer command ring, and
+// keystone/overlay state travels as double-buffered snapshots, so the render thread
+// never takes a lock and never waits for the control thread.
+#define RENDER_CMDQ_SIZE 64      // Power of two
+#define KEYSTONE_MESH_MAX 10     // Largest mesh_size accepted by config and keys
+#define MESH_PLANE(n) ((((size_t)(n) * (size_t)(n)) + 3) & ~(size_t)3) // Floats per SoA plane (x or y), 16-byte multiple
+enum render_cmd_type {
+	RCMD_REDRAW,                 // Render a frame even if mpv has nothing new (overlay changed)
+	RCMD_SNAPSHOT,               // arg: g_snap slot to render from from now on
+	RCMD_FLIP_RESET,             // Watchdog recovery: drop the flip queue and redraw
+	RCMD_PLAYER_ATTACH,          // arg: player slot that needs a render context (playlist)
+	RCMD_PLAYER_SWAP,            // arg: player slot to present from now on; frees the old render context
+	RCMD_PLAYER_DETACH,          // arg: player slot whose render context is freed (failed standby)
+};
+typedef struct {
+	int type;
+	int arg;
+} render_cmd_t;
+static struct {
+	render_cmd_t slot[RENDER_CMDQ_SIZE];
+	_Atomic unsigned head;       // Next slot written (control thread)
+	_Atomic unsigned tail;       // Next slot read (render thread)
+} g_cmdq;
+
+// Keystone copy whose mesh_x/mesh_y refer to storage inside the snapshot
+typedef struct {
+	keystone_t ks;
+	float mesh[2][MESH_PLANE(KEYSTONE_MESH_MAX)] __attribute__((aligned(16)));
+} keystone_snap_t;
+typedef struct {
+	keystone_snap_t main;                // g_keystone (single video)
+	keystone_snap_t video[MAX_VIDEOS];   // g_videos[i].keystone (multi video)
+	int active_corner_global;
+	bool show_border;
+	bool show_corner_markers;
+	bool show_help;                      // mpv's help OSD is up (drawn on the GL layer)
+	int border_width;
+	int tex_flip_x;
+	int tex_flip_y;
+} render_snapshot_t;
+static render_snapshot_t g_snap[2];
+static render_snapshot_t *g_rs = &g_snap[0]; // Render thread: snapshot being drawn (front buffer)
+static int g_snap_back = 1;                  // Control thread: slot filled by the next publish
+static _Atomic int g_snap_acked = 1;         // Render thread has switched to the last published slot
+static int g_snap_pending = 0;               // Control thread: a change is waiting for the back slot
+
+/**
+ * Queue a command for the render thread (control thread only).
+ *
+ * @return false if the ring is full
+ */
+static bool render_cmd_push(int type, int arg) {
+	unsigned head = atomic_load_explicit(&g_cmdq.head, memory_order_relaxed);
+	unsigned tail = atomic_load_explicit(&g_cmdq.tail, memory_order_acquire);
+	if (head - tail >= RENDER_CMDQ_SIZE) return false;
+	g_cmdq.slot[head & (RENDER_CMDQ_SIZE - 1)] = (render_cmd_t){ type, arg };
+	atomic_store_explicit(&g_cmdq.head, head + 1, memory_order_release);
+	render_wake();
+	return true;
+}
+
+/**
+ * Take the oldest command (render thread only).
+ *
+ * @return false if the ring is empty
+ */
+static bool render_cmd_pop(render_cmd_t *out) {
+	unsigned tail = atomic_load_explicit(&g_cmdq.tail, memory_order_relaxed);
+	unsigned head = atomic_load_explicit(&g_cmdq.head, memory_order_acquire);
+	if (tail == head) return false;
+	*out = g_cmdq.slot[tail & (RENDER_CMDQ_SIZE - 1)];
+	atomic_store_explicit(&g_cmdq.tail, tail + 1, memory_order_release);
+	return true;
+}
+
+static void keystone_snap_copy(keystone_snap_t *dst, const keystone_t *src) {
+	dst->ks = *src;
+	dst->ks.mesh_x = dst->ks.mesh_y = NULL;
+	if (src->mesh_x && src->mesh_size <= KEYSTONE_MESH_MAX) {
+		size_t bytes = (size_t)src->mesh_size * (size_t)src->mesh_size * sizeof(float);
+		memcpy(dst->mesh[0], src->mesh_x, bytes);
+		memcpy(dst->mesh[1], src->mesh_y, bytes);
+		dst->ks.mesh_x = dst->mesh[0];
+		dst->ks.mesh_y = dst->mesh[1];
+	}
+}
+
+/**
+ * Copy the control thread's keystone and overlay state into a snapshot slot.
+ */
+static void render_snapshot_fill(render_snapshot_t *rs) {
+	keystone_snap_copy(&rs->main, &g_keystone);
+	for (int i = 0; i < MAX_VIDEOS; i++) keystone_snap_copy(&rs->video[i], &g_videos[i].keystone);
+	rs->active_corner_global = g_active_corner_global;
+	rs->show_border = g_show_border;
+	rs->show_corner_markers = g_show_corner_markers;
+	rs->show_help = g_help_visible != 0;
+	rs->border_width = g_border_width;
+	rs->tex_flip_x = g_tex_flip_x;
+	rs->tex_flip_y = g_tex_flip_y;
+}
+
+/**
+ * Publish the current keystone/overlay state to the render thread (control thread).
+ * The back slot is only rewritten once the render thread has moved off it; until
+ * then the change stays pending and is retried from the control loop.
+ */
+static void render_publish(void) {
+	if (!atomic_load_explicit(&g_snap_acked, memory_order_acquire)) {
+		g_snap_pending = 1;
+		return;
+	}
+	render_snapshot_fill(&g_snap[g_snap_back]);
+	atomic_store_explicit(&g_snap_acked, 0, memory_order_relaxed);
+	if (!render_cmd_push(RCMD_SNAPSHOT, g_snap_back)) {
+		atomic_store_explicit(&g_snap_acked, 1, memory_order_relaxed);
+		g_snap_pending = 1;
+		return;
+	}
+	g_snap_back ^= 1;
+	g_snap_pending = 0;
+}
+
+// Frame damage (render thread): what changed since the last composed frame. mpv frame
+// updates (and explicit redraws) arrive as MPV_RENDER_UPDATE_FRAME in g_mpv_update_flags;
+// keystone and overlay changes only recomposite our layer over the cached mpv output.
+// With no damage nothing is rendered or committed and the CRTC keeps scanning out the
+// last frame. PICKLE_DAMAGE=0 treats every change as a full redraw.
+#define DAMAGE_COMPOSE (1u << 0)     // Keystone geometry, border or markers changed
+#define DAMAGE_VIDEO   (1u << 1)     // mpv must render again (new frame, redraw, path change)
+static unsigned g_damage = 0;
+static int g_damage_tracking = 1;
+
+// Keystone fields that change what is drawn (pins and geom_gen do not)
+static bool keystone_draw_equal(const keystone_t *a, const keystone_t *b, bool cmp_active) {
+	if (a->enabled != b->enabled || a->mesh_enabled != b->mesh_enabled || a->mesh_size != b->mesh_size ||
+	    memcmp(a->points, b->points, sizeof(a->points)) != 0 || memcmp(a->blend, b->blend, sizeof(a->blend)) != 0)
+		return false;
+	if (cmp_active && (a->active_corner != b->active_corner ||
+	    memcmp(a->active_mesh_point, b->active_mesh_point, sizeof(a->active_mesh_point)) != 0))
+		return false;
+	if (!a->mesh_x != !b->mesh_x) return false;
+	if (a->mesh_x) {
+		size_t bytes = (size_t)a->mesh_size * (size_t)a->mesh_size * sizeof(float);
+		if (memcmp(a->mesh_x, b->mesh_x, bytes) != 0 || memcmp(a->mesh_y, b->mesh_y, bytes) != 0) return false;
+	}
+	return true;
+}
+
+/**
+ * Damage between the snapshot last drawn and a newly published one (render thread)
+ *
+ * @return DAMAGE_* bits (0 = identical)
+ */
+static unsigned snapshot_damage(const render_snapshot_t *old, const render_snapshot_t *rs) {
+	// Single video keystone on/off moves mpv between the scanout buffer and the keystone FBO
+	if (old->main.ks.enabled != rs->main.ks.enabled || !g_damage_tracking) return DAMAGE_VIDEO;
+	bool same = old->show_border == rs->show_border && old->show_corner_markers == rs->show_corner_markers &&
+		old->show_help == rs->show_help &&
+		old->border_width == rs->border_width && old->tex_flip_x == rs->tex_flip_x &&
+		old->tex_flip_y == rs->tex_flip_y && old->active_corner_global == rs->active_corner_global &&
+		keystone_draw_equal(&old->main.ks, &rs->main.ks, true);
+	// Per-video active corners are derived from active_corner_global when drawing
+	for (int i = 0; same && i < g_num_videos; i++) same = keystone_draw_equal(&old->video[i].ks, &rs->video[i].ks, false);
+	return same ? 0 : DAMAGE_COMPOSE;
+}
+
+/**
+ * Record a completed flip for the presentation scheduler and tell mpv about the swap
+ *
+ * @param seq vblank sequence number from the flip event
+ * @param sec,usec Kernel vblank timestamp of the flip
+ */
+static void sched_note_flip(unsigned int seq, unsigned int sec, unsigned int usec) {
+	int64_t ts = g_vblank_monotonic ? (int64_t)sec * 1000000 + (int64_t)usec : mono_now_us();
+	if (g_vblank_last_us && seq > g_vblank_last_seq && ts > g_vblank_last_us) {
+		int64_t sample = (ts - g_vblank_last_us) / (int64_t)(seq - g_vblank_last_seq);
+		// Track slow drift of the real refresh rate; reject outliers (missed/odd events)
+		if (g_vblank_period_us <= 0) g_vblank_period_us = sample;
+		else if (sample > g_vblank_period_us / 2 && sample < g_vblank_period_us * 2)
+			g_vblank_period_us += (sample - g_vblank_period_us) / 16;
+	}
+	g_vblank_last_us = ts;
+	g_vblank_last_seq = seq;
+	for (int i = 0; i < MAX_VIDEOS; i++) {
+		if (g_sched_rctx[i]) mpv_render_context_report_swap(g_sched_rctx[i]);
+	}
+}
+
+/**
+ * Time to start rendering the next frame so its flip lands on the vblank
+ * nearest mpv's target display time (MPV_RENDER_PARAM_NEXT_FRAME_INFO).
+ *
+ * @param p Player whose next frame is scheduled
+ * @return CLOCK_MONOTONIC microseconds, or 0 to render immediately
+ */
+static int64_t sched_render_start_us(mpv_player_t *p) {
+	if (!g_sched_enabled || !p || !p->rctx || !p->mpv || g_vblank_period_us <= 0 || !g_vblank_last_us) return 0;
+	mpv_render_frame_info info = {0};
+	if (mpv_render_context_get_info(p->rctx, (mpv_render_param){MPV_RENDER_PARAM_NEXT_FRAME_INFO, &info}) < 0) return 0;
+	if (!(info.flags & MPV_RENDER_FRAME_INFO_PRESENT) || (info.flags & MPV_RENDER_FRAME_INFO_REDRAW) || info.target_time <= 0)
+		return 0;
+
+	int64_t now = mono_now_us();
+	int64_t target = info.target_time - mpv_get_time_us(p->mpv) + now; // mpv timebase -> CLOCK_MONOTONIC
+	int64_t period = g_vblank_period_us;
+	int64_t n = (target - g_vblank_last_us + period / 2) / period;
+	if (n < 1) n = 1;
+	int64_t slot = g_vblank_last_us + n * period;
+
+	// Start just late enough to finish before the slot, but after the vblank preceding it
+	int64_t start = slot - g_render_cost_us - SCHED_MARGIN_US;
+	int64_t earliest = slot - period + SCHED_MARGIN_US / 4;
+	if (start < earliest) start = earliest;
+	return start;
+}
+
+// Time available per frame: one refresh period
+static int64_t gov_budget_us(void) {
+	return g_vblank_period_us > 0 ? g_vblank_period_us : 16667;
+}
+
+/**
+ * Time the GPU work of a submitted frame (render thread). Only one frame is timed
+ * at a time; its fence fd joins the render thread's poll set.
+ *
+ * @param fence_fd Native fence of the frame (duplicated; caller keeps its fd)
+ * @param start_us When rendering of the frame started
+ */
+static void gov_track_fence(int fence_fd, int64_t start_us) {
+	if (!g_gov.enabled || fence_fd < 0 || g_gov.fence_fd >= 0) return;
+	g_gov.fence_fd = dup(fence_fd);
+	g_gov.fence_start_us = start_us;
+}
+
+// The timed frame's fence signalled
+static void gov_fence_signalled(void) {
+	int64_t sample = mono_now_us() - g_gov.fence_start_us;
+	close(g_gov.fence_fd);
+	g_gov.fence_fd = -1;
+	g_gov.gpu_us = g_gov.gpu_us ? g_gov.gpu_us + (sample - g_gov.gpu_us) / 8 : sample;
+	if (sample > gov_budget_us()) g_gov.misses++;
+}
+
+/**
+ * Count a flip that landed at least one refresh later than its commit allowed
+ *
+ * @param submit_us When the frame was committed to KMS
+ * @param flip_us When it reached the screen
+ */
+static void gov_note_flip(int64_t submit_us, int64_t flip_us) {
+	int64_t period = gov_budget_us();
+	if (submit_us > 0 && flip_us - submit_us > period + period / 2) g_gov.misses++;
+}
+
+/**
+ * Per-frame governor step: every GOV_WINDOW frames, drop one level if 10% of the
+ * frames missed their deadline; raise one level after three calm windows in which
+ * the GPU time projected for the larger size still fits 80% of the budget.
+ */
+static void gov_frame_done(void) {
+	if (!g_gov.enabled || ++g_gov.frames < GOV_WINDOW) return;
+	int64_t budget = gov_budget_us();
+	int64_t cost = g_gov.gpu_us ? g_gov.gpu_us : g_render_cost_us; // CPU time without a GPU fence
+	int old = g_gov.level;
+	if (g_gov.misses * 10 >= g_gov.frames && g_gov.level < GOV_LEVELS - 1) {
+		g_gov.level++;
+		g_gov.calm_windows = 0;
+	} else if (g_gov.misses == 0 && g_gov.level > 0) {
+		float up = g_gov_scales[g_gov.level - 1] / g_gov_scales[g_gov.level];
+		if ((double)cost * up * up < (double)budget * 0.8) {
+			if (++g_gov.calm_windows >= 3) { g_gov.level--; g_gov.calm_windows = 0; }
+		} else {
+			g_gov.calm_windows = 0;
+		}
+	}
+	if (g_gov.level != old) {
+		fprintf(stderr, "[gov] FBO scale %.3f -> %.3f (gpu %.2f ms, %d/%d missed, budget %.2f ms)\n",
+			(double)g_gov_scales[old], (double)g_gov_scales[g_gov.level], (double)cost / 1000.0,
+			g_gov.misses, g_gov.frames, (double)budget / 1000.0);
+	}
+	g_gov.frames = 0;
+	g_gov.misses = 0;
+}
+
+/**
+ * Linear scale (of the screen size) an offscreen target needs: no more than the
+ * source resolution and no more than the on-screen extent, in 1/16 steps.
+ *
+ * @param p Player whose source size applies (NULL = unknown)
+ * @param extent Largest on-screen extent of the warped quad, as a fraction of the screen
+ * @param ref_w,ref_h Full-scale target size
+ */
+static float gov_base_scale(mpv_player_t *p, float extent, int ref_w, int ref_h) {
+	float scale = extent < 1.0f ? extent : 1.0f;
+	int sw = p ? atomic_load(&p->src_w) : 0, sh = p ? atomic_load(&p->src_h) : 0;
+	if (sw > 0 && sh > 0 && ref_w > 0 && ref_h > 0) {
+		float src = fmaxf((float)sw / (float)ref_w, (float)sh / (float)ref_h);
+		if (src < scale) scale = src;
+	}
+	scale = ceilf(scale * 16.0f) / 16.0f;
+	return scale < 0.0625f ? 0.0625f : scale;
+}
+
+// --- Per-stage frame profiler (PICKLE_PROFILE=1) ---
+// The render thread records each stage of render_frame_fixed() into log-linear
+// histograms (8 buckets per power of two, so percentiles are within 12.5%); the
+// control thread reads them without locking for the periodic report and the
+// metrics endpoint. Recording, GPU timestamps and the stderr report are switched
+// separately so a metrics-only kiosk pays for neither of the last two.
+enum {
+	PROF_MPV,          // mpv_render_context_render (all instances)
+	PROF_WARP,         // keystone / mesh / multi-video compose pass
+	PROF_OVERLAY,      // border and corner markers
+	PROF_SWAP,         // fence, swap/flush and commit
+	PROF_FLIP,         // commit -> page-flip event
+	PROF_FRAME,        // whole render_frame_fixed call
+	PROF_GPU_MPV,      // GPU time of the mpv stage (EXT_disjoint_timer_query)
+	PROF_GPU_COMPOSE,  // GPU time of warp + overlays
+	PROF_STAGES
+};
+static const char *g_prof_names[PROF_STAGES] = { "mpv", "warp", "overlay", "swap", "flip", "frame", "gpu_mpv", "gpu_compose" };
+#define PROF_SUB 8
+#define PROF_BUCKETS (PROF_SUB * 22)  // up to ~8 s
+typedef struct {
+	_Atomic uint32_t bucket[PROF_BUCKETS];
+	_Atomic int64_t max_us;            // since start
+	_Atomic int64_t sum_us;            // since start (metrics endpoint)
+	_Atomic int64_t interval_max_us;   // since the last periodic report (reset by the reader)
+} prof_hist_t;
+static int g_prof_enabled = 0;    // Record CPU stage timings
+static int g_prof_gpu_timing = 0; // Also write GPU timestamps (PICKLE_PROFILE, --bench)
+static int g_prof_report = 0;     // Print the periodic [prof] report (PICKLE_PROFILE only)
+static const char *g_prof_dump_path = NULL; // PICKLE_PROFILE_DUMP: JSON written at exit
+static prof_hist_t g_prof_hist[PROF_STAGES];
+static struct {
+	int stage;                  // Stage the render thread is in (-1 = none)
+	int64_t stage_start_us;
+	int64_t frame_start_us;
+	int64_t acc_us[PROF_SWAP + 1]; // CPU time per stage in the current frame
+} g_prof_cur = { .stage = -1 };
+static uint32_t g_prof_prev[PROF_STAGES][PROF_BUCKETS]; // reader copy at the last report
+static struct timeval g_prof_last = {0};
+
+// GPU timestamps at the mpv, warp and swap marks; a few frames in flight so reads never stall
+#define PROF_GPU_RING 4
+static struct {
+	int state;                          // 0 = not probed, 1 = usable, -1 = unavailable
+	PFNGLGENQUERIESEXTPROC gen;
+	PFNGLDELETEQUERIESEXTPROC del;
+	PFNGLQUERYCOUNTEREXTPROC counter;
+	PFNGLGETQUERYOBJECTUIVEXTPROC get_uiv;
+	PFNGLGETQUERYOBJECTUI64VEXTPROC get_ui64v;
+	GLuint q[PROF_GPU_RING][3];
+	int issued[PROF_GPU_RING];          // bitmask of marks written this round
+	int slot;                           // Slot of the current frame (-1 = not timed)
+	int next;
+} g_prof_gpu = { .slot = -1 };
+
+static int prof_bucket(int64_t us) {
+	if (us < PROF_SUB) return us < 0 ? 0 : (int)us;
+	int e = 63 - __builtin_clzll((unsigned long long)us);
+	int idx = (e - 2) * PROF_SUB + (int)((us >> (e - 3)) & (PROF_SUB - 1));
+	return idx < PROF_BUCKETS ? idx : PROF_BUCKETS - 1;
+}
+
+// Lower bound (us) of a histogram bucket; *width receives its size
+static int64_t prof_bucket_low(int idx, int64_t *width) {
+	if (idx < PROF_SUB) { *width = 1; return idx; }
+	int e = idx / PROF_SUB + 2;
+	*width = (int64_t)1 << (e - 3);
+	return (int64_t)(PROF_SUB + idx % PROF_SUB) << (e - 3);
+}
+
+static void prof_max(_Atomic int64_t *m, int64_t v) {
+	int64_t cur = atomic_load_explicit(m, memory_order_relaxed);
+	while (v > cur && !atomic_compare_exchange_weak_explicit(m, &cur, v, memory_order_relaxed, memory_order_relaxed)) { }
+}
+
+static void prof_record(int stage, int64_t us) {
+	prof_hist_t *h = &g_prof_hist[stage];
+	atomic_fetch_add_explicit(&h->bucket[prof_bucket(us)], 1, memory_order_relaxed);
+	prof_max(&h->max_us, us);
+	prof_max(&h->interval_max_us, us);
+	atomic_fetch_add_explicit(&h->sum_us, us, memory_order_relaxed);
+}
+
+// Probe EXT_disjoint_timer_query timestamps (render thread, context current)
+static void prof_gpu_init(void) {
+	g_prof_gpu.state = -1;
+	const char *exts = (const char *)glGetString(GL_EXTENSIONS);
+	if (!exts || !strstr(exts, "GL_EXT_disjoint_timer_query")) {
+		LOG_INFO("Profiler: GL_EXT_disjoint_timer_query missing, GPU stages disabled");
+		return;
+	}
+	g_prof_gpu.gen = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+	g_prof_gpu.del = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+	g_prof_gpu.counter = (PFNGLQUERYCOUNTEREXTPROC)eglGetProcAddress("glQueryCounterEXT");
+	g_prof_gpu.get_uiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+	g_prof_gpu.get_ui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+	PFNGLGETQUERYIVEXTPROC get_iv = (PFNGLGETQUERYIVEXTPROC)eglGetProcAddress("glGetQueryivEXT");
+	if (!g_prof_gpu.gen || !g_prof_gpu.del || !g_prof_gpu.counter || !g_prof_gpu.get_uiv || !g_prof_gpu.get_ui64v || !get_iv) return;
+	// Timestamps (rather than TIME_ELAPSED) do not collide with mpv's own timer queries
+	GLint bits = 0;
+	get_iv(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &bits);
+	if (bits <= 0) {
+		LOG_INFO("Profiler: GPU timestamps unsupported, GPU stages disabled");
+		return;
+	}
+	g_prof_gpu.gen(PROF_GPU_RING * 3, &g_prof_gpu.q[0][0]);
+	g_prof_gpu.state = 1;
+	LOG_INFO("Profiler: GPU timestamps enabled (%d bits)", bits);
+}
+
+// Collect finished GPU timestamp sets and pick a slot for the new frame
+static void prof_gpu_frame_begin(void) {
+	if (g_prof_gpu.state == 0) prof_gpu_init();
+	g_prof_gpu.slot = -1;
+	if (g_prof_gpu.state != 1) return;
+	GLint disjoint = 0;
+	glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint); // also clears the flag
+	for (int s = 0; s < PROF_GPU_RING; s++) {
+		if (g_prof_gpu.issued[s] != 7) { g_prof_gpu.issued[s] = 0; continue; } // frame ended early
+		GLuint ready = 0;
+		g_prof_gpu.get_uiv(g_prof_gpu.q[s][2], GL_QUERY_RESULT_AVAILABLE_EXT, &ready);
+		if (!ready && !disjoint) continue;
+		if (!disjoint) {
+			GLuint64 t[3];
+			for (int k = 0; k < 3; k++) g_prof_gpu.get_ui64v(g_prof_gpu.q[s][k], GL_QUERY_RESULT_EXT, &t[k]);
+			prof_record(PROF_GPU_MPV, (int64_t)((t[1] - t[0]) / 1000));
+			prof_record(PROF_GPU_COMPOSE, (int64_t)((t[2] - t[1]) / 1000));
+		}
+		g_prof_gpu.issued[s] = 0;
+	}
+	if (!g_prof_gpu.issued[g_prof_gpu.next]) {
+		g_prof_gpu.slot = g_prof_gpu.next;
+		g_prof_gpu.next = (g_prof_gpu.next + 1) % PROF_GPU_RING;
+	}
+}
+
+static void prof_gpu_destroy(void) {
+	if (g_prof_gpu.state == 1) g_prof_gpu.del(PROF_GPU_RING * 3, &g_prof_gpu.q[0][0]);
+	g_prof_gpu.state = 0;
+}
+
+// Start of render_frame_fixed (render thread)
+static void prof_frame_begin(void) {
+	if (!g_prof_enabled) return;
+	g_prof_cur.stage = -1;
+	g_prof_cur.frame_start_us = mono_now_us();
+	memset(g_prof_cur.acc_us, 0, sizeof(g_prof_cur.acc_us));
+	if (g_prof_gpu_timing) prof_gpu_frame_begin();
+}
+
+/**
+ * Enter a frame stage; time since the previous mark goes to the previous stage.
+ * PROF_MPV, PROF_WARP and PROF_SWAP also write the GPU timestamps.
+ *
+ * @param stage PROF_MPV .. PROF_SWAP
+ */
+static void prof_mark(int stage) {
+	if (!g_prof_enabled) return;
+	int64_t now = mono_now_us();
+	if (g_prof_cur.stage >= 0) g_prof_cur.acc_us[g_prof_cur.stage] += now - g_prof_cur.stage_start_us;
+	g_prof_cur.stage = stage;
+	g_prof_cur.stage_start_us = now;
+	int s = g_prof_gpu.slot;
+	int k = stage == PROF_MPV ? 0 : stage == PROF_WARP ? 1 : stage == PROF_SWAP ? 2 : -1;
+	if (s >= 0 && k >= 0 && !(g_prof_gpu.issued[s] & (1 << k))) {
+		g_prof_gpu.counter(g_prof_gpu.q[s][k], GL_TIMESTAMP_EXT);
+		g_prof_gpu.issued[s] |= 1 << k;
+	}
+}
+
+// After render_frame_fixed returned (render thread)
+static void prof_frame_end(void) {
+	if (!g_prof_enabled || g_prof_cur.stage < 0) return; // nothing rendered
+	prof_mark(PROF_SWAP); // close the running stage
+	int64_t now = mono_now_us();
+	g_prof_cur.acc_us[PROF_SWAP] += now - g_prof_cur.stage_start_us;
+	for (int st = PROF_MPV; st <= PROF_SWAP; st++) prof_record(st, g_prof_cur.acc_us[st]);
+	prof_record(PROF_FRAME, now - g_prof_cur.frame_start_us);
+	g_prof_cur.stage = -1;
+}
+
+/**
+ * Percentiles of a histogram.
+ *
+ * @param counts Bucket counts
+ * @param n Total of counts
+ * @param pct Percentiles (0-1) to compute
+ * @param out Results in ms (bucket midpoints)
+ * @param np Number of percentiles, ascending
+ */
+static void prof_percentiles(const uint32_t *counts, uint64_t n, const double *pct, double *out, int np) {
+	uint64_t cum = 0;
+	int k = 0;
+	for (int i = 0; i < PROF_BUCKETS && k < np; i++) {
+		cum += counts[i];
+		while (k < np && n && (double)cum >= pct[k] * (double)n) {
+			int64_t width, low = prof_bucket_low(i, &width);
+			out[k++] = ((double)low + (double)width / 2.0) / 1000.0;
+		}
+	}
+	while (k < np) out[k++] = 0.0;
+}
+
+// Periodic per-stage report (control thread), every PICKLE_STATS_INTERVAL
+static void prof_log_periodic(void) {
+	if (!g_prof_report) return;
+	struct timeval now; gettimeofday(&now, NULL);
+	if (tv_diff(&now, &g_prof_last) < g_stats_interval_sec) return;
+	g_prof_last = now;
+	static const double pct[3] = { 0.50, 0.95, 0.99 };
+	for (int st = 0; st < PROF_STAGES; st++) {
+		uint32_t delta[PROF_BUCKETS];
+		uint64_t n = 0;
+		for (int i = 0; i < PROF_BUCKETS; i++) {
+			uint32_t c = atomic_load_explicit(&g_prof_hist[st].bucket[i], memory_order_relaxed);
+			delta[i] = c - g_prof_prev[st][i];
+			g_prof_prev[st][i] = c;
+			n += delta[i];
+		}
+		int64_t max_us = atomic_exchange_explicit(&g_prof_hist[st].interval_max_us, 0, memory_order_relaxed);
+		if (!n) continue;
+		double v[3];
+		prof_percentiles(delta, n, pct, v, 3);
+		fprintf(stderr, "[prof] %-11s n=%-5llu p50=%.2fms p95=%.2fms p99=%.2fms max=%.2fms\n",
+			g_prof_names[st], (unsigned long long)n, v[0], v[1], v[2], (double)max_us / 1000.0);
+	}
+}
+
+/**
+ * Write the whole-run histograms as JSON (after the render thread has stopped)
+ *
+ * @param path Output file
+ * @return true on success
+ */
+static bool prof_dump(const char *path) {
+	FILE *f = fopen(path, "w");
+	if (!f) {
+		LOG_ERROR("Cannot write profile to %s: %s", path, strerror(errno));
+		return false;
+	}
+	static const double pct[3] = { 0.50, 0.95, 0.99 };
+	fprintf(f, "{\n  \"unit\": \"ms\",\n  \"stages\": {");
+	for (int st = 0; st < PROF_STAGES; st++) {
+		uint32_t counts[PROF_BUCKETS];
+		uint64_t n = 0;
+		for (int i = 0; i < PROF_BUCKETS; i++) {
+			counts[i] = atomic_load(&g_prof_hist[st].bucket[i]);
+			n += counts[i];
+		}
+		double v[3];
+		prof_percentiles(counts, n, pct, v, 3);
+		fprintf(f, "%s\n    \"%s\": { \"count\": %llu, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"buckets\": [",
+			st ? "," : "", g_prof_names[st], (unsigned long long)n, v[0], v[1], v[2],
+			(double)atomic_load(&g_prof_hist[st].max_us) / 1000.0);
+		// Non-empty buckets as [lower_ms, upper_ms, count]
+		bool first = true;
+		for (int i = 0; i < PROF_BUCKETS; i++) {
+			if (!counts[i]) continue;
+			int64_t width, low = prof_bucket_low(i, &width);
+			fprintf(f, "%s[%.3f, %.3f, %u]", first ? "" : ", ", (double)low / 1000.0, (double)(low + width) / 1000.0, counts[i]);
+			first = false;
+		}
+		fprintf(f, "] }");
+	}
+	fprintf(f, "\n  }\n}\n");
+	bool ok = fclose(f) == 0;
+	if (ok) LOG_INFO("Profile written to %s", path);
+	return ok;
+}
+
+// Render-thread counters for the metrics endpoint (relaxed atomics, always kept)
+static struct {
+	_Atomic uint64_t flips;        // Page flips completed
+	_Atomic int64_t flip_sum_us;   // Commit -> flip, summed
+	_Atomic int64_t flip_min_us;
+	_Atomic int64_t flip_max_us;
+} g_metrics_rt;
+
+static void metrics_note_flip(int64_t us) {
+	uint64_t n = atomic_fetch_add_explicit(&g_metrics_rt.flips, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&g_metrics_rt.flip_sum_us, us, memory_order_relaxed);
+	if (n == 0 || us < atomic_load_explicit(&g_metrics_rt.flip_min_us, memory_order_relaxed))
+		atomic_store_explicit(&g_metrics_rt.flip_min_us, us, memory_order_relaxed);
+	prof_max(&g_metrics_rt.flip_max_us, us);
+}
+
 static void stats_log_periodic(mpv_player_t *p) {
 	if (!g_stats_enabled) return;
 	struct timeval now; gettimeofday(&now, NULL);
@@ -978,11 +2152,25 @@ static void stats_log_periodic(mpv_player_t *p) {
 		mpv_get_property(p->mpv, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &mpv_fps);
 		mpv_get_property(p->mpv, "container-fps", MPV_FORMAT_DOUBLE, &container_fps);
 	}
-	fprintf(stderr, "[stats] total=%.2fs frames=%llu avg_fps=%.2f inst_fps=%.2f mpv_fps=%.1f container=%.1f dropped=%lld/%lld\n",
+	// Offscreen FBO traffic in MB/s over the interval, and what the target format saves
+	uint64_t fbo_bytes = atomic_load(&g_stats_fbo_bytes), fbo_saved = atomic_load(&g_stats_fbo_saved);
+	double fbo_mbs = since_last > 0.0 ? (double)(fbo_bytes - g_stats_last_fbo_bytes) / since_last / 1e6 : 0.0;
+	double saved_mbs = since_last > 0.0 ? (double)(fbo_saved - g_stats_last_fbo_saved) / since_last / 1e6 : 0.0;
+	fprintf(stderr, "[stats] total=%.2fs frames=%llu avg_fps=%.2f inst_fps=%.2f mpv_fps=%.1f container=%.1f dropped=%lld/%lld hwdec=%s(%s) fbo=%s %.1fMB/s saved=%.1fMB/s\n",
 			total, (unsigned long long)frames_now, avg_fps, inst_fps,
-			mpv_fps, container_fps, (long long)drop_dec, (long long)drop_vo);
+			mpv_fps, container_fps, (long long)drop_dec, (long long)drop_vo,
+			(p && p->hwdec_current[0]) ? p->hwdec_current : "?", hwdec_path_str(p),
+			g_fbo_formats[g_fbo_format].name, fbo_mbs, saved_mbs);
+	if (p && p->cache) {
+		fprintf(stderr, "[stats] cache=%s fill=%.1fs/%.1fs %.1fMB in=%.2fMB/s limit=%lldMiB back=%lldMiB underruns=%llu\n",
+				p->cache->name, p->cache_fill_s, p->cache_readahead, (double)p->cache_fill_bytes / 1e6,
+				p->cache_in_rate / 1e6, (long long)(p->cache_max_bytes / CACHE_MIB),
+				(long long)(p->cache_back_bytes / CACHE_MIB), (unsigned long long)p->cache_underruns);
+	}
 	g_stats_last = now;
 	g_stats_last_frames = frames_now;
+	g_stats_last_fbo_bytes = fbo_bytes;
+	g_stats_last_fbo_saved = fbo_saved;
 }
 
 static void stats_log_final(mpv_player_t *p) {
@@ -995,8 +2183,21 @@ static void stats_log_final(mpv_player_t *p) {
 		mpv_get_property(p->mpv, "drop-frame-count", MPV_FORMAT_INT64, &drop_dec);
 		mpv_get_property(p->mpv, "vo-drop-frame-count", MPV_FORMAT_INT64, &drop_vo);
 	}
-	fprintf(stderr, "[stats-final] duration=%.2fs frames=%llu avg_fps=%.2f dropped_dec=%lld dropped_vo=%lld\n",
-			total, (unsigned long long)g_stats_frames, avg_fps, (long long)drop_dec, (long long)drop_vo);
+	fprintf(stderr, "[stats-final] duration=%.2fs frames=%llu avg_fps=%.2f dropped_dec=%lld dropped_vo=%lld hwdec_path=%s fbo=%s fbo_traffic=%.1fMB saved=%.1fMB\n",
+			total, (unsigned long long)g_stats_frames, avg_fps, (long long)drop_dec, (long long)drop_vo,
+			hwdec_path_str(p), g_fbo_formats[g_fbo_format].name,
+			(double)atomic_load(&g_stats_fbo_bytes) / 1e6, (double)atomic_load(&g_stats_fbo_saved) / 1e6);
+	fprintf(stderr, "[stats-final] memory mode=%s offscreen=%.1fMB peak=%.1fMB\n", g_low_mem ? "low" : "standard",
+			(double)atomic_load(&g_mem_fbo_bytes) / 1e6, (double)atomic_load(&g_mem_fbo_peak) / 1e6);
+	if (p && p->cache) {
+		fprintf(stderr, "[stats-final] cache=%s readahead=%.1fs limit=%lldMiB underruns=%llu\n", p->cache->name,
+				p->cache_readahead, (long long)(p->cache_max_bytes / CACHE_MIB), (unsigned long long)p->cache_underruns);
+	}
+	if (g_stall_recoveries) {
+		fprintf(stderr, "[stats-final] stalls demux=%llu decode=%llu scanout=%llu recoveries=%llu\n",
+				(unsigned long long)g_stall_count[STALL_DEMUX], (unsigned long long)g_stall_count[STALL_DECODE],
+				(unsigned long long)g_stall_count[STALL_SCANOUT], (unsigned long long)g_stall_recoveries);
+	}
 	
 	// Print frame timing stats if enabled
 	if (g_frame_timing_enabled && g_flip_count > 0) {
@@ -1005,39 +2206,477 @@ static void stats_log_final(mpv_player_t *p) {
 	}
 }
 
-// Display a help overlay using mpv's built-in OSD
-static void show_help_overlay(mpv_handle *mpv) {
-	if (!mpv) return;
-	const char *text =
-		"Pickle controls:\n"
-		"  q: quit    h: help overlay\n"
-		"  k: toggle keystone    1-4: select corner\n"
-		"  arrows / WASD: move point\n"
-		"  +/-: step    r: reset\n"
-		"  b: toggle border    [ / ]: border width\n"
-	"  c: toggle corner markers\n"
-		"  o: flip X (mirror)  p: flip Y (invert)\n"
-		"  m: mesh mode (experimental)\n"
-		"  S: save keystone\n"
-		"\nGamepad:\n"
-		"  START: toggle keystone\n"
-		"  Cycle button (default X): corners TL -> TR -> BR -> BL\n"
-		"  Help button (default B): toggle this help\n"
-		"  D-Pad/Left stick: move point\n"
-		"  L1/R1: step -/+    SELECT: reset    Y/Home(Guide): toggle border\n"
-		"  START+SELECT (hold 2s): quit\n";
-	// Reduce font size and move OSD to top-left with small margins so it fits better
-	if (!g_osd_saved.saved) {
-		int64_t v=0; char *s=NULL;
-		if (mpv_get_property(mpv, "osd-font-size", MPV_FORMAT_INT64, &v) >= 0) g_osd_saved.font_size = v; else g_osd_saved.font_size = 36;
-		if (mpv_get_property(mpv, "osd-margin-x", MPV_FORMAT_INT64, &v) >= 0) g_osd_saved.margin_x = v; else g_osd_saved.margin_x = 10;
-		if (mpv_get_property(mpv, "osd-margin-y", MPV_FORMAT_INT64, &v) >= 0) g_osd_saved.margin_y = v; else g_osd_saved.margin_y = 10;
-		if (mpv_get_property(mpv, "osd-align-x", MPV_FORMAT_STRING, &s) >= 0 && s) {
-			strncpy(g_osd_saved.align_x, s, sizeof(g_osd_saved.align_x)-1);
-			g_osd_saved.align_x[sizeof(g_osd_saved.align_x)-1]='\0';
-			mpv_free(s);
-		} else strcpy(g_osd_saved.align_x, "center");
-		s = NULL;
+// Decoder + VO frame drops reported by a player so far
+static int64_t bench_drops(mpv_player_t *p) {
+	int64_t drop_dec = 0, drop_vo = 0;
+	if (!p || !p->mpv) return 0;
+	mpv_get_property(p->mpv, "drop-frame-count", MPV_FORMAT_INT64, &drop_dec);
+	mpv_get_property(p->mpv, "vo-drop-frame-count", MPV_FORMAT_INT64, &drop_vo);
+	return drop_dec + drop_vo;
+}
+
+/**
+ * Benchmark child: start measuring after the warm-up, then report one result
+ * line to the --bench parent and stop (control thread)
+ *
+ * @param players mpv players of this process
+ * @param num_players Number of players
+ */
+static void bench_poll(mpv_player_t *players, int num_players) {
+	static int64_t start_us = 0;
+	static int start_frames = 0;
+	static int64_t start_drops = 0;
+	static uint32_t start_buckets[PROF_BUCKETS];
+	int frames = atomic_load(&g_render_frames);
+	if (!start_us) {
+		if (frames < BENCH_WARMUP) return;
+		start_us = mono_now_us();
+		start_frames = frames;
+		for (int i = 0; i < num_players; i++) start_drops += bench_drops(&players[i]);
+		for (int i = 0; i < PROF_BUCKETS; i++) start_buckets[i] = atomic_load(&g_prof_hist[PROF_FRAME].bucket[i]);
+		return;
+	}
+	if (frames - start_frames < g_bench_frames) return;
+	double secs = (double)(mono_now_us() - start_us) / 1e6;
+	int64_t drops = -start_drops;
+	for (int i = 0; i < num_players; i++) drops += bench_drops(&players[i]);
+	uint32_t delta[PROF_BUCKETS];
+	uint64_t n = 0;
+	int max_idx = 0;
+	for (int i = 0; i < PROF_BUCKETS; i++) {
+		delta[i] = atomic_load(&g_prof_hist[PROF_FRAME].bucket[i]) - start_buckets[i];
+		n += delta[i];
+		if (delta[i]) max_idx = i;
+	}
+	static const double pct[3] = { 0.50, 0.95, 0.99 };
+	double v[3];
+	prof_percentiles(delta, n, pct, v, 3);
+	int64_t width, low = prof_bucket_low(max_idx, &width);
+	char line[256];
+	int len = snprintf(line, sizeof(line), "%d %.3f %.3f %.3f %.3f %.3f %lld\n", frames - start_frames, secs,
+		v[0], v[1], v[2], (double)(low + width) / 1000.0, (long long)drops);
+	if (g_bench_fd >= 0 && len > 0 && write(g_bench_fd, line, (size_t)len) < 0) {
+		LOG_WARN("[bench] Cannot report result: %s", strerror(errno));
+	}
+	g_stop = 1;
+}
+
+// Reap a benchmark child within ms milliseconds; false if it is still running
+static bool bench_reap(pid_t pid, int *status, int ms) {
+	int64_t deadline = mono_now_us() + (int64_t)ms * 1000;
+	for (;;) {
+		pid_t r = waitpid(pid, status, WNOHANG);
+		if (r == pid || (r < 0 && errno != EINTR)) return true;
+		if (mono_now_us() >= deadline) return false;
+		usleep(20000);
+	}
+}
+
+/**
+ * --bench driver: run every scenario in a forked child (a fresh player with the
+ * scenario's settings) and print one result row per scenario on stdout.
+ *
+ * @param src Source for the first video (for the log line)
+ * @param exit_code Receives the parent's exit status (non-zero if a scenario failed)
+ * @return Scenario index in the child that must run it, -1 in the parent when done
+ */
+static int bench_run(const char *src, int *exit_code) {
+	int n = (int)(sizeof(g_bench_scenarios) / sizeof(g_bench_scenarios[0]));
+	fprintf(stderr, "[bench] %d scenarios, %d frames each after %d warm-up frames, source %s\n",
+		n, g_bench_frames, BENCH_WARMUP, src);
+	char rows[sizeof(g_bench_scenarios) / sizeof(g_bench_scenarios[0])][160];
+	int failed = 0;
+	for (int s = 0; s < n; s++) {
+		int pfd[2];
+		if (pipe(pfd) < 0) {
+			LOG_ERROR("[bench] pipe failed: %s", strerror(errno));
+			*exit_code = 1;
+			return -1;
+		}
+		fflush(stdout);
+		fflush(stderr);
+		pid_t pid = fork();
+		if (pid < 0) {
+			int err = errno;
+			close(pfd[0]);
+			close(pfd[1]);
+			snprintf(rows[s], sizeof(rows[s]), "%-16s FAILED (fork: %s)", g_bench_scenarios[s].name, strerror(err));
+			fprintf(stderr, "[bench] %s\n", rows[s]);
+			failed++;
+			continue;
+		}
+		if (pid == 0) {
+			close(pfd[0]);
+			g_bench_fd = pfd[1];
+			g_bench_scenario = s;
+			return s;
+		}
+		close(pfd[1]);
+		char buf[256] = {0};
+		size_t got = 0;
+		// A scenario that never reaches its frame count (mpv failure, hang) is stopped
+		int64_t deadline = mono_now_us() + (int64_t)(BENCH_TIMEOUT_S + g_bench_frames / 10) * 1000000;
+		bool timed_out = false;
+		while (got < sizeof(buf) - 1) {
+			int wait_ms = (int)((deadline - mono_now_us()) / 1000);
+			if (wait_ms <= 0) {
+				LOG_WARN("[bench] %s timed out", g_bench_scenarios[s].name);
+				timed_out = true;
+				break;
+			}
+			struct pollfd pf = { .fd = pfd[0], .events = POLLIN };
+			int pr = poll(&pf, 1, wait_ms);
+			if (pr < 0 && errno == EINTR) continue;
+			if (pr <= 0) continue;
+			ssize_t r = read(pfd[0], buf + got, sizeof(buf) - 1 - got);
+			if (r <= 0) break; // child exited
+			got += (size_t)r;
+		}
+		close(pfd[0]);
+		// A wedged child (mpv or the GL driver, ignoring SIGTERM) must not hang the run:
+		// SIGTERM, then SIGKILL, each with a bounded wait; one stuck in D-state is left behind
+		int status = 0;
+		if (timed_out || !bench_reap(pid, &status, BENCH_REAP_MS)) {
+			kill(pid, SIGTERM);
+			if (!bench_reap(pid, &status, BENCH_REAP_MS)) {
+				kill(pid, SIGKILL);
+				if (!bench_reap(pid, &status, BENCH_REAP_MS)) {
+					LOG_WARN("[bench] %s (pid %d) did not exit after SIGKILL", g_bench_scenarios[s].name, (int)pid);
+				}
+			}
+		}
+		int frames = 0;
+		long long drops = 0;
+		double secs = 0, p50 = 0, p95 = 0, p99 = 0, max = 0;
+		bool ok = !timed_out && sscanf(buf, "%d %lf %lf %lf %lf %lf %lld", &frames, &secs, &p50, &p95, &p99, &max, &drops) == 7;
+		if (ok) {
+			snprintf(rows[s], sizeof(rows[s]), "%-16s %7d %8.1f %8.2f %8.2f %8.2f %8.2f %6lld",
+				g_bench_scenarios[s].name, frames, secs > 0 ? frames / secs : 0.0, p50, p95, p99, max, drops);
+		} else if (timed_out) {
+			snprintf(rows[s], sizeof(rows[s]), "%-16s FAILED (timed out)", g_bench_scenarios[s].name);
+			failed++;
+		} else {
+			snprintf(rows[s], sizeof(rows[s]), "%-16s FAILED (exit status %d)", g_bench_scenarios[s].name,
+				WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+			failed++;
+		}
+		fprintf(stderr, "[bench] %s\n", rows[s]);
+	}
+	// Results table on stdout so it can be captured apart from the logs
+	printf("%-16s %7s %8s %8s %8s %8s %8s %6s\n", "scenario", "frames", "fps", "p50_ms", "p95_ms", "p99_ms", "max_ms", "drops");
+	for (int s = 0; s < n; s++) printf("%s\n", rows[s]);
+	fflush(stdout);
+	*exit_code = failed ? 1 : 0;
+	return -1;
+}
+
+/**
+ * Scenario keystone state, applied after keystone_init() in a benchmark child:
+ * a fixed trapezoid, and for the mesh scenario a gentle pincushion on the mesh.
+ */
+static void bench_apply_keystone(void) {
+	const bench_scenario_t *b = &g_bench_scenarios[g_bench_scenario];
+	if (!b->keystone) return;
+	static const float corners[4][2] = { {0.04f, 0.03f}, {0.97f, 0.0f}, {1.0f, 0.96f}, {0.0f, 1.0f} };
+	g_keystone.enabled = true;
+	memcpy(g_keystone.points, corners, sizeof(corners));
+	if (b->mesh && g_keystone.mesh_x) {
+		g_keystone.mesh_enabled = true;
+		int n = g_keystone.mesh_size;
+		for (int r = 0; r < n; r++) {
+			for (int c = 0; c < n; c++) {
+				float x = (float)c / (float)(n - 1);
+				float y = (float)r / (float)(n - 1);
+				g_keystone.mesh_x[r * n + c] = x + 0.03f * sinf((float)M_PI * y) * (0.5f - x);
+				g_keystone.mesh_y[r * n + c] = y + 0.03f * sinf((float)M_PI * x) * (0.5f - y);
+			}
+		}
+	}
+	g_keystone.geom_gen++;
+}
+
+// --- Metrics endpoint (PICKLE_METRICS_SOCKET) ---
+// Prometheus text format on a Unix-domain socket, serviced from the control
+// thread's poll() loop. Render-thread counters are atomics (g_metrics_rt); mpv
+// properties are read by the control thread, so a scrape never touches rendering.
+#define METRICS_MAX_CLIENTS 4
+#define METRICS_IDLE_MS 200  // a client that sends no request gets the plain payload after this
+static struct {
+	int listen_fd;
+	char path[108];          // sun_path; empty for an abstract socket
+	int client_fd[METRICS_MAX_CLIENTS];
+	int64_t client_since_us[METRICS_MAX_CLIENTS];
+} g_metrics = { .listen_fd = -1, .client_fd = { -1, -1, -1, -1 } };
+static char g_metrics_buf[32768];
+
+typedef struct { char *buf; size_t cap, len; } metrics_out_t;
+
+static void metrics_printf(metrics_out_t *o, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void metrics_printf(metrics_out_t *o, const char *fmt, ...) {
+	if (o->len >= o->cap) return;
+	va_list ap;
+	va_start(ap, fmt);
+	int w = vsnprintf(o->buf + o->len, o->cap - o->len, fmt, ap);
+	va_end(ap);
+	if (w > 0) o->len = (o->len + (size_t)w < o->cap) ? o->len + (size_t)w : o->cap;
+}
+
+/**
+ * Bind a non-blocking Unix-domain stream socket and listen on it
+ *
+ * @param what Setting named in error messages
+ * @param path Socket path, or "@name" for the abstract namespace
+ * @param saved Receives the path to unlink at exit (left empty for an abstract socket)
+ * @param backlog listen() backlog
+ * @return The listening fd, or -1
+ */
+static int unix_listen(const char *what, const char *path, char saved[108], int backlog) {
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	size_t plen = strlen(path);
+	if (plen == 0 || plen >= sizeof(addr.sun_path)) {
+		LOG_ERROR("%s path too long or empty", what);
+		return -1;
+	}
+	memcpy(addr.sun_path, path, plen);
+	socklen_t alen = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + plen);
+	if (path[0] == '@') {
+		addr.sun_path[0] = '\0';
+	} else {
+		// Replace a stale socket from a previous run (never a regular file)
+		struct stat st;
+		if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+		snprintf(saved, 108, "%s", path);
+	}
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0 || bind(fd, (struct sockaddr *)&addr, alen) < 0 || listen(fd, backlog) < 0) {
+		LOG_ERROR("%s %s: %s", what, path, strerror(errno));
+		if (fd >= 0) close(fd);
+		saved[0] = '\0';
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * Start listening for metric scrapes
+ *
+ * @param path Socket path, or "@name" for the abstract namespace
+ * @return true if the socket is listening
+ */
+static bool metrics_open(const char *path) {
+	g_metrics.listen_fd = unix_listen("PICKLE_METRICS_SOCKET", path, g_metrics.path, METRICS_MAX_CLIENTS);
+	if (g_metrics.listen_fd < 0) return false;
+	LOG_INFO("Metrics available on unix socket %s", path);
+	return true;
+}
+
+static void metrics_close(void) {
+	for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+		if (g_metrics.client_fd[i] >= 0) { close(g_metrics.client_fd[i]); g_metrics.client_fd[i] = -1; }
+	}
+	if (g_metrics.listen_fd >= 0) { close(g_metrics.listen_fd); g_metrics.listen_fd = -1; }
+	if (g_metrics.path[0]) { unlink(g_metrics.path); g_metrics.path[0] = '\0'; }
+}
+
+/**
+ * Render the exposition text
+ *
+ * @return Length of the text in g_metrics_buf
+ */
+static size_t metrics_format(mpv_player_t *players, int num_players) {
+	metrics_out_t o = { g_metrics_buf, sizeof(g_metrics_buf), 0 };
+	struct timeval now; gettimeofday(&now, NULL);
+	metrics_printf(&o, "# HELP pickle_uptime_seconds Time since start.\n# TYPE pickle_uptime_seconds gauge\n");
+	metrics_printf(&o, "pickle_uptime_seconds %.3f\n", tv_diff(&now, &g_prog_start));
+	metrics_printf(&o, "# HELP pickle_frames_total Frames rendered.\n# TYPE pickle_frames_total counter\n");
+	metrics_printf(&o, "pickle_frames_total %llu\n", (unsigned long long)atomic_load(&g_stats_frames));
+	metrics_printf(&o, "# HELP pickle_frames_composed_total Frames recomposited from cached mpv output.\n# TYPE pickle_frames_composed_total counter\n");
+	metrics_printf(&o, "pickle_frames_composed_total %llu\n", (unsigned long long)atomic_load(&g_stats_composed));
+	metrics_printf(&o, "# HELP pickle_frames_idle_total Render opportunities skipped with nothing changed.\n# TYPE pickle_frames_idle_total counter\n");
+	metrics_printf(&o, "pickle_frames_idle_total %llu\n", (unsigned long long)atomic_load(&g_stats_idle));
+	metrics_printf(&o, "# HELP pickle_fbo_traffic_bytes_total Estimated offscreen FBO memory traffic (mpv writes plus warp reads).\n# TYPE pickle_fbo_traffic_bytes_total counter\n");
+	metrics_printf(&o, "pickle_fbo_traffic_bytes_total %llu\n", (unsigned long long)atomic_load(&g_stats_fbo_bytes));
+	metrics_printf(&o, "# HELP pickle_fbo_traffic_saved_bytes_total FBO traffic avoided against RGBA8 targets.\n# TYPE pickle_fbo_traffic_saved_bytes_total counter\n");
+	metrics_printf(&o, "pickle_fbo_traffic_saved_bytes_total %llu\n", (unsigned long long)atomic_load(&g_stats_fbo_saved));
+	uint64_t flips = atomic_load_explicit(&g_metrics_rt.flips, memory_order_relaxed);
+	int64_t flip_sum = atomic_load_explicit(&g_metrics_rt.flip_sum_us, memory_order_relaxed);
+	metrics_printf(&o, "# HELP pickle_flips_total Page flips completed.\n# TYPE pickle_flips_total counter\n");
+	metrics_printf(&o, "pickle_flips_total %llu\n", (unsigned long long)flips);
+	metrics_printf(&o, "# HELP pickle_flip_latency_seconds Commit to page-flip completion.\n# TYPE pickle_flip_latency_seconds gauge\n");
+	metrics_printf(&o, "pickle_flip_latency_seconds{stat=\"min\"} %.6f\n",
+		(double)atomic_load_explicit(&g_metrics_rt.flip_min_us, memory_order_relaxed) / 1e6);
+	metrics_printf(&o, "pickle_flip_latency_seconds{stat=\"avg\"} %.6f\n", flips ? (double)flip_sum / (double)flips / 1e6 : 0.0);
+	metrics_printf(&o, "pickle_flip_latency_seconds{stat=\"max\"} %.6f\n",
+		(double)atomic_load_explicit(&g_metrics_rt.flip_max_us, memory_order_relaxed) / 1e6);
+	metrics_printf(&o, "# HELP pickle_stall_resets_total Playback stall recoveries.\n# TYPE pickle_stall_resets_total counter\n");
+	metrics_printf(&o, "pickle_stall_resets_total %llu\n", (unsigned long long)g_stall_recoveries);
+	metrics_printf(&o, "# HELP pickle_stalls_total Playback stalls by cause.\n# TYPE pickle_stalls_total counter\n");
+	for (int c = 0; c < STALL_CLASSES; c++)
+		metrics_printf(&o, "pickle_stalls_total{class=\"%s\"} %llu\n", g_stall_names[c], (unsigned long long)g_stall_count[c]);
+	metrics_printf(&o, "# HELP pickle_flip_timeouts_total Page flips whose event was late.\n# TYPE pickle_flip_timeouts_total counter\n");
+	metrics_printf(&o, "pickle_flip_timeouts_total %llu\n",
+		(unsigned long long)atomic_load_explicit(&g_wd.flip_timeouts, memory_order_relaxed));
+	metrics_printf(&o, "# HELP pickle_mpv_dropped_frames_total Frames dropped by mpv.\n# TYPE pickle_mpv_dropped_frames_total counter\n");
+	for (int i = 0; i < num_players; i++) {
+		int64_t drop_dec = 0, drop_vo = 0;
+		if (!players[i].mpv) continue;
+		mpv_get_property(players[i].mpv, "drop-frame-count", MPV_FORMAT_INT64, &drop_dec);
+		mpv_get_property(players[i].mpv, "vo-drop-frame-count", MPV_FORMAT_INT64, &drop_vo);
+		metrics_printf(&o, "pickle_mpv_dropped_frames_total{video=\"%d\",source=\"decoder\"} %lld\n", i, (long long)drop_dec);
+		metrics_printf(&o, "pickle_mpv_dropped_frames_total{video=\"%d\",source=\"vo\"} %lld\n", i, (long long)drop_vo);
+	}
+	metrics_printf(&o, "# HELP pickle_mpv_estimated_fps mpv estimated output frame rate.\n# TYPE pickle_mpv_estimated_fps gauge\n");
+	for (int i = 0; i < num_players; i++) {
+		double fps = 0.0;
+		if (!players[i].mpv) continue;
+		mpv_get_property(players[i].mpv, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &fps);
+		metrics_printf(&o, "pickle_mpv_estimated_fps{video=\"%d\"} %.3f\n", i, fps);
+	}
+	metrics_printf(&o, "# HELP pickle_mpv_demuxer_cache_seconds Media buffered ahead of playback.\n# TYPE pickle_mpv_demuxer_cache_seconds gauge\n");
+	for (int i = 0; i < num_players; i++) {
+		double ahead = 0.0;
+		if (!players[i].mpv) continue;
+		mpv_get_property(players[i].mpv, "demuxer-cache-duration", MPV_FORMAT_DOUBLE, &ahead);
+		metrics_printf(&o, "pickle_mpv_demuxer_cache_seconds{video=\"%d\"} %.3f\n", i, ahead);
+	}
+	metrics_printf(&o, "# HELP pickle_offscreen_bytes GPU memory held by offscreen render targets.\n# TYPE pickle_offscreen_bytes gauge\n");
+	metrics_printf(&o, "pickle_offscreen_bytes %llu\n", (unsigned long long)atomic_load(&g_mem_fbo_bytes));
+	metrics_printf(&o, "# HELP pickle_cache_underruns_total Times the demuxer ran dry or playback paused for cache.\n# TYPE pickle_cache_underruns_total counter\n");
+	for (int i = 0; i < num_players; i++) {
+		if (!players[i].mpv || !players[i].cache) continue;
+		metrics_printf(&o, "pickle_cache_underruns_total{video=\"%d\",profile=\"%s\"} %llu\n", i, players[i].cache->name,
+			(unsigned long long)players[i].cache_underruns);
+	}
+	metrics_printf(&o, "# HELP pickle_cache_readahead_seconds Demuxer readahead currently applied.\n# TYPE pickle_cache_readahead_seconds gauge\n");
+	for (int i = 0; i < num_players; i++) {
+		if (!players[i].mpv || !players[i].cache) continue;
+		metrics_printf(&o, "pickle_cache_readahead_seconds{video=\"%d\",profile=\"%s\"} %.1f\n", i, players[i].cache->name,
+			players[i].cache_readahead);
+	}
+	if (g_prof_enabled) {
+		// Profiler histograms, re-bucketed at powers of two (8 us .. ~8 s)
+		metrics_printf(&o, "# HELP pickle_stage_seconds Per-stage frame time.\n# TYPE pickle_stage_seconds histogram\n");
+		for (int st = 0; st < PROF_STAGES; st++) {
+			uint64_t cum = 0;
+			int idx = 0;
+			for (int k = 3; k <= 23; k++) {
+				for (; idx < (k - 2) * PROF_SUB; idx++) cum += atomic_load_explicit(&g_prof_hist[st].bucket[idx], memory_order_relaxed);
+				metrics_printf(&o, "pickle_stage_seconds_bucket{stage=\"%s\",le=\"%g\"} %llu\n",
+					g_prof_names[st], (double)((int64_t)1 << k) / 1e6, (unsigned long long)cum);
+			}
+			for (; idx < PROF_BUCKETS; idx++) cum += atomic_load_explicit(&g_prof_hist[st].bucket[idx], memory_order_relaxed);
+			metrics_printf(&o, "pickle_stage_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n", g_prof_names[st], (unsigned long long)cum);
+			metrics_printf(&o, "pickle_stage_seconds_sum{stage=\"%s\"} %.6f\n", g_prof_names[st],
+				(double)atomic_load_explicit(&g_prof_hist[st].sum_us, memory_order_relaxed) / 1e6);
+			metrics_printf(&o, "pickle_stage_seconds_count{stage=\"%s\"} %llu\n", g_prof_names[st], (unsigned long long)cum);
+		}
+	}
+	return o.len;
+}
+
+// Answer one client and close it; an HTTP GET gets an HTTP/1.0 response around the payload
+static void metrics_reply(int slot, bool http, mpv_player_t *players, int num_players) {
+	int fd = g_metrics.client_fd[slot];
+	size_t len = metrics_format(players, num_players);
+	if (http) {
+		char hdr[160];
+		int hl = snprintf(hdr, sizeof(hdr), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+			"Content-Length: %zu\r\nConnection: close\r\n\r\n", len);
+		if (hl > 0) (void)send(fd, hdr, (size_t)hl, MSG_NOSIGNAL);
+	}
+	// The payload fits the socket buffer; a client that will not take it is simply cut off
+	if (send(fd, g_metrics_buf, len, MSG_NOSIGNAL) < (ssize_t)len) LOG_DEBUG("Metrics client %d: short write", fd);
+	shutdown(fd, SHUT_WR);
+	close(fd);
+	g_metrics.client_fd[slot] = -1;
+}
+
+// Add the listening socket and pending clients to a poll set; returns the count added
+static int metrics_poll_fds(struct pollfd *pfds) {
+	int n = 0;
+	if (g_metrics.listen_fd < 0) return 0;
+	pfds[n].fd = g_metrics.listen_fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++;
+	for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+		if (g_metrics.client_fd[i] < 0) continue;
+		pfds[n].fd = g_metrics.client_fd[i]; pfds[n].events = POLLIN; pfds[n].revents = 0; n++;
+	}
+	return n;
+}
+
+/**
+ * Accept scrapes and answer clients that sent a request or stayed idle (control thread)
+ *
+ * @param pfds Poll set after poll() returned
+ * @param n Entries in pfds
+ */
+static void metrics_service(const struct pollfd *pfds, int n, mpv_player_t *players, int num_players) {
+	if (g_metrics.listen_fd < 0) return;
+	int64_t now = mono_now_us();
+	for (int i = 0; i < n; i++) {
+		if (!pfds[i].revents) continue;
+		if (pfds[i].fd == g_metrics.listen_fd) {
+			int c;
+			while ((c = accept4(g_metrics.listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+				int slot = -1;
+				for (int k = 0; k < METRICS_MAX_CLIENTS && slot < 0; k++) if (g_metrics.client_fd[k] < 0) slot = k;
+				if (slot < 0) { close(c); continue; } // busy; the scraper retries
+				g_metrics.client_fd[slot] = c;
+				g_metrics.client_since_us[slot] = now;
+			}
+			continue;
+		}
+		for (int k = 0; k < METRICS_MAX_CLIENTS; k++) {
+			if (g_metrics.client_fd[k] != pfds[i].fd) continue;
+			char req[1024];
+			ssize_t r = read(pfds[i].fd, req, sizeof(req));
+			if (r <= 0 && !(r < 0 && errno == EAGAIN)) {
+				close(pfds[i].fd); // went away before asking
+				g_metrics.client_fd[k] = -1;
+			} else if (r > 0) {
+				metrics_reply(k, r >= 4 && memcmp(req, "GET ", 4) == 0, players, num_players);
+			}
+		}
+	}
+	for (int k = 0; k < METRICS_MAX_CLIENTS; k++) {
+		if (g_metrics.client_fd[k] >= 0 && now - g_metrics.client_since_us[k] > METRICS_IDLE_MS * 1000)
+			metrics_reply(k, false, players, num_players);
+	}
+}
+
+// Display a help overlay using mpv's built-in OSD
+static void show_help_overlay(mpv_handle *mpv) {
+	if (!mpv) return;
+	const char *text =
+		"Pickle controls:\n"
+		"  q: quit    h: help overlay\n"
+		"  k: toggle keystone    1-4: select corner\n"
+		"  v then 1-9: select video (multi-video)\n"
+		"  arrows / WASD: move point\n"
+		"  +/-: step    r: reset\n"
+		"  b: toggle border    [ / ]: border width\n"
+	"  c: toggle corner markers\n"
+		"  o: flip X (mirror)  p: flip Y (invert)\n"
+		"  m: mesh mode (experimental)\n"
+		"  S: save keystone\n"
+		"\nGamepad:\n"
+		"  START: toggle keystone\n"
+		"  Cycle button (default X): corners TL -> TR -> BR -> BL\n"
+		"  Help button (default B): toggle this help\n"
+		"  D-Pad/Left stick: move point\n"
+		"  L1/R1: step -/+    SELECT: reset    Y/Home(Guide): toggle border\n"
+		"  START+SELECT (hold 2s): quit\n";
+	// Reduce font size and move OSD to top-left with small margins so it fits better
+	if (!g_osd_saved.saved) {
+		int64_t v=0; char *s=NULL;
+		if (mpv_get_property(mpv, "osd-font-size", MPV_FORMAT_INT64, &v) >= 0) g_osd_saved.font_size = v; else g_osd_saved.font_size = 36;
+		if (mpv_get_property(mpv, "osd-margin-x", MPV_FORMAT_INT64, &v) >= 0) g_osd_saved.margin_x = v; else g_osd_saved.margin_x = 10;
+		if (mpv_get_property(mpv, "osd-margin-y", MPV_FORMAT_INT64, &v) >= 0) g_osd_saved.margin_y = v; else g_osd_saved.margin_y = 10;
+		if (mpv_get_property(mpv, "osd-align-x", MPV_FORMAT_STRING, &s) >= 0 && s) {
+			strncpy(g_osd_saved.align_x, s, sizeof(g_osd_saved.align_x)-1);
+			g_osd_saved.align_x[sizeof(g_osd_saved.align_x)-1]='\0';
+			mpv_free(s);
+		} else strcpy(g_osd_saved.align_x, "center");
+		s = NULL;
 		if (mpv_get_property(mpv, "osd-align-y", MPV_FORMAT_STRING, &s) >= 0 && s) {
 			strncpy(g_osd_saved.align_y, s, sizeof(g_osd_saved.align_y)-1);
 			g_osd_saved.align_y[sizeof(g_osd_saved.align_y)-1]='\0';
@@ -1083,13 +2722,155 @@ static void log_opt_result(const char *opt, int code) {
 	if (code < 0) fprintf(stderr, "[mpv] option %s failed (%d)\n", opt, code);
 }
 
-static bool init_mpv(mpv_player_t *p, const char *file) {
-	memset(p,0,sizeof(*p));
-	const char *no_mpv = getenv("PICKLE_NO_MPV");
-	if (no_mpv && *no_mpv) {
-		fprintf(stderr, "[mpv] Skipping mpv initialization (PICKLE_NO_MPV set)\n");
-		return true;
+#define CACHE_FOLLOWER_MAX_BYTES (16 * CACHE_MIB) // Dual-split follower limits
+#define CACHE_FOLLOWER_READAHEAD 2.0
+
+// Profile forced by PICKLE_CACHE_PROFILE (NULL = auto)
+static const cache_profile_t *cache_profile_forced(void) {
+	const char *env = getenv("PICKLE_CACHE_PROFILE");
+	if (!env || !*env || !strcmp(env, "auto")) return NULL;
+	for (int i = 0; i < CACHE_PROFILES; i++)
+		if (!strcmp(env, g_cache_profiles[i].name)) return &g_cache_profiles[i];
+	static int warned = 0;
+	if (!warned) { LOG_WARN("Unknown PICKLE_CACHE_PROFILE=%s (local, vod, live or auto)", env); warned = 1; }
+	return NULL;
+}
+
+/**
+ * Starting cache profile for a source: PICKLE_CACHE_PROFILE when set, otherwise from
+ * the URL. Plain paths, file:// and lavfi sources are local; rtsp/rtmp/udp/srt are
+ * treated as live; other URLs (http, https, HLS playlists, ...) as VOD until
+ * cache_profile_refine() has seen the loaded stream.
+ *
+ * @param file Path or URL as passed to loadfile
+ */
+static const cache_profile_t *cache_profile_for(const char *file) {
+	const cache_profile_t *forced = cache_profile_forced();
+	if (forced) return forced;
+	const char *sep = file ? strstr(file, "://") : NULL;
+	if (!sep || !strncmp(file, "file://", 7) || !strncmp(file, "av:", 3)) return &g_cache_profiles[0];
+	static const char *live_schemes[] = { "rtsp", "rtsps", "rtmp", "rtmps", "rtp", "udp", "srt", "mms", "tcp" };
+	size_t slen = (size_t)(sep - file);
+	for (size_t i = 0; i < sizeof(live_schemes) / sizeof(live_schemes[0]); i++)
+		if (strlen(live_schemes[i]) == slen && !strncasecmp(file, live_schemes[i], slen)) return &g_cache_profiles[2];
+	return &g_cache_profiles[1];
+}
+
+/**
+ * Bounds of a cache profile for the current memory mode. Low-memory mode halves the
+ * byte limits and, where readahead tracks the bitrate (adaptive profiles), the
+ * readahead range with them, so a full cache still holds the readahead it was sized for.
+ *
+ * @param cp Profile
+ * @return Profile copy with the bounds applied
+ */
+static cache_profile_t cache_bounds(const cache_profile_t *cp) {
+	cache_profile_t b = *cp;
+	if (!g_low_mem) return b;
+	b.max_bytes_min /= 2;
+	b.max_bytes_max /= 2;
+	b.back_bytes_max /= 2;
+	if (b.adapt) {
+		b.readahead_min /= 2.0;
+		b.readahead_max /= 2.0;
+		b.back_secs /= 2.0;
+	}
+	return b;
+}
+
+/**
+ * Apply cache limits to a core (runtime properties, any time after mpv_initialize)
+ *
+ * @param p Player with a profile chosen
+ * @param readahead Seconds to buffer ahead (follower limits applied here)
+ * @param max_bytes demuxer-max-bytes (within cache_bounds())
+ * @param back_bytes demuxer-max-back-bytes
+ */
+static void cache_set(mpv_player_t *p, double readahead, int64_t max_bytes, int64_t back_bytes) {
+	if (p->cache_follower) {
+		if (readahead > CACHE_FOLLOWER_READAHEAD) readahead = CACHE_FOLLOWER_READAHEAD;
+		if (max_bytes > CACHE_FOLLOWER_MAX_BYTES) max_bytes = CACHE_FOLLOWER_MAX_BYTES;
+		back_bytes = 0;
 	}
+	char v[32];
+	int r;
+	if (readahead != p->cache_readahead) {
+		snprintf(v, sizeof(v), "%.1f", readahead);
+		// cache-secs governs when the stream cache is on, demuxer-readahead-secs otherwise
+		r = mpv_set_property_string(p->mpv, "cache-secs", v); log_opt_result("cache-secs", r);
+		r = mpv_set_property_string(p->mpv, "demuxer-readahead-secs", v); log_opt_result("demuxer-readahead-secs", r);
+		p->cache_readahead = readahead;
+	}
+	if (max_bytes != p->cache_max_bytes) {
+		snprintf(v, sizeof(v), "%lld", (long long)max_bytes);
+		r = mpv_set_property_string(p->mpv, "demuxer-max-bytes", v); log_opt_result("demuxer-max-bytes", r);
+		p->cache_max_bytes = max_bytes;
+	}
+	if (back_bytes != p->cache_back_bytes) {
+		snprintf(v, sizeof(v), "%lld", (long long)back_bytes);
+		r = mpv_set_property_string(p->mpv, "demuxer-max-back-bytes", v); log_opt_result("demuxer-max-back-bytes", r);
+		p->cache_back_bytes = back_bytes;
+	}
+}
+
+/**
+ * Choose the cache profile for the file about to be loaded and apply its starting
+ * limits. Called before every loadfile; measurements start over for the new source.
+ *
+ * @param p Player (core initialized)
+ * @param file Path or URL
+ */
+static void cache_profile_apply(mpv_player_t *p, const char *file) {
+	if (!p || !p->mpv) return;
+	const cache_profile_t *cp = cache_profile_for(file);
+	int r = mpv_set_property_string(p->mpv, "cache", cp->cache ? "yes" : "no");
+	log_opt_result("cache", r);
+	p->cache = cp;
+	p->cache_readahead = -1.0; // force every property out
+	p->cache_max_bytes = p->cache_back_bytes = -1;
+	p->cache_headroom = p->cache_fill_s = p->cache_in_rate = 0.0;
+	p->cache_fill_bytes = 0;
+	p->cache_underrun = p->cache_calm = 0;
+	cache_profile_t b = cache_bounds(cp);
+	cache_set(p, b.readahead_min, b.max_bytes_min, b.back_bytes_max / 4);
+	LOG_INFO("Cache profile %s%s: %.1f s ahead, %lld MiB, %lld MiB back (%s)", cp->name,
+		p->cache_follower ? " (follower)" : "", p->cache_readahead, (long long)(p->cache_max_bytes / CACHE_MIB),
+		(long long)(p->cache_back_bytes / CACHE_MIB), file);
+}
+
+/**
+ * Settle a network source on vod or live once it has loaded (MPV_EVENT_FILE_LOADED):
+ * live when the stream is not seekable or has no known duration, vod otherwise. The URL
+ * alone cannot tell an HLS VOD clip from a live playlist. A forced profile is kept.
+ *
+ * @param p Player whose file just loaded
+ */
+static void cache_profile_refine(mpv_player_t *p) {
+	if (!p || !p->mpv || !p->cache || !p->cache->cache || cache_profile_forced()) return;
+	int seekable = 0;
+	double duration = 0.0;
+	mpv_get_property(p->mpv, "seekable", MPV_FORMAT_FLAG, &seekable);
+	bool live = !seekable || mpv_get_property(p->mpv, "duration", MPV_FORMAT_DOUBLE, &duration) < 0 || duration <= 0.0;
+	const cache_profile_t *cp = &g_cache_profiles[live ? 2 : 1];
+	if (cp == p->cache) return;
+	LOG_INFO("Cache profile %s -> %s (%s, duration %s)", p->cache->name, cp->name,
+		seekable ? "seekable" : "not seekable", duration > 0.0 ? "known" : "unknown");
+	p->cache = cp;
+	p->cache_headroom = 0.0;
+	p->cache_calm = 0;
+	cache_profile_t b = cache_bounds(cp);
+	cache_set(p, b.readahead_min, b.max_bytes_min, b.back_bytes_max / 4);
+}
+
+/**
+ * Create and configure an mpv core (options, mpv_initialize); any thread.
+ * The render context is attached separately by init_mpv_render().
+ *
+ * @param p Player to initialize (cleared first)
+ * @return true on success
+ */
+static bool init_mpv_handle(mpv_player_t *p) {
+	memset(p,0,sizeof(*p));
 	p->mpv = mpv_create();
 	if (!p->mpv) { fprintf(stderr, "mpv_create failed\n"); return false; }
 	const char *want_debug = getenv("PICKLE_LOG_MPV");
@@ -1115,16 +2896,15 @@ static bool init_mpv(mpv_player_t *p, const char *file) {
 	}
 	const char *vo_used = vo_req;
 	
-	// Hardware decoding: drm-copy is most stable for RPi4 with vo=libmpv
-	// Uses V4L2 hardware decoder with efficient GPU upload
-	const char *hwdec_pref = getenv("PICKLE_HWDEC");
-	if (!hwdec_pref || !*hwdec_pref) hwdec_pref = "drm-copy";
-	r = mpv_set_option_string(p->mpv, "hwdec", hwdec_pref); 
-	log_opt_result("hwdec", r);
 	
 	// Specify V4L2 codec preference for RPi4 (uses hardware H.264/HEVC decoder)
 	r = mpv_set_option_string(p->mpv, "hwdec-codecs", "h264,hevc,mpeg2video,mpeg4,vp8,vp9");
 	log_opt_result("hwdec-codecs", r);
+	// Low-memory mode: fewer preallocated decoder surfaces (CMA on the Pi)
+	if (g_low_mem) {
+		r = mpv_set_option_string(p->mpv, "hwdec-extra-frames", LOW_MEM_HWDEC_EXTRA_FRAMES);
+		log_opt_result("hwdec-extra-frames", r);
+	}
 	
 	r = mpv_set_option_string(p->mpv, "opengl-es", "yes"); log_opt_result("opengl-es=yes", r);
 	
@@ -1158,13 +2938,12 @@ static bool init_mpv(mpv_player_t *p, const char *file) {
 		r = mpv_set_option_string(p->mpv, "loop-playlist", "inf");
 		log_opt_result("loop-playlist", r);
 	}
-	// Increase demuxer cache for smoother playback
-	r = mpv_set_option_string(p->mpv, "demuxer-max-bytes", "64MiB");
-	log_opt_result("demuxer-max-bytes", r);
-	
-	// Optimize for smoother playback over perfect A/V sync
-	r = mpv_set_option_string(p->mpv, "cache-secs", "10");
-	log_opt_result("cache-secs", r);
+	// Benchmark: present every frame as soon as it is decoded
+	if (g_bench_scenario >= 0) {
+		r = mpv_set_option_string(p->mpv, "untimed", "yes");
+		log_opt_result("untimed", r);
+	}
+	// Demuxer cache sizes depend on the source: set per file by cache_profile_apply()
 	
 	// Set a larger audio buffer for smoother audio output
 	r = mpv_set_option_string(p->mpv, "audio-buffer", "0.2");  // 200ms audio buffer
@@ -1181,18 +2960,13 @@ static bool init_mpv(mpv_player_t *p, const char *file) {
 	r = mpv_set_option_string(p->mpv, "dither-depth", "no");
 	log_opt_result("dither-depth=no", r);
 	
-	// Reduce latency for initial frame display
-	r = mpv_set_option_string(p->mpv, "demuxer-readahead-secs", "1.0");
-	log_opt_result("demuxer-readahead-secs", r);
-	
 	// Prefer using MPV_RENDER_PARAM_FLIP_Y during rendering instead of global rotation
 
 	// vo=libmpv doesn't need gpu-context configuration
 
-	int use_adv = 0;
 	const char *adv_env = getenv("PICKLE_GL_ADV");
-	if (adv_env && *adv_env && strcmp(vo_used, "gpu") == 0) use_adv = 1;
-	fprintf(stderr, "[mpv] Advanced control %s (PICKLE_GL_ADV=%s vo=%s)\n", use_adv?"ENABLED":"disabled", adv_env?adv_env:"unset", vo_used);
+	if (adv_env && *adv_env && strcmp(vo_used, "gpu") == 0) p->use_adv = 1;
+	fprintf(stderr, "[mpv] Advanced control %s (PICKLE_GL_ADV=%s vo=%s)\n", p->use_adv?"ENABLED":"disabled", adv_env?adv_env:"unset", vo_used);
 
 	// Audio is disabled by default for video-only playback (eliminates A/V desync warnings)
 	// Set PICKLE_FORCE_AUDIO=1 to enable audio output
@@ -1202,26 +2976,181 @@ static bool init_mpv(mpv_player_t *p, const char *file) {
 		disable_audio = 0; 
 	}
 	if (disable_audio) mpv_set_option_string(p->mpv, "audio", "no");
+	// Playlist: hold the last frame at the end of an item until the next one takes over
+	if (g_pl.count) {
+		r = mpv_set_option_string(p->mpv, "keep-open", "yes");
+		log_opt_result("keep-open=yes", r);
+	}
 	if (mpv_initialize(p->mpv) < 0) { fprintf(stderr, "mpv_initialize failed\n"); return false; }
+	if (g_pl.count) mpv_observe_property(p->mpv, 0, "eof-reached", MPV_FORMAT_FLAG);
+	mpv_set_wakeup_callback(p->mpv, mpv_wakeup_cb, NULL);
+	fprintf(stderr, "[mpv] Core initialized (vo=%s)\n", vo_used);
+	return true;
+}
 
+/**
+ * Pick and set the hwdec mode. Depends on the display (EGL dma-buf import, KMS handles,
+ * plane mode), so it runs when the render context is created, not with the core.
+ *
+ * @param p Player set up by init_mpv_handle()
+ */
+static void mpv_apply_hwdec(mpv_player_t *p) {
+	int r;
+	// Hardware decoding: prefer zero-copy DRM-PRIME (decoder DMA-BUFs imported as
+	// EGLImages and sampled directly) when EGL supports dma-buf import; otherwise
+	// drm-copy, which copies each frame into a GL texture.
+	// PICKLE_ZERO_COPY=0 forces the copy path; PICKLE_HWDEC overrides both.
+	const char *hwdec_pref = getenv("PICKLE_HWDEC");
+	const char *zc_env = getenv("PICKLE_ZERO_COPY");
+	int zero_copy_allowed = !(zc_env && *zc_env && strcmp(zc_env, "0") == 0);
+	if (g_video_plane) {
+		// Plane scanout needs DRM-PRIME frames handed straight to KMS
+		hwdec_pref = "drm";
+		p->zero_copy = 1;
+		r = mpv_set_option_string(p->mpv, "gpu-hwdec-interop", "drmprime-overlay"); log_opt_result("gpu-hwdec-interop=drmprime-overlay", r);
+		r = mpv_set_option_string(p->mpv, "drm-draw-plane", "primary"); log_opt_result("drm-draw-plane=primary", r);
+		r = mpv_set_option_string(p->mpv, "drm-drmprime-video-plane", "overlay"); log_opt_result("drm-drmprime-video-plane=overlay", r);
+	} else if (!hwdec_pref || !*hwdec_pref) {
+		if (zero_copy_allowed && g_egl_dmabuf_import && g_kms_for_mpv) {
+			hwdec_pref = "drm";
+			p->zero_copy = 1;
+		} else {
+			hwdec_pref = "drm-copy";
+		}
+	} else if (!strcmp(hwdec_pref, "drm") || !strcmp(hwdec_pref, "drm-prime") || !strcmp(hwdec_pref, "v4l2m2m")) {
+		p->zero_copy = g_kms_for_mpv ? 1 : 0;
+	}
+	r = mpv_set_option_string(p->mpv, "hwdec", hwdec_pref);
+	log_opt_result("hwdec", r);
+	if (r < 0 && p->zero_copy) {
+		p->zero_copy = 0;
+		hwdec_pref = "drm-copy";
+		r = mpv_set_option_string(p->mpv, "hwdec", hwdec_pref);
+		log_opt_result("hwdec=drm-copy", r);
+	}
+	fprintf(stderr, "[mpv] hwdec=%s (%s)\n", hwdec_pref, p->zero_copy ? "zero-copy requested" : "copy");
+}
+
+/**
+ * Create the mpv render context; needs the EGL context current on the calling thread.
+ *
+ * @param p Player set up by init_mpv_handle()
+ * @return true on success
+ */
+static bool init_mpv_render(mpv_player_t *p) {
+	mpv_apply_hwdec(p);
 	mpv_opengl_init_params gl_init = { .get_proc_address = mpv_get_proc_address, .get_proc_address_ctx = NULL };
-	mpv_render_param params[4]; memset(params,0,sizeof(params)); int pi=0;
+	// DRM handles let mpv's drmprime interop import decoder DMA-BUFs as EGLImages
+	mpv_opengl_drm_params_v2 drm_params = { .fd = -1, .render_fd = -1 };
+	if (p->zero_copy && g_kms_for_mpv) {
+		drm_params.fd = g_kms_for_mpv->fd;
+		drm_params.crtc_id = (int)g_kms_for_mpv->crtc_id;
+		drm_params.connector_id = (int)g_kms_for_mpv->connector_id;
+		// In plane mode mpv adds the video plane to our next atomic commit
+		drm_params.atomic_request_ptr = g_video_plane ? &g_atomic_req : NULL;
+	}
+	mpv_render_param params[5]; memset(params,0,sizeof(params)); int pi=0;
 	params[pi].type = MPV_RENDER_PARAM_API_TYPE; params[pi++].data = (void*)MPV_RENDER_API_TYPE_OPENGL;
 	params[pi].type = MPV_RENDER_PARAM_OPENGL_INIT_PARAMS; params[pi++].data = &gl_init;
-	if (use_adv) { params[pi].type = MPV_RENDER_PARAM_ADVANCED_CONTROL; params[pi++].data = (void*)1; }
+	if (p->use_adv) { params[pi].type = MPV_RENDER_PARAM_ADVANCED_CONTROL; params[pi++].data = (void*)1; }
+	if (drm_params.fd >= 0) { params[pi].type = MPV_RENDER_PARAM_DRM_DISPLAY_V2; params[pi++].data = &drm_params; }
 	params[pi].type = 0;
-	fprintf(stderr, "[mpv] Creating render context (advanced_control=%d vo=%s) ...\n", use_adv, vo_used);
+	fprintf(stderr, "[mpv] Creating render context (advanced_control=%d drm_interop=%d) ...\n", p->use_adv, drm_params.fd >= 0);
 	int cr = mpv_render_context_create(&p->rctx, p->mpv, params);
+	if (cr < 0 && drm_params.fd >= 0) {
+		// Older libmpv without DRM_DISPLAY_V2 support: retry plain GL and use the copy path
+		fprintf(stderr, "[mpv] render context with DRM interop failed (%d); retrying with drm-copy\n", cr);
+		params[pi-1].type = 0; params[pi-1].data = NULL;
+		p->zero_copy = 0;
+		g_video_plane = g_video_plane_wanted = 0;
+		mpv_set_property_string(p->mpv, "hwdec", "drm-copy");
+		cr = mpv_render_context_create(&p->rctx, p->mpv, params);
+	}
 	if (cr < 0) { fprintf(stderr, "mpv_render_context_create failed (%d)\n", cr); return false; }
+	p->plane_interop = g_video_plane;
 	fprintf(stderr, "[mpv] Render context OK\n");
 	mpv_render_context_set_update_callback(p->rctx, on_mpv_events, NULL);
-	mpv_set_wakeup_callback(p->mpv, mpv_wakeup_cb, NULL);
+	return true;
+}
+
+/**
+ * Initialize mpv with its render context and start playing a file (EGL context current)
+ *
+ * @param p Player to initialize
+ * @param file File or URL to load
+ * @return true on success
+ */
+static bool init_mpv(mpv_player_t *p, const char *file) {
+	const char *no_mpv = getenv("PICKLE_NO_MPV");
+	if (no_mpv && *no_mpv) {
+		memset(p,0,sizeof(*p));
+		fprintf(stderr, "[mpv] Skipping mpv initialization (PICKLE_NO_MPV set)\n");
+		return true;
+	}
+	// The core may already have been brought up by the startup worker (mpv_boot_main)
+	if ((!p->mpv && !init_mpv_handle(p)) || !init_mpv_render(p)) return false;
+	cache_profile_apply(p, file);
 	const char *cmd[] = {"loadfile", file, NULL};
 	if (mpv_command(p->mpv, cmd) < 0) { fprintf(stderr, "Failed to load file %s\n", file); return false; }
-	fprintf(stderr, "[mpv] Initialized successfully (vo=%s)\n", vo_used);
+	fprintf(stderr, "[mpv] Initialized successfully\n");
 	return true;
 }
 
+// --- Startup worker: mpv cores come up while KMS/EGL initialize on the main thread ---
+#define BOOT_PREFETCH_BYTES (8 << 20) // Start of each local file pulled into the page cache
+typedef struct {
+	mpv_player_t *players;
+	const char **files;
+	int count;
+	int ok;
+} mpv_boot_ctx_t;
+
+/**
+ * Start kernel readahead of a local file's first bytes, so the demuxer's probe reads
+ * hit the page cache once the file is loaded. URLs and lavfi sources are left alone.
+ *
+ * @param file Path as given on the command line
+ */
+static void boot_prefetch_file(const char *file) {
+	if (!file || strstr(file, "://") || !strncmp(file, "av:", 3)) return;
+	int fd = open(file, O_RDONLY);
+	if (fd < 0) return; // mpv reports the error on loadfile
+	posix_fadvise(fd, 0, BOOT_PREFETCH_BYTES, POSIX_FADV_WILLNEED);
+	close(fd);
+}
+
+static void *mpv_boot_main(void *arg) {
+	mpv_boot_ctx_t *b = (mpv_boot_ctx_t *)arg;
+	b->ok = 1;
+	for (int i = 0; i < b->count; i++) {
+		boot_prefetch_file(b->files[i]);
+		if (!init_mpv_handle(&b->players[i])) {
+			fprintf(stderr, "[boot] mpv core for video %d failed\n", i + 1);
+			b->ok = 0;
+			break;
+		}
+	}
+	g_boot.core_us = mono_now_us();
+	return NULL;
+}
+
+/**
+ * Log the startup phases once the first video frame is on screen (control thread)
+ */
+static void boot_log_phases(void) {
+	int64_t shown = atomic_load(&g_boot.shown_us);
+	if (g_boot.logged || !shown) return;
+	g_boot.logged = 1;
+	int64_t t0 = g_boot.start_us;
+	char core[48] = "";
+	if (g_boot.core_us) snprintf(core, sizeof(core), ", mpv core ready %.1f", (double)(g_boot.core_us - t0) / 1000.0);
+	LOG_INFO("Startup: %.2f s after boot; ms from start: drm %.1f, egl %.1f, fb ring %.1f%s, files loading %.1f, "
+		"first frame decoded %.1f, on screen %.1f",
+		(double)t0 / 1e6, (double)(g_boot.drm_us - t0) / 1000.0, (double)(g_boot.egl_us - t0) / 1000.0,
+		(double)(g_boot.ring_us - t0) / 1000.0, core, (double)(g_boot.mpv_us - t0) / 1000.0,
+		(double)(atomic_load(&g_boot.decoded_us) - t0) / 1000.0, (double)(shown - t0) / 1000.0);
+}
+
 /**
  * Clean up MPV resources
  * 
@@ -1241,6 +3170,182 @@ static void destroy_mpv(mpv_player_t *p) {
 	}
 }
 
+/**
+ * Read a playlist file: one file or URL per line; blank lines and '#' comments ignored
+ *
+ * @param path Playlist file
+ * @return true if at least one item was read
+ */
+static bool playlist_load(const char *path) {
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		LOG_ERROR("Cannot open playlist %s: %s", path, strerror(errno));
+		return false;
+	}
+	char line[1024];
+	while (fgets(line, sizeof(line), f) && g_pl.count < PLAYLIST_MAX) {
+		char *it = line;
+		while (*it == ' ' || *it == '\t') it++;
+		size_t len = strcspn(it, "\r\n");
+		while (len > 0 && (it[len - 1] == ' ' || it[len - 1] == '\t')) len--;
+		it[len] = '\0';
+		if (!len || *it == '#') continue;
+		g_pl.items[g_pl.count] = strdup(it);
+		if (g_pl.items[g_pl.count]) g_pl.count++;
+	}
+	if (!feof(f)) LOG_WARN("Playlist %s: only the first %d items are used", path, PLAYLIST_MAX);
+	fclose(f);
+	if (!g_pl.count) LOG_ERROR("Playlist %s has no items", path);
+	return g_pl.count > 0;
+}
+
+static void playlist_free(void) {
+	for (int i = 0; i < g_pl.count; i++) free(g_pl.items[i]);
+	g_pl.count = 0;
+}
+
+// Item after 'item', or -1 at the end of a non-looping playlist
+static int playlist_after(int item) {
+	if (item + 1 < g_pl.count) return item + 1;
+	return g_pl.loop ? 0 : -1;
+}
+
+/**
+ * Playlist bookkeeping for one mpv event (control thread)
+ *
+ * @param p Player the event came from
+ * @param ev The event
+ * @return true if the event was consumed (END_FILE is handled here in playlist mode)
+ */
+static bool playlist_on_event(mpv_player_t *p, mpv_event *ev) {
+	bool current = (p == g_pl.slot[g_pl.cur]);
+	switch (ev->event_id) {
+	case MPV_EVENT_PROPERTY_CHANGE: {
+		mpv_event_property *prop = ev->data;
+		if (current && prop->format == MPV_FORMAT_FLAG && !strcmp(prop->name, "eof-reached") && *(int *)prop->data)
+			g_pl.eof = 1;
+		return false;
+	}
+	case MPV_EVENT_PLAYBACK_RESTART:
+		// Standby has decoded its first frame and sits paused on it
+		if (!current && g_pl.state == PL_PREROLL) {
+			g_pl.state = PL_READY;
+			LOG_INFO("Playlist: item %d/%d pre-rolled (%s)", g_pl.standby_item + 1, g_pl.count, g_pl.items[g_pl.standby_item]);
+		}
+		return false;
+	case MPV_EVENT_END_FILE: {
+		const mpv_event_end_file *ef = ev->data;
+		if (current) {
+			g_pl.eof = 1; // failed or ended without keep-open: move on like at EOF
+		} else if (g_pl.state == PL_PREROLL || g_pl.state == PL_READY) {
+			LOG_WARN("Playlist: item %d (%s) failed to load (%s), skipping", g_pl.standby_item + 1,
+				g_pl.items[g_pl.standby_item], mpv_end_reason_str(ef->reason));
+			g_pl.state = PL_DROP;
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+/**
+ * Advance the playlist (control thread, every loop iteration): prepare the standby
+ * player, swap it in once the current item holds its last frame, retire the old one.
+ */
+static void playlist_step(void) {
+	if (!g_pl.count) return;
+	int sb = 1 - g_pl.cur;
+	mpv_player_t *standby = g_pl.slot[sb];
+	g_pl.poll_ms = 0;
+	switch (g_pl.state) {
+	case PL_IDLE:
+		if (g_pl.next < 0 || g_pl.fails >= g_pl.count) {
+			if (g_pl.eof) g_stop = 1; // nothing left to play
+			return;
+		}
+		g_pl.standby_item = g_pl.next;
+		if (!init_mpv_handle(standby)) {
+			g_pl.state = PL_DROP;
+			return;
+		}
+		atomic_store(&g_pl_attached, 0);
+		render_cmd_push(RCMD_PLAYER_ATTACH, sb);
+		g_pl.state = PL_ATTACHING;
+		return;
+	case PL_ATTACHING: {
+		int a = atomic_load(&g_pl_attached);
+		if (!a) return;
+		if (a < 0) { g_pl.state = PL_DROP; return; }
+		// Pre-roll paused: decode and upload the first frame, then wait for the swap
+		mpv_set_property_string(standby->mpv, "pause", "yes");
+		cache_profile_apply(standby, g_pl.items[g_pl.standby_item]);
+		const char *cmd[] = {"loadfile", g_pl.items[g_pl.standby_item], NULL};
+		if (mpv_command(standby->mpv, cmd) < 0) { g_pl.state = PL_DROP; return; }
+		g_pl.state = PL_PREROLL;
+		return;
+	}
+	case PL_PREROLL:
+		return;
+	case PL_READY: {
+		// Swap once the current item is on its last frame; waiting for eof-reached would
+		// hold that frame for at least one more vblank
+		if (!g_pl.eof) {
+			mpv_player_t *cur = g_pl.slot[g_pl.cur];
+			double left = -1.0, fps = 0.0;
+			if (mpv_get_property(cur->mpv, "playtime-remaining", MPV_FORMAT_DOUBLE, &left) < 0) return;
+			if (mpv_get_property(cur->mpv, "estimated-vf-fps", MPV_FORMAT_DOUBLE, &fps) < 0 || fps <= 0.0)
+				mpv_get_property(cur->mpv, "container-fps", MPV_FORMAT_DOUBLE, &fps);
+			double frame = fps > 0.0 ? 1.0 / fps : 1.0 / 30.0;
+			if (left > frame) {
+				// Wake up in time for the last frame
+				double ms = (left - frame) * 1000.0;
+				g_pl.poll_ms = ms < 1.0 ? 1 : ms > 100.0 ? 100 : (int)ms;
+				return;
+			}
+		}
+		// The standby's first frame replaces the last one on the next vblank
+		mpv_set_property_string(standby->mpv, "pause", "no");
+		atomic_store_explicit(&g_pl_swapped, 0, memory_order_relaxed);
+		render_cmd_push(RCMD_PLAYER_SWAP, sb);
+		g_pl.state = PL_SWAPPING;
+		return;
+	}
+	case PL_SWAPPING: {
+		// Acquire pairs with the render thread's release after it switched g_videos[0].player
+		if (!atomic_load_explicit(&g_pl_swapped, memory_order_acquire)) return;
+		destroy_mpv(g_pl.slot[g_pl.cur]); // render context already freed by the render thread
+		g_pl.cur = sb;
+		g_pl.index = g_pl.standby_item;
+		g_pl.next = playlist_after(g_pl.index);
+		g_pl.eof = 0;
+		g_pl.fails = 0;
+		g_pl.state = PL_IDLE;
+		g_stall_reset_count = 0;
+		atomic_store(&g_last_frame_us, mono_now_us());
+		LOG_INFO("Playlist: playing item %d/%d (%s)", g_pl.index + 1, g_pl.count, g_pl.items[g_pl.index]);
+		return;
+	}
+	case PL_DROP:
+		// Standby could not be set up: retire it (render context included) and try the item after it
+		if (standby->rctx) {
+			atomic_store(&g_pl_swapped, 0);
+			render_cmd_push(RCMD_PLAYER_DETACH, sb);
+			g_pl.state = PL_DETACHING;
+			return;
+		}
+		destroy_mpv(standby);
+		g_pl.fails++;
+		g_pl.next = playlist_after(g_pl.standby_item);
+		g_pl.state = PL_IDLE;
+		return;
+	case PL_DETACHING:
+		if (!atomic_load(&g_pl_swapped)) return;
+		g_pl.state = PL_DROP;
+		return;
+	}
+}
+
 // Initialize a single mpv instance that plays two videos via lavfi-complex and outputs a side-by-side composite
 static bool init_mpv_lavfi_dual(mpv_player_t *p, const char *file1, const char *file2) {
 	if (!p || !file1 || !file2) return false;
@@ -1258,11 +3363,13 @@ static bool init_mpv_lavfi_dual(mpv_player_t *p, const char *file1, const char *
 	if (!hwdec_pref || !*hwdec_pref) hwdec_pref = "no"; // safer default
 	r = mpv_set_option_string(p->mpv, "hwdec", hwdec_pref);
 	log_opt_result("hwdec", r);
+	if (g_low_mem) mpv_set_option_string(p->mpv, "hwdec-extra-frames", LOW_MEM_HWDEC_EXTRA_FRAMES);
 
 	// Basic playback flags
 	mpv_set_option_string(p->mpv, "osd-level", "0");
 	mpv_set_option_string(p->mpv, "cursor-autohide", "always");
 	mpv_set_option_string(p->mpv, "audio", getenv("PICKLE_FORCE_AUDIO") ? "yes" : "no");
+	if (g_bench_scenario >= 0) mpv_set_option_string(p->mpv, "untimed", "yes");
 
 	// GPU-friendly defaults
 	mpv_set_option_string(p->mpv, "scale", "bilinear");
@@ -1286,6 +3393,7 @@ static bool init_mpv_lavfi_dual(mpv_player_t *p, const char *file1, const char *
 	mpv_render_context_set_update_callback(p->rctx, on_mpv_events, NULL);
 	mpv_set_wakeup_callback(p->mpv, mpv_wakeup_cb, NULL);
 
+	cache_profile_apply(p, file1);
 	const char *cmd1[] = {"loadfile", file1, NULL};
 	if (mpv_command(p->mpv, cmd1) < 0) { fprintf(stderr, "Failed to load file %s\n", file1); return false; }
 	const char *cmd2[] = {"loadfile", file2, "append", NULL};
@@ -1295,12 +3403,331 @@ static bool init_mpv_lavfi_dual(mpv_player_t *p, const char *file1, const char *
 	return true;
 }
 
-static void drain_mpv_events(mpv_handle *h) {
+// --- Dual split mode (PICKLE_DUAL_SPLIT=1) ---
+// Two videos without the lavfi-complex composite: each source keeps its own core, is
+// hardware decoded and rendered by mpv straight into its instance FBO (no CPU scale or
+// hstack copy, no composite upload). The second core is a light follower (no audio,
+// small demuxer cache) whose clock is steered onto the first one's, standing in for the
+// shared lavfi timeline.
+#define DUAL_SYNC_INTERVAL_MS 500
+#define DUAL_SYNC_SEEK_S 0.5           // Drift beyond this is corrected with a seek
+#define DUAL_SYNC_TOLERANCE_S 0.02     // Drift within this plays the follower at normal speed
+#define DUAL_SYNC_MAX_TRIM 0.05        // Largest speed adjustment while catching up
+
+/**
+ * Trim the follower core before its file is loaded (properties, so the shared
+ * init_mpv_handle() setup stays as is)
+ *
+ * @param p Second player of the pair
+ */
+static void dual_split_follower_setup(mpv_player_t *p) {
+	if (!p->mpv) return;
+	int r = mpv_set_property_string(p->mpv, "aid", "no");
+	log_opt_result("follower aid=no", r);
+	p->cache_follower = 1; // cache_set() caps its demuxer cache
+	r = mpv_set_property_string(p->mpv, "vd-lavc-threads", "2");
+	log_opt_result("follower vd-lavc-threads", r);
+}
+
+/**
+ * Keep the follower on the lead's timeline (control thread, called every loop):
+ * small drift is trimmed with playback speed, large drift (a loop wrap, a stall) with
+ * an exact seek. Sources whose durations differ are left unsynchronized.
+ *
+ * @param lead First player (its clock is the reference)
+ * @param follow Second player
+ */
+static void dual_split_sync(mpv_player_t *lead, mpv_player_t *follow) {
+	static int64_t last_us = 0;
+	static double speed = 1.0;
+	static int mismatch_logged = 0;
+	int64_t now = mono_now_us();
+	if (now - last_us < DUAL_SYNC_INTERVAL_MS * 1000) return;
+	last_us = now;
+	if (!lead->mpv || !follow->mpv) return;
+	double t0 = 0.0, t1 = 0.0, d0 = 0.0, d1 = 0.0;
+	if (mpv_get_property(lead->mpv, "time-pos", MPV_FORMAT_DOUBLE, &t0) < 0 ||
+	    mpv_get_property(follow->mpv, "time-pos", MPV_FORMAT_DOUBLE, &t1) < 0) return;
+	mpv_get_property(lead->mpv, "duration", MPV_FORMAT_DOUBLE, &d0);
+	mpv_get_property(follow->mpv, "duration", MPV_FORMAT_DOUBLE, &d1);
+	if (fabs(d0 - d1) > 1.0) {
+		if (!mismatch_logged) LOG_INFO("Dual split: durations differ (%.1fs vs %.1fs); playing unsynchronized", d0, d1);
+		mismatch_logged = 1;
+		return;
+	}
+	double drift = t1 - t0, want = 1.0;
+	if (fabs(drift) > DUAL_SYNC_SEEK_S) {
+		char pos[32];
+		snprintf(pos, sizeof(pos), "%.3f", t0);
+		const char *cmd[] = {"seek", pos, "absolute+exact", NULL};
+		mpv_command_async(follow->mpv, 0, cmd);
+		LOG_DEBUG("Dual split: follower %.3fs off, seeking to %.3f", drift, t0);
+	} else if (fabs(drift) > DUAL_SYNC_TOLERANCE_S) {
+		want = 1.0 - drift; // close the gap over about a second
+		if (want < 1.0 - DUAL_SYNC_MAX_TRIM) want = 1.0 - DUAL_SYNC_MAX_TRIM;
+		if (want > 1.0 + DUAL_SYNC_MAX_TRIM) want = 1.0 + DUAL_SYNC_MAX_TRIM;
+	}
+	if (want != speed) {
+		mpv_set_property(follow->mpv, "speed", MPV_FORMAT_DOUBLE, &want);
+		speed = want;
+	}
+}
+
+// Load the current file again (mpv copies command arguments, so the path is freed at once)
+static void mpv_reload_file(mpv_handle *h) {
+	char *path = mpv_get_property_string(h, "path");
+	if (!path) return;
+	const char *cmd[] = {"loadfile", path, "replace", NULL};
+	mpv_command_async(h, 0, cmd);
+	mpv_free(path);
+}
+
+// --- Stall watchdog ---
+// When no frame has been rendered for g_wd_ongoing_ms, the stall is classified before
+// anything is reset, and only the cheapest fix for its class is applied:
+//   scanout: mpv has a newer frame than the last one rendered, so the display side is
+//            stuck (flip queue full, flip events missing): drop the flip queue and redraw
+//   demux:   mpv is starved of data (paused for cache, cache underrun or empty): wait,
+//            then seek in place so the demuxer restarts its read
+//   decode:  the demuxer has data but no frames come out: an exact seek in place (decoder
+//            flush), then one step down the hwdec ladder, then reloading the file
+// Further attempts in the same stall escalate within its class, one g_wd_ongoing_ms
+// apart; frames resuming resets the ladder. Per-class counts go to the metrics endpoint.
+typedef struct {
+	double cache_s;          // Media buffered ahead of the reader
+	int underrun;            // Demuxer ran dry while the decoder wanted data
+	int eof;                 // Demuxer reached the end of the file
+	int paused_for_cache;    // mpv paused itself to refill the cache
+	int64_t fw_bytes;        // Bytes buffered ahead of the reader
+	int64_t in_rate;         // Demuxer input rate while reading (bytes/s)
+} demux_health_t;
+
+static int g_stall_class = -1;       // Class of the current stall (-1 = none)
+static int64_t g_wd_attempt_us = 0;  // Last recovery action
+
+static void demux_health(mpv_player_t *p, demux_health_t *d) {
+	memset(d, 0, sizeof(*d));
+	if (!p || !p->mpv) return;
+	mpv_node node;
+	if (mpv_get_property(p->mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &node) >= 0) {
+		if (node.format == MPV_FORMAT_NODE_MAP) {
+			for (int i = 0; i < node.u.list->num; i++) {
+				const char *k = node.u.list->keys[i];
+				const mpv_node *v = &node.u.list->values[i];
+				if (!strcmp(k, "cache-duration") && v->format == MPV_FORMAT_DOUBLE) d->cache_s = v->u.double_;
+				else if (!strcmp(k, "underrun") && v->format == MPV_FORMAT_FLAG) d->underrun = v->u.flag;
+				else if (!strcmp(k, "eof") && v->format == MPV_FORMAT_FLAG) d->eof = v->u.flag;
+				else if (!strcmp(k, "fw-bytes") && v->format == MPV_FORMAT_INT64) d->fw_bytes = v->u.int64;
+				else if (!strcmp(k, "raw-input-rate") && v->format == MPV_FORMAT_INT64) d->in_rate = v->u.int64;
+			}
+		}
+		mpv_free_node_contents(&node);
+	}
+	mpv_get_property(p->mpv, "paused-for-cache", MPV_FORMAT_FLAG, &d->paused_for_cache);
+}
+
+/**
+ * Tell the kind of stall from the frame/flip timestamps and the demuxer state
+ *
+ * @param detail Receives the evidence, for the log line
+ */
+static stall_class_t wd_classify(const demux_health_t *d, char *detail, size_t detail_len) {
+	int64_t now = mono_now_us();
+	int64_t ready = atomic_load_explicit(&g_wd.frame_ready_us, memory_order_relaxed);
+	int64_t rendered = atomic_load_explicit(&g_wd.render_us, memory_order_relaxed);
+	int64_t flipped = atomic_load_explicit(&g_wd.flip_us, memory_order_relaxed);
+	if (ready > rendered) {
+		snprintf(detail, detail_len, "frame ready %.0f ms ago, last flip %.0f ms ago, %llu flip timeouts",
+		         (double)(now - ready) / 1000.0, flipped ? (double)(now - flipped) / 1000.0 : -1.0,
+		         (unsigned long long)atomic_load_explicit(&g_wd.flip_timeouts, memory_order_relaxed));
+		return STALL_SCANOUT;
+	}
+	snprintf(detail, detail_len, "cache %.2f s ahead%s%s%s", d->cache_s, d->underrun ? ", underrun" : "",
+	         d->paused_for_cache ? ", paused for cache" : "", d->eof ? ", demuxer at eof" : "");
+	if (d->paused_for_cache || d->underrun || (!d->eof && d->cache_s < 0.1)) return STALL_DEMUX;
+	return STALL_DECODE;
+}
+
+static void wd_seek(mpv_player_t *p, const char *target, const char *flags, const char *why) {
+	const char *cmd[] = {"seek", target, flags, NULL};
+	mpv_command_async(p->mpv, 0, cmd);
+	fprintf(stderr, "[wd] %s\n", why);
+}
+
+// Reinitialize the decoder one step down: zero-copy -> drm-copy -> software
+static bool wd_hwdec_step_down(mpv_player_t *p) {
+	const char *path = hwdec_path_str(p);
+	const char *next = !strcmp(path, "zero-copy") ? "drm-copy" : (!strcmp(path, "copy") ? "no" : NULL);
+	if (!next) return false;
+	p->zero_copy = 0;
+	p->hwdec_fallback_done = 1; // hwdec_check_fallback must not switch it back
+	if (mpv_set_property_string(p->mpv, "hwdec", next) < 0) return false;
+	fprintf(stderr, "[wd] reinitializing the decoder with hwdec=%s\n", next);
+	return true;
+}
+
+/**
+ * Classify an ongoing stall and apply the cheapest fix for it (control thread)
+ *
+ * @param p Player whose frames stopped
+ * @param since_ms Time since the last rendered frame
+ */
+static void wd_stall_recover(mpv_player_t *p, double since_ms) {
+	int64_t now = mono_now_us();
+	// Give the previous action time to work before escalating
+	if (g_stall_reset_count > 0 && now - g_wd_attempt_us < (int64_t)g_wd_ongoing_ms * 1000) return;
+	demux_health_t d;
+	demux_health(p, &d);
+	char detail[160];
+	stall_class_t cls = wd_classify(&d, detail, sizeof(detail));
+	if (g_stall_reset_count == 0 || g_stall_class != (int)cls) {
+		g_stall_count[cls]++;
+		g_stall_class = (int)cls;
+	}
+	int attempt = ++g_stall_reset_count;
+	g_stall_recoveries++;
+	g_wd_attempt_us = now;
+	fprintf(stderr, "[wd] %s stall: no frames for %.1f ms (%s), attempt %d/%d\n",
+		g_stall_names[cls], since_ms, detail, attempt, g_max_stall_resets);
+
+	if (cls == STALL_SCANOUT) {
+		// The render thread drops its flip queue and redraws; mpv is left alone
+		render_cmd_push(RCMD_FLIP_RESET, 0);
+		fprintf(stderr, "[wd] dropping queued page flips\n");
+		return;
+	}
+	if (!p || !p->mpv) return;
+	double pos = 0, duration = 0;
+	mpv_get_property(p->mpv, "time-pos", MPV_FORMAT_DOUBLE, &pos);
+	mpv_get_property(p->mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
+	if (g_loop_playback && (d.eof || (duration > 0 && pos > duration - 1.0))) {
+		// Stuck on the loop point: rewind rather than reload
+		wd_seek(p, "0", "absolute", "at the end of the file, seeking to the start for the loop");
+		return;
+	}
+	if (cls == STALL_DEMUX) {
+		if (attempt == 1) fprintf(stderr, "[wd] waiting for the demuxer to refill\n");
+		else wd_seek(p, "0", "relative+exact", "seeking in place to restart the demuxer read");
+		return;
+	}
+	if (attempt == 1) {
+		wd_seek(p, "0", "relative+exact", "seeking in place to flush the decoder");
+	} else if (attempt > 2 || !wd_hwdec_step_down(p)) {
+		fprintf(stderr, "[wd] reloading the file\n");
+		mpv_reload_file(p->mpv);
+	}
+}
+
+/**
+ * Whether a gap in rendered frames is by design: the render thread has had nothing to
+ * draw since its last frame and mpv is not expected to produce any (paused, or the core
+ * idle without waiting for the cache)
+ *
+ * @param p Player to ask
+ */
+static bool wd_idle_by_design(mpv_player_t *p) {
+	int64_t idle = atomic_load_explicit(&g_wd.idle_us, memory_order_relaxed);
+	int64_t rendered = atomic_load_explicit(&g_wd.render_us, memory_order_relaxed);
+	int64_t ready = atomic_load_explicit(&g_wd.frame_ready_us, memory_order_relaxed);
+	if (idle <= rendered || ready > rendered || !p || !p->mpv) return false;
+	if (mono_now_us() - idle > (int64_t)g_wd_ongoing_ms * 1000 / 2) return false; // render thread went quiet
+	int paused = 0, core_idle = 0, for_cache = 0;
+	mpv_get_property(p->mpv, "pause", MPV_FORMAT_FLAG, &paused);
+	mpv_get_property(p->mpv, "core-idle", MPV_FORMAT_FLAG, &core_idle);
+	mpv_get_property(p->mpv, "paused-for-cache", MPV_FORMAT_FLAG, &for_cache);
+	return paused || (core_idle && !for_cache);
+}
+
+// Frames are flowing again: the next stall starts a fresh ladder
+static void wd_stall_cleared(void) {
+	if (g_stall_class >= 0)
+		fprintf(stderr, "[wd] playback resumed after %s stall, resetting stall counter\n", g_stall_names[g_stall_class]);
+	g_stall_reset_count = 0;
+	g_stall_class = -1;
+}
+
+// --- Adaptive demuxer cache ---
+// Once a second the demuxer state of each network source is sampled. While the cache is
+// filling, input rate over media bitrate (fw-bytes / cache-duration) is the link's
+// headroom. An underrun or a link barely faster than playback grows readahead by half;
+// CACHE_CALM_TICKS full-cache samples on a link with CACHE_SHRINK_HEADROOM to spare
+// shrink it again. demuxer-max-bytes follows readahead at the measured bitrate, and the
+// back buffer holds the profile's back_secs, both within the profile's bounds.
+#define CACHE_ADAPT_MS 1000
+#define CACHE_GROW_HEADROOM 1.25    // Filling slower than this (x realtime) grows readahead
+#define CACHE_SHRINK_HEADROOM 3.0   // Link this much faster than playback may shrink it
+#define CACHE_CALM_TICKS 30
+
+static int64_t clamp_i64(int64_t v, int64_t lo, int64_t hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+/**
+ * Sample the demuxer cache (fill, input rate, underruns) and retune the profile's
+ * readahead and byte limits; control thread, rate limited to CACHE_ADAPT_MS
+ *
+ * @param p Player with a cache profile
+ */
+static void cache_adapt(mpv_player_t *p) {
+	if (!p || !p->mpv || !p->cache) return;
+	int64_t now = mono_now_us();
+	if (now - p->cache_adapt_us < (int64_t)CACHE_ADAPT_MS * 1000) return;
+	p->cache_adapt_us = now;
+	demux_health_t d;
+	demux_health(p, &d);
+	p->cache_fill_s = d.cache_s;
+	p->cache_fill_bytes = d.fw_bytes;
+	p->cache_in_rate = (double)d.in_rate;
+	int starved = (d.underrun || d.paused_for_cache) && !d.eof;
+	if (starved && !p->cache_underrun) p->cache_underruns++;
+	p->cache_underrun = starved;
+
+	const cache_profile_t *cp = p->cache;
+	if (!cp->adapt || d.eof || d.cache_s < 0.5 || d.fw_bytes <= 0) return;
+	cache_profile_t b = cache_bounds(cp);
+	double media_rate = (double)d.fw_bytes / d.cache_s; // bytes per second of media
+	double readahead = p->cache_readahead;
+	bool full = d.cache_s >= readahead * 0.9;
+	if (!full && d.in_rate > 0) p->cache_headroom = (double)d.in_rate / media_rate;
+	if (starved || (!full && d.in_rate > 0 && p->cache_headroom < CACHE_GROW_HEADROOM)) {
+		readahead *= 1.5;
+		p->cache_calm = 0;
+	} else if (full && p->cache_headroom >= CACHE_SHRINK_HEADROOM && ++p->cache_calm >= CACHE_CALM_TICKS) {
+		readahead /= 1.25;
+		p->cache_calm = 0;
+	}
+	if (readahead < b.readahead_min) readahead = b.readahead_min;
+	if (readahead > b.readahead_max) readahead = b.readahead_max;
+	int64_t max_bytes = clamp_i64((int64_t)(media_rate * readahead * 1.5), b.max_bytes_min, b.max_bytes_max);
+	// Never ask for more readahead than the byte limit holds, or the cache never reads as full
+	double fits = (double)max_bytes / (media_rate * 1.5);
+	if (readahead > fits) readahead = fits < b.readahead_min ? b.readahead_min : fits;
+	int64_t back_bytes = clamp_i64((int64_t)(media_rate * b.back_secs), 0, b.back_bytes_max);
+	double prev = p->cache_readahead;
+	cache_set(p, readahead, max_bytes, back_bytes);
+	if (p->cache_readahead != prev) {
+		LOG_INFO("Cache %s: readahead %.1f -> %.1f s (%.2f MB/s in, %.2f MB/s media, %lld MiB ahead, %lld MiB back)",
+			cp->name, prev, p->cache_readahead, (double)d.in_rate / 1e6, media_rate / 1e6,
+			(long long)(p->cache_max_bytes / CACHE_MIB), (long long)(p->cache_back_bytes / CACHE_MIB));
+	}
+}
+
+static void drain_mpv_events(mpv_player_t *p) {
+	if (!p || !p->mpv) return;
+	mpv_handle *h = p->mpv;
 	while (1) {
 		mpv_event *ev = mpv_wait_event(h, 0);
 		if (ev->event_id == MPV_EVENT_NONE) break;
+		if (g_pl.count && playlist_on_event(p, ev)) continue;
+		if (ev->event_id == MPV_EVENT_FILE_LOADED) cache_profile_refine(p);
 		if (ev->event_id == MPV_EVENT_VIDEO_RECONFIG) {
 			if (g_debug) fprintf(stderr, "[mpv] VIDEO_RECONFIG\n");
+			// Decoder (re)opened: record the active hwdec and fall back if zero-copy failed
+			hwdec_check_fallback(p);
+			// Source size for the FBO governor (render thread reads it)
+			int64_t vw = 0, vh = 0;
+			mpv_get_property(h, "video-params/w", MPV_FORMAT_INT64, &vw);
+			mpv_get_property(h, "video-params/h", MPV_FORMAT_INT64, &vh);
+			atomic_store(&p->src_w, (int)vw);
+			atomic_store(&p->src_h, (int)vh);
 		}
 		if (ev->event_id == MPV_EVENT_LOG_MESSAGE) {
 			mpv_event_log_message *lm = ev->data;
@@ -1314,7 +3741,7 @@ static void drain_mpv_events(mpv_handle *h) {
 			// This event can indicate that playback is resuming after a pause
 			// Mark it as activity to prevent stall detection from triggering
 			if (g_debug) fprintf(stderr, "[mpv] PLAYBACK_RESTART\n");
-			gettimeofday(&g_last_frame_time, NULL);
+			atomic_store(&g_last_frame_us, mono_now_us());
 		}
 		if (ev->event_id == MPV_EVENT_END_FILE) {
 			const mpv_event_end_file *ef = ev->data;
@@ -1338,14 +3765,13 @@ static void drain_mpv_events(mpv_handle *h) {
 				g_stall_reset_count = 0;
 				
 				// Update last frame time to avoid false stall detection during loop transition
-				gettimeofday(&g_last_frame_time, NULL);
+				atomic_store(&g_last_frame_us, mono_now_us());
 				
 				// Force a frame update at loop points
-				g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+				render_cmd_push(RCMD_REDRAW, 0);
 				
 				// Restart playback directly using a command
-				const char *cmd[] = {"loadfile", mpv_get_property_string(h, "path"), "replace", NULL};
-				mpv_command_async(h, 0, cmd);
+				mpv_reload_file(h);
 				
 				fprintf(stderr, "Looping playback (restarting file)...\n");
 				// Continue event processing, don't set g_stop flag
@@ -1360,28 +3786,176 @@ static void drain_mpv_events(mpv_handle *h) {
 // Note: Removed earlier experimental render_frame() that used a non-standard C++ lambda.
 // The fixed implementation below (render_frame_fixed) is the one actually used.
 
-// Because we attempted a C++-style lambda above (invalid in C), we need a proper handler
-// but we also must know the gbm_bo to release. We'll store a static reference to egl_ctx
-// and pass the bo as user data.
-static struct egl_ctx *g_egl_for_handler;
-// Forward state needed by page flip handler (must appear before handler definition)
-static struct gbm_bo *g_first_frame_bo = NULL; // BO used for initial modeset, released after second frame
-static int g_pending_flip = 0; // set after scheduling page flip until event handler fires
+static bool flipq_kick(void);
+
+/**
+ * Return a scanout BO to its owner: the FB ring when it came from there,
+ * otherwise the EGL window surface's GBM surface.
+ *
+ * @param e EGL context owning the window surface
+ * @param bo Buffer that is no longer queued or on screen
+ */
+static void scanout_release(egl_ctx_t *e, struct gbm_bo *bo) {
+	if (!bo) return;
+	for (int i = 0; i < g_fb_ring.count; i++) {
+		fb_ring_entry_t *r = &g_fb_ring.entries[i];
+		if (r->bo != bo) continue;
+		if (r->busy) { r->busy = 0; g_fb_ring.active--; }
+		return;
+	}
+	if (e && e->gbm_surf) gbm_surface_release_buffer(e->gbm_surf, bo);
+}
+
+/**
+ * Take the next FB ring entry for rendering. Entries are handed out and released
+ * in the same (flip) order, so the cycle is strictly round-robin.
+ *
+ * @return Entry index, or -1 if every entry is still queued or on screen
+ */
+static int fb_ring_acquire(void) {
+	if (!g_fb_ring.count) return -1;
+	fb_ring_entry_t *r = &g_fb_ring.entries[g_fb_ring.next_index];
+	if (r->busy) return -1;
+	r->busy = 1;
+	g_fb_ring.active++;
+	int idx = g_fb_ring.next_index;
+	g_fb_ring.next_index = (g_fb_ring.next_index + 1) % g_fb_ring.count;
+	return idx;
+}
+
+/**
+ * Number of rendered frames allowed to wait for scanout.
+ * Triple buffering keeps one frame queued behind the flip in flight.
+ */
+static int flipq_depth(void) {
+	return g_triple_buffer ? 2 : 1;
+}
+
+/**
+ * Whether the render loop may start another frame without stalling on scanout.
+ *
+ * @return true if the queue has room and a free back buffer exists
+ */
+static bool flipq_can_render(void) {
+	// mpv fills g_atomic_req while rendering, so plane commits must go out immediately
+	if (g_video_plane) return g_flipq.len == 0;
+	if (g_flipq.len >= flipq_depth()) return false;
+	if (g_fb_ring.count) return g_fb_ring.active < g_fb_ring.count;
+	if (g_flipq.egl && !gbm_surface_has_free_buffers(g_flipq.egl->gbm_surf)) return false;
+	return true;
+}
+
+/**
+ * Append a rendered frame to the flip queue.
+ *
+ * @param bo Locked front buffer, or NULL for a video plane commit
+ * @param fb_id Framebuffer for bo, or 0
+ * @param in_fence GPU completion fence (ownership passes to the queue), or -1
+ * @return true if queued, false if the queue is full
+ */
+static bool flipq_push(struct gbm_bo *bo, uint32_t fb_id, int in_fence) {
+	if (g_flipq.len >= FLIP_QUEUE_MAX) return false;
+	flip_entry_t *f = &g_flipq.slot[(g_flipq.head + g_flipq.len) % FLIP_QUEUE_MAX];
+	f->bo = bo;
+	f->fb_id = fb_id;
+	f->in_fence = in_fence;
+	f->queued_us = mono_now_us();
+	f->submit_us = 0;
+	g_flipq.len++;
+	return true;
+}
+
+/**
+ * Remove the head entry.
+ *
+ * @param shown true if its BO reached the screen (the previous scanout BO is then
+ *              returned to GBM), false if the frame is dropped
+ */
+static void flipq_pop(bool shown) {
+	if (g_flipq.len == 0) return;
+	flip_entry_t *f = &g_flipq.slot[g_flipq.head];
+	if (f->bo) {
+		struct gbm_bo *done = shown ? g_flipq.scanout : f->bo;
+		if (shown) g_flipq.scanout = f->bo;
+		scanout_release(g_flipq.egl, done);
+	}
+	if (f->in_fence >= 0) close(f->in_fence);
+	memset(f, 0, sizeof(*f));
+	f->in_fence = -1;
+	g_flipq.head = (g_flipq.head + 1) % FLIP_QUEUE_MAX;
+	g_flipq.len--;
+	g_flipq.in_flight = false;
+}
+
+// A parked flip has landed: it is on screen and the BO before it is free
+static void flipq_retired_landed(void) {
+	if (!g_flipq.retired) return;
+	scanout_release(g_flipq.egl, g_flipq.scanout);
+	g_flipq.scanout = g_flipq.retired;
+	g_flipq.retired = NULL;
+}
+
+/**
+ * Retire the in-flight head without its event. Its BO is parked in g_flipq.retired and
+ * the BO on screen stays locked, so neither is rendered into before the flip provably
+ * landed; the queue is free for new frames (their commit is retried on -EBUSY).
+ */
+static void flipq_park_head(void) {
+	if (!g_flipq.in_flight) return;
+	if (g_flipq.retired) flipq_retired_landed(); // the in-flight commit was accepted after it
+	flip_entry_t *f = &g_flipq.slot[g_flipq.head];
+	g_flipq.retired = f->bo;
+	g_flipq.retired_seq = g_flipq.seq;
+	f->bo = NULL; // kept locked in g_flipq.retired
+	flipq_pop(false);
+}
+
+/**
+ * Drop all queued frames (stall recovery). Frames not yet submitted are released; a
+ * flip the kernel accepted is parked (flipq_park_head), never waited for.
+ */
+static void flipq_reset(void) {
+	while (g_flipq.len > (g_flipq.in_flight ? 1 : 0)) {
+		// Unsubmitted frames sit behind the head: drop the newest first
+		flip_entry_t *f = &g_flipq.slot[(g_flipq.head + g_flipq.len - 1) % FLIP_QUEUE_MAX];
+		scanout_release(g_flipq.egl, f->bo);
+		if (f->in_fence >= 0) close(f->in_fence);
+		memset(f, 0, sizeof(*f));
+		f->in_fence = -1;
+		g_flipq.len--;
+	}
+	if (!g_flipq.in_flight) return;
+	flipq_park_head();
+	if (g_debug) fprintf(stderr, "[buffer] Flip still pending after reset; keeping its buffers until it lands\n");
+}
+
 static void page_flip_handler(int fd, unsigned int frame, unsigned int sec, unsigned int usec, void *data) {
-	(void)fd; (void)frame;
-	struct gbm_bo *old = data;
-	if (g_egl_for_handler && old) gbm_surface_release_buffer(g_egl_for_handler->gbm_surf, old);
-	g_pending_flip = 0; // flip completed
-	g_pending_flips--; // decrement pending flip count
-	
-	if (g_first_frame_bo && g_first_frame_bo != old) {
-		gbm_surface_release_buffer(g_egl_for_handler->gbm_surf, g_first_frame_bo);
-		g_first_frame_bo = NULL;
+	(void)fd;
+	sched_note_flip(frame, sec, usec);
+	// The late event of a flip parked by flipq_reset(): it is on screen now
+	if (g_flipq.retired && (uintptr_t)data == g_flipq.retired_seq) {
+		flipq_retired_landed();
+		flipq_kick();
+		return;
 	}
+	if (!g_flipq.in_flight || (uintptr_t)data != g_flipq.seq) return;
+	flipq_retired_landed(); // KMS completes flips in order, so a parked one landed before this
+	int64_t submit_us = g_flipq.slot[g_flipq.head].submit_us;
+	gov_note_flip(submit_us, mono_now_us());
+	int64_t boot_render_us = atomic_load_explicit(&g_boot.render_us, memory_order_relaxed);
+	if (boot_render_us && submit_us >= boot_render_us && !atomic_load_explicit(&g_boot.shown_us, memory_order_relaxed))
+		atomic_store(&g_boot.shown_us, mono_now_us());
+	atomic_store_explicit(&g_wd.flip_us, mono_now_us(), memory_order_relaxed);
+	if (submit_us > 0) {
+		int64_t flip_us = mono_now_us() - submit_us;
+		metrics_note_flip(flip_us);
+		if (g_prof_enabled) prof_record(PROF_FLIP, flip_us);
+	}
+	flipq_pop(true);
 	
 	// Update last frame time on successful page flip
 	struct timeval now; gettimeofday(&now, NULL);
-	g_last_frame_time = now;
+	atomic_store(&g_last_frame_us, mono_now_us());
 	g_last_flip_complete = now;
 	g_last_render_time = now;  // For frame pacing
 	
@@ -1398,6 +3972,419 @@ static void page_flip_handler(int fd, unsigned int frame, unsigned int sec, unsi
 				g_min_flip_time * 1000.0, g_avg_flip_time * 1000.0, g_max_flip_time * 1000.0, g_flip_count);
 		}
 	}
+	// The next queued frame can go out now that the CRTC is free
+	flipq_kick();
+}
+
+/**
+ * Submit one atomic commit for the primary plane (and optionally a full modeset).
+ * Any properties mpv already placed in g_atomic_req (video plane) go out in the
+ * same commit; the request is consumed either way.
+ *
+ * @param d Pointer to DRM context (d->atomic must be set)
+ * @param fb_id Framebuffer for the primary plane, or 0 to leave the primary plane untouched
+ * @param in_fence_fd GPU completion fence for fb_id, or -1
+ * @param modeset true for the blocking initial ALLOW_MODESET commit
+ * @param user_data Passed to page_flip_handler for non-blocking commits
+ * @return 0 on success, negative errno on failure
+ */
+static int atomic_commit_fb(kms_ctx_t *d, uint32_t fb_id, int in_fence_fd, bool modeset, void *user_data) {
+	drmModeAtomicReq *req = g_atomic_req ? g_atomic_req : drmModeAtomicAlloc();
+	g_atomic_req = NULL;
+	if (!req) return -ENOMEM;
+
+	if (modeset) {
+		drmModeAtomicAddProperty(req, d->connector_id, d->conn_prop_crtc_id, d->crtc_id);
+		drmModeAtomicAddProperty(req, d->crtc_id, d->crtc_prop.mode_id, d->mode_blob_id);
+		drmModeAtomicAddProperty(req, d->crtc_id, d->crtc_prop.active, 1);
+	}
+	if (fb_id) {
+		uint32_t pl = d->plane_id;
+		uint64_t w = d->mode.hdisplay, h = d->mode.vdisplay;
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.fb_id, fb_id);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.crtc_id, d->crtc_id);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.src_x, 0);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.src_y, 0);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.src_w, w << 16); // 16.16 fixed point
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.src_h, h << 16);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.crtc_x, 0);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.crtc_y, 0);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.crtc_w, w);
+		drmModeAtomicAddProperty(req, pl, d->plane_prop.crtc_h, h);
+		if (in_fence_fd >= 0 && d->plane_prop.in_fence_fd)
+			drmModeAtomicAddProperty(req, pl, d->plane_prop.in_fence_fd, (uint64_t)in_fence_fd);
+		// First GL frame after leaving plane mode: the video plane must not cover it
+		if (g_video_plane_detach && d->overlay_prop.fb_id && d->overlay_prop.crtc_id) {
+			drmModeAtomicAddProperty(req, d->overlay_plane_id, d->overlay_prop.fb_id, 0);
+			drmModeAtomicAddProperty(req, d->overlay_plane_id, d->overlay_prop.crtc_id, 0);
+		}
+		g_video_plane_detach = 0;
+	}
+
+	uint32_t flags;
+	if (modeset) {
+		flags = DRM_MODE_ATOMIC_ALLOW_MODESET;
+	} else {
+		flags = DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT;
+		// Keep the CRTC in the commit so a flip event is delivered even when only mpv's plane changed
+		if (!fb_id) drmModeAtomicAddProperty(req, d->crtc_id, d->crtc_prop.active, 1);
+	}
+	int ret = drmModeAtomicCommit(d->fd, req, flags, user_data);
+	if (ret) ret = -errno;
+	drmModeAtomicFree(req);
+	return ret;
+}
+
+/**
+ * Submit the head of the flip queue if the CRTC is idle. Never blocks: a busy CRTC
+ * (-EBUSY) leaves the frame queued for the next flip event or poll() iteration.
+ *
+ * @return false if KMS rejected the frame (it is dropped), true otherwise
+ */
+static bool flipq_kick(void) {
+	if (g_flipq.in_flight || g_flipq.len == 0 || !g_flipq.kms) return true;
+	kms_ctx_t *d = g_flipq.kms;
+	flip_entry_t *f = &g_flipq.slot[g_flipq.head];
+	void *user_data = (void *)(g_flipq.seq + 1);
+	gettimeofday(&g_last_flip_submit, NULL); // Record time of submission
+	int ret;
+	if (d->atomic) {
+		ret = atomic_commit_fb(d, f->fb_id, f->in_fence, false, user_data);
+	} else {
+		ret = drmModePageFlip(d->fd, d->crtc_id, f->fb_id, DRM_MODE_PAGE_FLIP_EVENT, user_data) ? -errno : 0;
+	}
+	// Video plane properties were consumed with the request, so only primary-plane frames can be retried
+	if (ret == -EBUSY && f->fb_id) return true;
+	if (f->in_fence >= 0) { close(f->in_fence); f->in_fence = -1; } // the commit holds its own reference
+	if (ret) {
+		fprintf(stderr, "[buffer] Page flip submit failed (%s), dropping frame\n", strerror(-ret));
+		flipq_pop(false);
+		return false;
+	}
+	flipq_retired_landed(); // KMS took a new flip, so a parked one is no longer pending
+	g_flipq.seq++;
+	f->submit_us = mono_now_us();
+	g_flipq.in_flight = true;
+	return true;
+}
+
+/**
+ * Render-loop housekeeping for the flip queue: count a flip whose event is late, park
+ * one whose event is lost (FLIP_LOST_US) so the frames behind it can go out, and
+ * resubmit a frame left waiting by -EBUSY.
+ */
+static void flipq_service(void) {
+	if (g_flipq.in_flight) {
+		flip_entry_t *f = &g_flipq.slot[g_flipq.head];
+		int64_t age = mono_now_us() - f->submit_us;
+		if (age >= FLIP_TIMEOUT_US && !f->late) {
+			f->late = 1;
+			if (g_debug) fprintf(stderr, "[buffer] No flip event after %lld ms, still waiting\n", (long long)(age / 1000));
+			atomic_fetch_add_explicit(&g_wd.flip_timeouts, 1, memory_order_relaxed);
+		}
+		if (age < FLIP_LOST_US) return;
+		fprintf(stderr, "[buffer] Flip event lost after %lld ms; keeping its buffers until a later flip lands\n",
+			(long long)(age / 1000));
+		flipq_park_head();
+	}
+	flipq_kick();
+}
+
+/**
+ * Poll timeout that wakes the render loop for the in-flight flip's next deadline
+ * (late, then lost) so flipq_service() runs on time.
+ *
+ * @return Milliseconds, or -1 if nothing is in flight
+ */
+static int flipq_timeout_ms(void) {
+	if (!g_flipq.in_flight) return -1;
+	const flip_entry_t *f = &g_flipq.slot[g_flipq.head];
+	int64_t due = f->submit_us + (f->late ? FLIP_LOST_US : FLIP_TIMEOUT_US) - mono_now_us();
+	return due > 0 ? (int)((due + 999) / 1000) : 0;
+}
+
+// --- Mesh control point storage ---
+// One 16-byte aligned block per mesh: the x plane, then the y plane, each padded to a
+// multiple of four floats so both start on a vector boundary.
+
+static void keystone_mesh_free(keystone_t *ks) {
+    free(ks->mesh_x);
+    ks->mesh_x = NULL;
+    ks->mesh_y = NULL;
+}
+
+// Regular grid over the unit square
+static void keystone_mesh_reset(keystone_t *ks) {
+    int n = ks->mesh_size;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            ks->mesh_x[r * n + c] = (float)c / (float)(n - 1);
+            ks->mesh_y[r * n + c] = (float)r / (float)(n - 1);
+        }
+    }
+}
+
+/**
+ * (Re)allocate the mesh as an n x n regular grid
+ *
+ * @param ks Keystone to resize
+ * @param n Control points per side (2..KEYSTONE_MESH_MAX)
+ * @return false on allocation failure (mesh left empty)
+ */
+static bool keystone_mesh_alloc(keystone_t *ks, int n) {
+    keystone_mesh_free(ks);
+    ks->mesh_size = n;
+    void *block = NULL;
+    if (posix_memalign(&block, 16, 2 * MESH_PLANE(n) * sizeof(float)) != 0) return false;
+    ks->mesh_x = block;
+    ks->mesh_y = ks->mesh_x + MESH_PLANE(n);
+    keystone_mesh_reset(ks);
+    return true;
+}
+
+static bool keystone_has_blend(const keystone_t *ks) {
+    return ks->blend[0] > 0.0f || ks->blend[1] > 0.0f || ks->blend[2] > 0.0f || ks->blend[3] > 0.0f;
+}
+
+// Keep blend widths in [0, BLEND_MAX_WIDTH] (config files are hand-edited)
+static void keystone_clamp_blend(keystone_t *ks) {
+    for (int i = 0; i < 4; i++) {
+        if (!(ks->blend[i] > 0.0f)) ks->blend[i] = 0.0f;
+        else if (ks->blend[i] > BLEND_MAX_WIDTH) ks->blend[i] = BLEND_MAX_WIDTH;
+    }
+}
+
+// --- Binary calibration cache ---
+// keystone.conf stays the human-readable import/export format; next to it, <name>.kcal
+// holds the same calibration as one mmap-able block: header, mesh control points as a
+// single float array and the tessellated mesh VBO, ready to upload without parsing.
+// Native byte order and float layout; any mismatch fails validation and the text is used.
+#define KCAL_MAGIC 0x4c434b50u   // "PKCL" read as a little-endian u32
+#define KCAL_VERSION 3             // 2: mesh stored as x[] then y[] planes; 3: blend widths
+#define KCAL_F_ENABLED   (1u << 0)
+#define KCAL_F_MESH      (1u << 1)
+#define KCAL_F_BORDER    (1u << 2)
+#define KCAL_F_MARKS     (1u << 3)
+#define KCAL_F_PIN0      (1u << 4) // ... KCAL_F_PIN0 << 3 for corner 4
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;           // Whole file in bytes
+	uint32_t checksum;       // FNV-1a over everything after the header
+	uint32_t flags;          // KCAL_F_*
+	int32_t mesh_size;       // Control points per side (0 = no mesh stored)
+	int32_t grid;            // Tessellated vertices per side (0 = no VBO stored)
+	float tex[4];            // u0, u1, v0, v1 the VBO texcoords were built with
+	float points[4][2];
+	float matrix[16];        // Homography for points (keystone_update_matrix_for)
+	float blend[4];          // Soft-edge widths (keystone_t.blend)
+	// float mesh_x[mesh_size * mesh_size], mesh_y[...], then float verts[grid * grid * 4]
+} kcal_header_t;
+
+// FNV-1a, continuing from h (start from 2166136261u)
+static uint32_t fnv1a32(uint32_t h, const void *data, size_t len) {
+	const unsigned char *p = data;
+	for (size_t i = 0; i < len; i++) { h ^= p[i]; h *= 16777619u; }
+	return h;
+}
+
+static uint32_t kcal_checksum(const unsigned char *p, size_t len) {
+	return fnv1a32(2166136261u, p, len);
+}
+
+// <conf path without .conf>.kcal
+static void keystone_cache_path(const char *conf_path, char *out, size_t len) {
+	size_t n = strlen(conf_path);
+	if (n > 5 && !strcmp(conf_path + n - 5, ".conf")) n -= 5;
+	snprintf(out, len, "%.*s.kcal", (int)n, conf_path);
+}
+
+/**
+ * Open "<path>.tmp" for an atomic replace of path (finish with atomic_file_commit)
+ *
+ * @param path Final file path
+ * @param tmp Receives the temporary path
+ * @param len Size of tmp
+ * @return Open stream, or NULL
+ */
+static FILE *atomic_file_open(const char *path, char *tmp, size_t len) {
+	snprintf(tmp, len, "%s.tmp", path);
+	FILE *f = fopen(tmp, "wb");
+	if (!f) LOG_ERROR("Failed to open file for writing: %s (%s)", tmp, strerror(errno));
+	return f;
+}
+
+// Flush and sync the temporary file, then rename it over path (readers never see a partial file)
+// and sync the directory, so the rename itself survives a power cut
+static bool atomic_file_commit(FILE *f, const char *tmp, const char *path) {
+	bool ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+	if (fclose(f) != 0) ok = false;
+	if (ok && rename(tmp, path) != 0) ok = false;
+	if (!ok) {
+		LOG_ERROR("Failed to write %s (%s)", path, strerror(errno));
+		unlink(tmp);
+		return false;
+	}
+	char dir[600];
+	const char *slash = strrchr(path, '/');
+	if (!slash) snprintf(dir, sizeof(dir), ".");
+	else snprintf(dir, sizeof(dir), "%.*s", slash == path ? 1 : (int)(slash - path), path);
+	int dfd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dfd < 0 || fsync(dfd) != 0) LOG_WARN("Failed to sync directory %s (%s)", dir, strerror(errno));
+	if (dfd >= 0) close(dfd);
+	return true;
+}
+
+// Text export alongside the cache (PICKLE_KEYSTONE_TEXT=0 writes only the .kcal)
+static bool keystone_text_export(void) {
+	const char *e = getenv("PICKLE_KEYSTONE_TEXT");
+	return !(e && *e && strcmp(e, "0") == 0);
+}
+
+/**
+ * Write the binary calibration of ks (write temp file, then rename)
+ *
+ * @param path .kcal path
+ * @param ks Keystone to store
+ * @param single Single-video keystone: also stores the mesh, its VBO and border/marker toggles
+ * @return true on success
+ */
+static bool kcal_save(const char *path, const keystone_t *ks, bool single) {
+	kcal_header_t h;
+	memset(&h, 0, sizeof(h));
+	h.magic = KCAL_MAGIC;
+	h.version = KCAL_VERSION;
+	if (ks->enabled) h.flags |= KCAL_F_ENABLED;
+	if (ks->mesh_enabled) h.flags |= KCAL_F_MESH;
+	for (int i = 0; i < 4; i++) if (ks->perspective_pins[i]) h.flags |= KCAL_F_PIN0 << i;
+	memcpy(h.points, ks->points, sizeof(h.points));
+	memcpy(h.blend, ks->blend, sizeof(h.blend));
+	keystone_t tmp_ks = *ks;
+	keystone_update_matrix_for(&tmp_ks); // always store the homography of the saved corners
+	memcpy(h.matrix, tmp_ks.matrix, sizeof(h.matrix));
+
+	int n = 0;
+	bool mesh_ok = single && ks->mesh_x && ks->mesh_size >= 2 && ks->mesh_size <= KEYSTONE_MESH_MAX;
+	if (single) {
+		if (g_show_border) h.flags |= KCAL_F_BORDER;
+		if (g_show_corner_markers) h.flags |= KCAL_F_MARKS;
+	}
+	float *verts = NULL;
+	if (mesh_ok) {
+		n = ks->mesh_size;
+		h.mesh_size = n;
+		if (ks->mesh_enabled) {
+			// Same texcoords as the single-video draw path
+			h.tex[0] = g_tex_flip_x ? 1.0f : 0.0f; h.tex[1] = g_tex_flip_x ? 0.0f : 1.0f;
+			h.tex[2] = g_tex_flip_y ? 1.0f : 0.0f; h.tex[3] = g_tex_flip_y ? 0.0f : 1.0f;
+			verts = mesh_tessellate(ks, h.tex[0], h.tex[1], h.tex[2], h.tex[3], NULL, &h.grid);
+			if (!verts) h.grid = 0;
+		}
+	}
+	size_t mesh_bytes = (size_t)n * (size_t)n * 2 * sizeof(float);
+	size_t vert_bytes = (size_t)h.grid * (size_t)h.grid * 4 * sizeof(float);
+	size_t total = sizeof(h) + mesh_bytes + vert_bytes;
+	unsigned char *buf = malloc(total);
+	if (!buf) { free(verts); return false; }
+	unsigned char *mesh = buf + sizeof(h);
+	if (n) {
+		memcpy(mesh, ks->mesh_x, mesh_bytes / 2);
+		memcpy(mesh + mesh_bytes / 2, ks->mesh_y, mesh_bytes / 2);
+	}
+	if (verts) memcpy(mesh + mesh_bytes, verts, vert_bytes);
+	free(verts);
+	h.size = (uint32_t)total;
+	h.checksum = kcal_checksum(buf + sizeof(h), total - sizeof(h));
+	memcpy(buf, &h, sizeof(h));
+
+	char tmp[520];
+	FILE *f = atomic_file_open(path, tmp, sizeof(tmp));
+	bool ok = f && fwrite(buf, 1, total, f) == total;
+	if (f) ok = atomic_file_commit(f, tmp, path) && ok;
+	free(buf);
+	return ok;
+}
+
+/**
+ * Load a binary calibration written by kcal_save(). The file is mmap'd; in single-video
+ * mode the stored mesh VBO goes straight from the mapping into g_mesh_geom when it was
+ * tessellated at the current subdivision (needs the EGL context current).
+ *
+ * @param path .kcal path
+ * @param conf_path Text config it caches; a newer text file is imported instead
+ * @param ks Keystone to fill
+ * @param single Single-video keystone (g_keystone)
+ * @return true if the cache was valid and applied
+ */
+static bool kcal_load(const char *path, const char *conf_path, keystone_t *ks, bool single) {
+	struct stat cst, tst;
+	if (stat(path, &cst) != 0) return false;
+	if (stat(conf_path, &tst) == 0 && (tst.st_mtim.tv_sec > cst.st_mtim.tv_sec ||
+		(tst.st_mtim.tv_sec == cst.st_mtim.tv_sec && tst.st_mtim.tv_nsec > cst.st_mtim.tv_nsec))) {
+		LOG_INFO("%s is newer than %s; importing the text configuration", conf_path, path);
+		return false;
+	}
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+	size_t len = (size_t)cst.st_size;
+	const unsigned char *map = len >= sizeof(kcal_header_t) ? mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (map == MAP_FAILED) return false;
+
+	kcal_header_t h;
+	memcpy(&h, map, sizeof(h));
+	size_t mesh_bytes = (size_t)h.mesh_size * (size_t)h.mesh_size * 2 * sizeof(float);
+	size_t vert_bytes = (size_t)h.grid * (size_t)h.grid * 4 * sizeof(float);
+	bool valid = h.magic == KCAL_MAGIC && h.version == KCAL_VERSION && h.size == len &&
+		(h.mesh_size == 0 || (h.mesh_size >= 2 && h.mesh_size <= KEYSTONE_MESH_MAX)) &&
+		h.grid >= 0 && h.grid <= 256 && sizeof(h) + mesh_bytes + vert_bytes == len &&
+		kcal_checksum(map + sizeof(h), len - sizeof(h)) == h.checksum;
+	if (!valid) {
+		LOG_WARN("Ignoring invalid calibration cache %s", path);
+		munmap((void *)map, len);
+		return false;
+	}
+
+	ks->enabled = (h.flags & KCAL_F_ENABLED) != 0;
+	ks->mesh_enabled = (h.flags & KCAL_F_MESH) != 0;
+	for (int i = 0; i < 4; i++) ks->perspective_pins[i] = (h.flags & (KCAL_F_PIN0 << i)) != 0;
+	memcpy(ks->points, h.points, sizeof(ks->points));
+	memcpy(ks->matrix, h.matrix, sizeof(ks->matrix));
+	memcpy(ks->matrix_points, h.points, sizeof(ks->matrix_points)); // no re-solve needed
+	memcpy(ks->blend, h.blend, sizeof(ks->blend));
+	keystone_clamp_blend(ks);
+	ks->geom_gen++;
+	if (single) {
+		g_show_border = (h.flags & KCAL_F_BORDER) != 0;
+		g_show_corner_markers = (h.flags & KCAL_F_MARKS) != 0;
+		int n = h.mesh_size;
+		if (n && keystone_mesh_alloc(&g_keystone, n)) {
+			const float *mesh = (const float *)(map + sizeof(h));
+			memcpy(g_keystone.mesh_x, mesh, mesh_bytes / 2);
+			memcpy(g_keystone.mesh_y, mesh + (size_t)n * (size_t)n, mesh_bytes / 2);
+			mesh_geom_t *m = &g_mesh_geom;
+			float *src = malloc(mesh_bytes);
+			if (h.grid && h.grid == mesh_grid_for(n) && src && eglGetCurrentContext() != EGL_NO_CONTEXT) {
+				if (m->vbo == 0) glGenBuffers(1, &m->vbo);
+				glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
+				glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vert_bytes, map + sizeof(h) + mesh_bytes, GL_STATIC_DRAW);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				if (mesh_geom_build_indices(m, h.grid)) {
+					// Matches what mesh_geom_update() would have built: the first frame skips tessellation
+					memcpy(src, mesh, mesh_bytes);
+					free(m->src_points);
+					m->src_points = src;
+					src = NULL;
+					m->src_size = n;
+					memcpy(m->tex, h.tex, sizeof(m->tex));
+				}
+			}
+			free(src);
+		}
+	}
+	munmap((void *)map, len);
+	LOG_INFO("Loaded calibration cache %s", path);
+	return true;
 }
 
 /**
@@ -1408,8 +4395,13 @@ static void page_flip_handler(int fd, unsigned int frame, unsigned int sec, unsi
  * @return true if the configuration was loaded successfully, false otherwise
  */
 static bool keystone_load_config_to(const char* path, keystone_t *ks) {
+    if (g_bench_scenario >= 0) return false; // benchmarks never depend on saved calibration
     if (!path || !ks) return false;
     
+    char cache_path[520];
+    keystone_cache_path(path, cache_path, sizeof(cache_path));
+    if (kcal_load(cache_path, path, ks, false)) return true;
+    
     FILE* f = fopen(path, "r");
     if (!f) return false;
     
@@ -1448,12 +4440,17 @@ static bool keystone_load_config_to(const char* path, keystone_t *ks) {
         else if (strncmp(line, "pin4=", 5) == 0) {
             ks->perspective_pins[3] = (atoi(line + 5) != 0);
         }
+        else if (strncmp(line, "blend=", 6) == 0) {
+            sscanf(line + 6, "%f,%f,%f,%f", &ks->blend[0], &ks->blend[1], &ks->blend[2], &ks->blend[3]);
+        }
     }
     fclose(f);
+    keystone_clamp_blend(ks);
     
     if (ks->enabled) {
         keystone_update_matrix_for(ks);
     }
+    ks->geom_gen++;
     
     return true;
 }
@@ -1468,11 +4465,13 @@ static bool keystone_load_config_to(const char* path, keystone_t *ks) {
 static bool keystone_save_config_from(const char* path, const keystone_t *ks) {
     if (!path || !ks) return false;
     
-    FILE* f = fopen(path, "w");
-    if (!f) {
-        LOG_ERROR("Failed to open file for writing: %s (%s)", path, strerror(errno));
-        return false;
-    }
+    char cache_path[520];
+    keystone_cache_path(path, cache_path, sizeof(cache_path));
+    if (!keystone_text_export()) return kcal_save(cache_path, ks, false);
+    
+    char tmp[520];
+    FILE* f = atomic_file_open(path, tmp, sizeof(tmp));
+    if (!f) return false;
     
     fprintf(f, "# Pickle keystone configuration\n");
     fprintf(f, "enabled=%d\n", ks->enabled ? 1 : 0);
@@ -1482,9 +4481,11 @@ static bool keystone_save_config_from(const char* path, const keystone_t *ks) {
         fprintf(f, "corner%d=%.6f,%.6f\n", i+1, ks->points[i][0], ks->points[i][1]);
         fprintf(f, "pin%d=%d\n", i+1, ks->perspective_pins[i] ? 1 : 0);
     }
+    fprintf(f, "blend=%.4f,%.4f,%.4f,%.4f\n", ks->blend[0], ks->blend[1], ks->blend[2], ks->blend[3]);
     
-    fclose(f);
-    return true;
+    // Text first, cache second: the cache must not look older than its source
+    if (!atomic_file_commit(f, tmp, path)) return false;
+    return kcal_save(cache_path, ks, false);
 }
 
 /**
@@ -1497,8 +4498,14 @@ static bool keystone_save_config_from(const char* path, const keystone_t *ks) {
  * @return true if the configuration was loaded successfully, false otherwise
  */
 static bool keystone_load_config(const char* path) {
+    if (g_bench_scenario >= 0) return false; // benchmarks never depend on saved calibration
     if (!path) return false;
     
+    // Binary cache first; the text file is the import format
+    char cache_path[520];
+    keystone_cache_path(path, cache_path, sizeof(cache_path));
+    if (kcal_load(cache_path, path, &g_keystone, true)) return true;
+    
     FILE* f = fopen(path, "r");
     if (!f) return false;
     
@@ -1517,27 +4524,8 @@ static bool keystone_load_config(const char* path) {
             int new_size = atoi(line + 10);
             if (new_size >= 2 && new_size <= 10) { // Sanity check
                 // Only change if different (requires reallocation)
-                if (new_size != g_keystone.mesh_size) {
-                    // Clean up old mesh if it exists
-                    cleanup_mesh_resources();
-                    
-                    // Set new size and allocate
-					g_keystone.mesh_size = new_size;
-					g_keystone.mesh_points = malloc((size_t)new_size * sizeof(float*));
-                    if (g_keystone.mesh_points) {
-                        for (int i = 0; i < new_size; i++) {
-							g_keystone.mesh_points[i] = malloc((size_t)new_size * 2 * sizeof(float));
-                            if (g_keystone.mesh_points[i]) {
-                                // Initialize with default grid positions
-                                for (int j = 0; j < new_size; j++) {
-									float x = (float)j / (float)(new_size - 1);
-									float y = (float)i / (float)(new_size - 1);
-                                    g_keystone.mesh_points[i][j*2] = x;
-                                    g_keystone.mesh_points[i][j*2+1] = y;
-                                }
-                            }
-                        }
-                    }
+                if (new_size != g_keystone.mesh_size || !g_keystone.mesh_x) {
+                    keystone_mesh_alloc(&g_keystone, new_size); // default grid until mesh_ lines follow
                 }
             }
         }
@@ -1571,26 +4559,31 @@ static bool keystone_load_config(const char* path) {
         else if (strncmp(line, "cornermarks=", 12) == 0) {
             g_show_corner_markers = (atoi(line + 12) != 0);
         }
+        else if (strncmp(line, "blend=", 6) == 0) {
+            sscanf(line + 6, "%f,%f,%f,%f", &g_keystone.blend[0], &g_keystone.blend[1],
+                   &g_keystone.blend[2], &g_keystone.blend[3]);
+        }
         else if (strncmp(line, "mesh_", 5) == 0) {
             // Parse mesh point coordinates: mesh_i_j=x,y
             int i, j;
             float x, y;
             if (sscanf(line + 5, "%d_%d=%f,%f", &i, &j, &x, &y) == 4) {
                 if (i >= 0 && i < g_keystone.mesh_size && 
-                    j >= 0 && j < g_keystone.mesh_size &&
-                    g_keystone.mesh_points && g_keystone.mesh_points[i]) {
-                    g_keystone.mesh_points[i][j*2] = x;
-                    g_keystone.mesh_points[i][j*2+1] = y;
+                    j >= 0 && j < g_keystone.mesh_size && g_keystone.mesh_x) {
+                    g_keystone.mesh_x[i * g_keystone.mesh_size + j] = x;
+                    g_keystone.mesh_y[i * g_keystone.mesh_size + j] = y;
                 }
             }
         }
     }
     fclose(f);
+    keystone_clamp_blend(&g_keystone);
     
     // Update matrix based on loaded settings
     if (g_keystone.enabled) {
         keystone_update_matrix();
     }
+    g_keystone.geom_gen++;
     
     return true;
 }
@@ -1613,28 +4606,24 @@ static void keystone_init(void) {
     for (int i = 0; i < 4; i++) {
         g_keystone.perspective_pins[i] = false;
     }
+    memset(g_keystone.blend, 0, sizeof(g_keystone.blend));
     
     // Initialize identity matrix
     for (int i = 0; i < 16; i++) {
         g_keystone.matrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
     }
+    g_keystone.geom_gen++;
     
-    // Allocate mesh points if necessary
-    if (g_keystone.mesh_points == NULL) {
-	g_keystone.mesh_points = malloc((size_t)g_keystone.mesh_size * sizeof(float*));
-        if (g_keystone.mesh_points) {
-            for (int i = 0; i < g_keystone.mesh_size; i++) {
-				g_keystone.mesh_points[i] = malloc((size_t)g_keystone.mesh_size * 2 * sizeof(float));
-                if (g_keystone.mesh_points[i]) {
-                    // Initialize regular grid of points
-                    for (int j = 0; j < g_keystone.mesh_size; j++) {
-						float x = (float)j / (float)(g_keystone.mesh_size - 1);
-						float y = (float)i / (float)(g_keystone.mesh_size - 1);
-                        g_keystone.mesh_points[i][j*2] = x;     // x coordinate
-                        g_keystone.mesh_points[i][j*2+1] = y;   // y coordinate
-                    }
-                }
-            }
+    // Allocate mesh points if necessary (regular grid)
+    if (g_keystone.mesh_x == NULL) keystone_mesh_alloc(&g_keystone, g_keystone.mesh_size);
+    
+    // Mesh subdivision first: a cached mesh VBO is only used if it matches
+    const char* subdiv_env = getenv("PICKLE_MESH_SUBDIV");
+    if (subdiv_env && *subdiv_env) {
+        int subdiv = atoi(subdiv_env);
+        if (subdiv >= 1 && subdiv <= 32) {
+            g_mesh_subdiv = subdiv;
+            LOG_INFO("Mesh warp subdivision set to %d", g_mesh_subdiv);
         }
     }
     
@@ -1696,7 +4685,6 @@ static void keystone_init(void) {
         }
     }
     
-    // Check for environment variable to set adjustment step size
     const char* step_env = getenv("PICKLE_KEYSTONE_STEP");
     if (step_env && *step_env) {
         int step = atoi(step_env);
@@ -1735,67 +4723,60 @@ static void keystone_init(void) {
 	// Corner markers env (1=on, 0=off)
 	const char* show_corners = getenv("PICKLE_SHOW_CORNERS");
 	if (show_corners && *show_corners) g_show_corner_markers = atoi(show_corners) ? true : false;
+}
 
-	// Single mpv lavfi-complex mode (1=on, 0=off)
-	const char* single_mpv = getenv("PICKLE_SINGLE_MPV");
-	if (single_mpv && *single_mpv) g_single_mpv_mode = atoi(single_mpv) ? 1 : 0;
-	
-	// Alternate frame rendering mode for dual-video (1=on [default], 0=off)
-	// When enabled, only one video's FBO is updated per frame, halving GPU work
-	const char* alt_frame = getenv("PICKLE_ALTERNATE_FRAMES");
-	if (alt_frame && *alt_frame) g_alternate_frame_mode = atoi(alt_frame) ? 1 : 0;
+/**
+ * Default corners for a video instance: the screen split into a near-square grid
+ * (2 videos = left/right halves, 3-4 = 2x2, 5-6 = 3x2, 7-9 = 3x3), filled row by row.
+ * 
+ * @param ks Keystone to place
+ * @param video_index Index of this video
+ * @param total_videos Total number of videos
+ */
+static void keystone_default_points(keystone_t *ks, int video_index, int total_videos) {
+    int cols = 1;
+    while (cols * cols < total_videos) cols++;
+    int rows = (total_videos + cols - 1) / cols;
+    float x0 = (float)(video_index % cols) / (float)cols, x1 = (float)(video_index % cols + 1) / (float)cols;
+    float y0 = (float)(video_index / cols) / (float)rows, y1 = (float)(video_index / cols + 1) / (float)rows;
+    ks->points[0][0] = x0; ks->points[0][1] = y0; // Top-left
+    ks->points[1][0] = x1; ks->points[1][1] = y0; // Top-right
+    ks->points[2][0] = x1; ks->points[2][1] = y1; // Bottom-right
+    ks->points[3][0] = x0; ks->points[3][1] = y1; // Bottom-left
 }
 
 /**
  * Initialize keystone for a specific video instance with default position
  * 
  * @param inst Pointer to the video instance
- * @param video_index Index of this video (0 or 1)
- * @param total_videos Total number of videos (1 or 2)
+ * @param video_index Index of this video (0..total_videos-1)
+ * @param total_videos Total number of videos (1..MAX_VIDEOS)
  */
 static void keystone_init_instance(video_instance_t *inst, int video_index, int total_videos) {
     keystone_t *ks = &inst->keystone;
     
-    // Initialize with default values
-    if (total_videos == 1) {
-        // Single video: full screen
-        ks->points[0][0] = 0.0f; ks->points[0][1] = 0.0f; // Top-left
-        ks->points[1][0] = 1.0f; ks->points[1][1] = 0.0f; // Top-right
-        ks->points[2][0] = 1.0f; ks->points[2][1] = 1.0f; // Bottom-right
-        ks->points[3][0] = 0.0f; ks->points[3][1] = 1.0f; // Bottom-left
-    } else {
-        // Dual video: split left/right
-        if (video_index == 0) {
-            // Video 0: left half
-            ks->points[0][0] = 0.0f; ks->points[0][1] = 0.0f; // Top-left
-            ks->points[1][0] = 0.5f; ks->points[1][1] = 0.0f; // Top-right
-            ks->points[2][0] = 0.5f; ks->points[2][1] = 1.0f; // Bottom-right
-            ks->points[3][0] = 0.0f; ks->points[3][1] = 1.0f; // Bottom-left
-        } else {
-            // Video 1: right half
-            ks->points[0][0] = 0.5f; ks->points[0][1] = 0.0f; // Top-left
-            ks->points[1][0] = 1.0f; ks->points[1][1] = 0.0f; // Top-right
-            ks->points[2][0] = 1.0f; ks->points[2][1] = 1.0f; // Bottom-right
-            ks->points[3][0] = 0.5f; ks->points[3][1] = 1.0f; // Bottom-left
-        }
-    }
+    // Initialize with default values (single video: full screen)
+    keystone_default_points(ks, video_index, total_videos);
     
     ks->active_corner = -1;
     ks->enabled = true;  // Always enabled in multi-video mode
     ks->mesh_enabled = false;
     ks->mesh_size = 4;
-    ks->mesh_points = NULL;
+    ks->mesh_x = NULL;
+    ks->mesh_y = NULL;
     ks->active_mesh_point[0] = -1;
     ks->active_mesh_point[1] = -1;
     
     for (int i = 0; i < 4; i++) {
         ks->perspective_pins[i] = false;
     }
+    memset(ks->blend, 0, sizeof(ks->blend)); // hard edges until a config sets a blend
     
     // Initialize identity matrix
     for (int i = 0; i < 16; i++) {
         ks->matrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
     }
+    ks->geom_gen++;
     
     // Initialize FBO to 0 (will be created during render)
     inst->fbo = 0;
@@ -1804,6 +4785,8 @@ static void keystone_init_instance(video_instance_t *inst, int video_index, int
     inst->fbo_h = 0;
     inst->index = video_index;
     inst->update_flags = 0;
+    inst->pending_since_us = 0;
+    inst->skipped = 0;
     
     // Set config path for this instance
     snprintf(inst->config_path, sizeof(inst->config_path), "./keystone_%d.conf", video_index);
@@ -1855,72 +4838,87 @@ static bool keystone_save_instance_config(video_instance_t *inst) {
 }
 
 /**
- * Update keystone matrix for a specific instance
+ * Update keystone homography for a specific instance
+ * 
+ * Solves the projective map (square-to-quad) taking the unit square (s right,
+ * t down) onto the corner quad in clip space and stores it as a column-major
+ * mat4 acting on (s, t, 0, 1). The bottom row (g, h, 1) gives each corner's w.
  * 
  * @param ks Pointer to the keystone structure to update
  */
 static void keystone_update_matrix_for(keystone_t *ks) {
-    if (!ks->enabled) {
-        for (int i = 0; i < 16; i++) {
-            ks->matrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
-        }
-        return;
-    }
-    
-    // Convert normalized corner positions to clip space
-    float vertices[8];
+    // Corners in clip space, in unit-square order (0,0) (1,0) (1,1) (0,1) = TL TR BR BL
+    float x[4], y[4];
     for (int i = 0; i < 4; i++) {
-        vertices[i*2]   = ks->points[i][0] * 2.0f - 1.0f;
-        vertices[i*2+1] = (1.0f - ks->points[i][1]) * 2.0f - 1.0f;
+        x[i] = ks->points[i][0] * 2.0f - 1.0f;
+        y[i] = 1.0f - ks->points[i][1] * 2.0f;
     }
     
-    // Store as vertex positions
-    ks->matrix[0] = vertices[0];  // TL.x
-    ks->matrix[1] = vertices[1];  // TL.y
-    ks->matrix[2] = vertices[2];  // TR.x
-    ks->matrix[3] = vertices[3];  // TR.y
-    ks->matrix[4] = vertices[6];  // BL.x
-    ks->matrix[5] = vertices[7];  // BL.y
-    ks->matrix[6] = vertices[4];  // BR.x
-    ks->matrix[7] = vertices[5];  // BR.y
+    float dx1 = x[1] - x[2], dx2 = x[3] - x[2], dx3 = x[0] - x[1] + x[2] - x[3];
+    float dy1 = y[1] - y[2], dy2 = y[3] - y[2], dy3 = y[0] - y[1] + y[2] - y[3];
+    float g = 0.0f, h = 0.0f;
+    float det = dx1 * dy2 - dx2 * dy1;
+    if ((dx3 != 0.0f || dy3 != 0.0f) && fabsf(det) > 1e-8f) {
+        g = (dx3 * dy2 - dx2 * dy3) / det;
+        h = (dx1 * dy3 - dx3 * dy1) / det;
+    } // else parallelogram (or degenerate quad): affine map
+    
+    float a = x[1] - x[0] + g * x[1], b = x[3] - x[0] + h * x[3], c = x[0];
+    float d = y[1] - y[0] + g * y[1], e = y[3] - y[0] + h * y[3], f = y[0];
+    
+    float *m = ks->matrix;
+    m[0] = a; m[1] = d; m[2]  = 0.0f; m[3]  = g;
+    m[4] = b; m[5] = e; m[6]  = 0.0f; m[7]  = h;
+    m[8] = 0.0f; m[9] = 0.0f; m[10] = 1.0f; m[11] = 0.0f;
+    m[12] = c; m[13] = f; m[14] = 0.0f; m[15] = 1.0f;
+    memcpy(ks->matrix_points, ks->points, sizeof(ks->points));
+    ks->geom_gen++;
 }
 
 /**
  * Calculate the perspective transformation matrix based on the corner points
- * Updates the vertex coordinates used for rendering with the shader
+ * Updates the homography used for perspective-correct texturing
  */
 static void keystone_update_matrix(void) {
-    if (!g_keystone.enabled) {
-        // Identity matrix
-        for (int i = 0; i < 16; i++) {
-            g_keystone.matrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
-        }
-        return;
-    }
-    
-    // Convert the normalized corner positions to clip space coordinates (-1 to 1)
-    float vertices[8];
+    keystone_update_matrix_for(&g_keystone);
     
-    // Map from 0-1 normalized space to -1 to 1 clip space
+    LOG_DEBUG("Updated keystone homography: a=%.3f b=%.3f c=%.3f d=%.3f e=%.3f f=%.3f g=%.3f h=%.3f",
+        g_keystone.matrix[0], g_keystone.matrix[4], g_keystone.matrix[12],
+        g_keystone.matrix[1], g_keystone.matrix[5], g_keystone.matrix[13],
+        g_keystone.matrix[3], g_keystone.matrix[7]);
+}
+
+/**
+ * Fill projective texture coordinates for the 4-vertex keystone quad
+ * 
+ * Each corner gets (u*q, v*q, 0, q) with q = 1/w from the cached homography.
+ * These interpolate linearly in screen space and texture2DProj divides per
+ * fragment, so the image stays perspective-correct across both triangles.
+ * If any corner has w <= 0 (non-convex quad), all four get q = 1 (affine).
+ * The homography is recomputed only if a corner moved since the last update.
+ * 
+ * @param ks Keystone whose corners define the quad
+ * @param u0,u1,v0,v1 Texture coordinates at the left/right/top/bottom edges
+ * @param out 16 floats in draw order TL, TR, BL, BR
+ */
+static void keystone_fill_texcoords(keystone_t *ks, float u0, float u1, float v0, float v1, float out[16]) {
+    if (memcmp(ks->matrix_points, ks->points, sizeof(ks->points)) != 0) keystone_update_matrix_for(ks);
+    const float *m = ks->matrix;
+    const float st[4][2] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f} };
+    const float uv[4][2] = { {u0, v0}, {u1, v0}, {u0, v1}, {u1, v1} };
+    float w[4];
+    bool affine = false; // non-convex quad: affine for all four corners, never a mix
     for (int i = 0; i < 4; i++) {
-        vertices[i*2]   = g_keystone.points[i][0] * 2.0f - 1.0f; // x: 0-1 -> -1 to 1
-        vertices[i*2+1] = (1.0f - g_keystone.points[i][1]) * 2.0f - 1.0f; // y: 0-1 -> 1 to -1 (flip y)
+        w[i] = m[3] * st[i][0] + m[7] * st[i][1] + m[15];
+        if (w[i] <= 1e-4f) affine = true;
+    }
+    for (int i = 0; i < 4; i++) {
+        float q = affine ? 1.0f : 1.0f / w[i];
+        out[i*4 + 0] = uv[i][0] * q;
+        out[i*4 + 1] = uv[i][1] * q;
+        out[i*4 + 2] = 0.0f;
+        out[i*4 + 3] = q;
     }
-    
-    // Store the matrix as vertex positions for the shader
-    // Vertex order for triangle strip: top-left, top-right, bottom-left, bottom-right
-    g_keystone.matrix[0] = vertices[0];  // TL.x
-    g_keystone.matrix[1] = vertices[1];  // TL.y
-    g_keystone.matrix[2] = vertices[2];  // TR.x
-    g_keystone.matrix[3] = vertices[3];  // TR.y
-    g_keystone.matrix[4] = vertices[6];  // BL.x
-    g_keystone.matrix[5] = vertices[7];  // BL.y
-    g_keystone.matrix[6] = vertices[4];  // BR.x
-    g_keystone.matrix[7] = vertices[5];  // BR.y
-    
-    LOG_DEBUG("Updated keystone vertices: TL(%.2f,%.2f) TR(%.2f,%.2f) BL(%.2f,%.2f) BR(%.2f,%.2f)",
-        vertices[0], vertices[1], vertices[2], vertices[3], 
-        vertices[6], vertices[7], vertices[4], vertices[5]);
 }
 
 /**
@@ -1933,8 +4931,7 @@ static void keystone_update_matrix(void) {
 // Adjust a mesh point position
 static void keystone_adjust_mesh_point(int row, int col, float x_delta, float y_delta) {
     if (row < 0 || row >= g_keystone.mesh_size || 
-        col < 0 || col >= g_keystone.mesh_size ||
-        !g_keystone.mesh_points || !g_keystone.mesh_points[row]) {
+        col < 0 || col >= g_keystone.mesh_size || !g_keystone.mesh_x) {
         return;
     }
     
@@ -1942,13 +4939,10 @@ static void keystone_adjust_mesh_point(int row, int col, float x_delta, float y_
     x_delta *= 10.0f;
     y_delta *= 10.0f;
     
-    // Adjust the mesh point position
-    g_keystone.mesh_points[row][col*2] += x_delta;
-    g_keystone.mesh_points[row][col*2+1] += y_delta;
-    
-    // Clamp values to reasonable ranges (slightly beyond 0-1 to allow for overcorrection)
-    g_keystone.mesh_points[row][col*2] = fmaxf(-0.5f, fminf(1.5f, g_keystone.mesh_points[row][col*2]));
-    g_keystone.mesh_points[row][col*2+1] = fmaxf(-0.5f, fminf(1.5f, g_keystone.mesh_points[row][col*2+1]));
+    // Adjust the mesh point position, clamped slightly beyond 0-1 to allow for overcorrection
+    int k = row * g_keystone.mesh_size + col;
+    g_keystone.mesh_x[k] = fmaxf(-0.5f, fminf(1.5f, g_keystone.mesh_x[k] + x_delta));
+    g_keystone.mesh_y[k] = fmaxf(-0.5f, fminf(1.5f, g_keystone.mesh_y[k] + y_delta));
 }
 
 // Toggle pinning status of a corner
@@ -1957,6 +4951,7 @@ static void keystone_toggle_pin(int corner) {
     
     // Toggle the pin status
     g_keystone.perspective_pins[corner] = !g_keystone.perspective_pins[corner];
+    g_keystone.geom_gen++;
     LOG_INFO("Corner %d pin %s", corner + 1, g_keystone.perspective_pins[corner] ? "enabled" : "disabled");
 }
 
@@ -2031,65 +5026,302 @@ static void keystone_adjust_corner(int corner, float x_delta, float y_delta) {
 // Shader source code for keystone correction
 static const char* g_vertex_shader_src = 
     "attribute vec2 a_position;\n"
-    "attribute vec2 a_texCoord;\n"
-    "varying vec2 v_texCoord;\n"
+    "attribute vec4 a_texCoord;\n"
+    "varying vec4 v_texCoord;\n"
+    "#ifdef EDGE_BLEND\n"
+    "uniform vec4 u_blendXform;\n"
+    "varying vec4 v_blendCoord;\n"
+    "#endif\n"
     "void main() {\n"
     "    // Position is already in clip space coordinates (-1 to 1)\n"
     "    gl_Position = vec4(a_position, 0.0, 1.0);\n"
+    "#ifdef SCANOUT_Y_FLIP\n"
+    "    gl_Position.y = -gl_Position.y;\n"
+    "#endif\n"
     "    \n"
-    "    // Use the provided texture coordinates directly\n"
+    "    // Projective q-coordinates (u*q, v*q, 0, q); 2-component inputs get q = 1\n"
     "    v_texCoord = a_texCoord;\n"
+    "#ifdef EDGE_BLEND\n"
+    "    // Same projective q, texcoord range mapped back onto the quad's unit square\n"
+    "    v_blendCoord = vec4(a_texCoord.xy * u_blendXform.xy + a_texCoord.w * u_blendXform.zw, 0.0, a_texCoord.w);\n"
+    "#endif\n"
     "}\n";
 
 static const char* g_fragment_shader_src = 
     "precision mediump float;\n"
-    "varying vec2 v_texCoord;\n"
+    "varying vec4 v_texCoord;\n"
     "uniform sampler2D u_texture;\n"
+    "#ifdef EDGE_BLEND\n"
+    "varying vec4 v_blendCoord;\n"
+    "uniform sampler2D u_blend;\n"
+    "#endif\n"
     "void main() {\n"
-    "    gl_FragColor = texture2D(u_texture, v_texCoord);\n"
+    "    gl_FragColor = texture2DProj(u_texture, v_texCoord);\n"
+    "#ifdef EDGE_BLEND\n"
+    "    // Falloff is precomputed (gamma included): one fetch and one multiply\n"
+    "    gl_FragColor.rgb *= texture2DProj(u_blend, v_blendCoord).r;\n"
+    "#endif\n"
     "}\n";
 
-// Border shader: positions only, uniform color
-static const char* g_border_vs_src =
+// GL state shadow (render thread). Draw paths set the program, texture bindings and
+// blending through these so unchanged state costs no GL call; anything that changes that
+// state behind their back (mpv renders, texture creation or deletion) must call
+// gl_state_invalidate() afterwards. Blending is always SRC_ALPHA / ONE_MINUS_SRC_ALPHA.
+#define GL_SHADOW_UNITS 16
+#define GL_SHADOW_UNKNOWN 0xffffffffu
+static struct {
+	GLuint program;
+	GLuint unit;                          // Active texture unit index
+	GLuint tex[GL_SHADOW_UNITS];          // GL_TEXTURE_2D binding per unit
+	int blend;                            // -1 unknown, 0 disabled, 1 enabled
+	bool blend_func;                      // glBlendFunc known to be SRC_ALPHA / ONE_MINUS_SRC_ALPHA
+} g_gl = { GL_SHADOW_UNKNOWN, GL_SHADOW_UNKNOWN, {0}, -1, false };
+
+// Forget all shadowed state; the next gl_* call re-issues it
+static void gl_state_invalidate(void) {
+	g_gl.program = GL_SHADOW_UNKNOWN;
+	g_gl.unit = GL_SHADOW_UNKNOWN;
+	for (int i = 0; i < GL_SHADOW_UNITS; i++) g_gl.tex[i] = GL_SHADOW_UNKNOWN;
+	g_gl.blend = -1;
+	g_gl.blend_func = false;
+}
+
+static void gl_use_program(GLuint program) {
+	if (g_gl.program == program) return;
+	glUseProgram(program);
+	g_gl.program = program;
+}
+
+// Bind tex to GL_TEXTURE_2D on texture unit `unit` (leaves that unit active)
+static void gl_bind_texture(GLuint unit, GLuint tex) {
+	if (g_gl.unit != unit) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		g_gl.unit = unit;
+	}
+	if (unit < GL_SHADOW_UNITS && g_gl.tex[unit] == tex) return;
+	glBindTexture(GL_TEXTURE_2D, tex);
+	if (unit < GL_SHADOW_UNITS) g_gl.tex[unit] = tex;
+}
+
+static void gl_set_blend(bool on) {
+	if (on) {
+		if (g_gl.blend != 1) { glEnable(GL_BLEND); g_gl.blend = 1; }
+		if (!g_gl.blend_func) { glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); g_gl.blend_func = true; }
+	} else if (g_gl.blend != 0) {
+		glDisable(GL_BLEND);
+		g_gl.blend = 0;
+	}
+}
+
+// Forward declarations for the shader compiler and program cache (defined below)
+static GLuint compile_shader(GLenum shader_type, const char* source);
+static GLuint gl_program_build(const char *name, const char *vs_src, const char *fs_src,
+                               const char *const *attribs, const GLint *binds);
+
+// Overlay pass: keystone borders and corner/mesh markers of every instance go into one
+// VBO and out in a single draw call, whatever the number of instances. Each quad carries
+// its colour and a local coordinate; the fragment shader antialiases the quad edges from
+// their pixel distance, so borders are thick quads rather than glLineWidth lines (which
+// most GLES2 drivers clamp to 1) and markers need no per-quad scissored clears.
+#define OVERLAY_VERTEX_FLOATS 10     // x, y, r, g, b, a, local x, local y, half width px, half height px
+#define OVERLAY_MAX_QUADS (MAX_VIDEOS * 8 + 4 + KEYSTONE_MESH_MAX * KEYSTONE_MESH_MAX)
+
+static const char* g_overlay_vs_src =
 	"attribute vec2 a_position;\n"
+	"attribute vec4 a_color;\n"
+	"attribute vec4 a_local;\n"
+	"varying vec4 v_color;\n"
+	"varying vec4 v_local;\n"
 	"void main(){\n"
 	"  gl_Position = vec4(a_position, 0.0, 1.0);\n"
+	"#ifdef SCANOUT_Y_FLIP\n"
+	"  gl_Position.y = -gl_Position.y;\n"
+	"#endif\n"
+	"  v_color = a_color;\n"
+	"  v_local = a_local;\n"
 	"}\n";
 
-static const char* g_border_fs_src =
+static const char* g_overlay_fs_src =
 	"precision mediump float;\n"
-	"uniform vec4 u_color;\n"
+	"varying vec4 v_color;\n"
+	"varying vec4 v_local;\n"
 	"void main(){\n"
-	"  gl_FragColor = u_color;\n"
+	"  // Pixels to the nearest quad edge (xy in -1..1 across the quad, zw its half size)\n"
+	"  vec2 d = (1.0 - abs(v_local.xy)) * v_local.zw;\n"
+	"  gl_FragColor = vec4(v_color.rgb, v_color.a * clamp(min(d.x, d.y) + 0.5, 0.0, 1.0));\n"
 	"}\n";
 
-// Forward declaration for shader compiler utility
-static GLuint compile_shader(GLenum shader_type, const char* source);
+static GLuint g_overlay_program = 0;
+static GLuint g_overlay_vbo = 0;             // OVERLAY_MAX_QUADS x 4 vertices
+static GLuint g_overlay_ibo = 0;             // 6 indices per quad
+static GLint g_overlay_a_position_loc = -1;
+static GLint g_overlay_a_color_loc = -1;
+static GLint g_overlay_a_local_loc = -1;
+static bool g_overlay_failed = false;        // Shader unavailable: no border or markers
+static float g_overlay_verts[OVERLAY_MAX_QUADS * 4 * OVERLAY_VERTEX_FLOATS];
+static int g_overlay_uploaded = -1;          // Quads in the VBO (-1 = VBO content unknown)
+
+// Inactive corner colours per keystone (video 1 green, video 2 blue, ...)
+static const float g_instance_marker_colors[][3] = {
+	{0.0f, 0.7f, 0.0f}, {0.0f, 0.4f, 0.8f}, {0.8f, 0.3f, 0.0f},
+	{0.7f, 0.0f, 0.7f}, {0.0f, 0.7f, 0.7f}, {0.8f, 0.0f, 0.3f},
+	{0.5f, 0.5f, 0.0f}, {0.3f, 0.3f, 0.9f}, {0.7f, 0.7f, 0.7f},
+};
 
-static bool init_border_shader() {
-	g_border_vertex_shader = compile_shader(GL_VERTEX_SHADER, g_border_vs_src);
-	if (!g_border_vertex_shader) return false;
-	g_border_fragment_shader = compile_shader(GL_FRAGMENT_SHADER, g_border_fs_src);
-	if (!g_border_fragment_shader) { glDeleteShader(g_border_vertex_shader); g_border_vertex_shader = 0; return false; }
-	g_border_shader_program = glCreateProgram();
-	if (!g_border_shader_program) { glDeleteShader(g_border_vertex_shader); glDeleteShader(g_border_fragment_shader); return false; }
-	glAttachShader(g_border_shader_program, g_border_vertex_shader);
-	glAttachShader(g_border_shader_program, g_border_fragment_shader);
-	glLinkProgram(g_border_shader_program);
-	GLint linked = 0; glGetProgramiv(g_border_shader_program, GL_LINK_STATUS, &linked);
-	if (!linked) {
-		GLint info_len=0; glGetProgramiv(g_border_shader_program, GL_INFO_LOG_LENGTH, &info_len);
-		if (info_len>1) { char* buf = malloc((size_t)info_len); glGetProgramInfoLog(g_border_shader_program, info_len, NULL, buf); LOG_ERROR("Border shader link: %s", buf); free(buf);}        
-		glDeleteProgram(g_border_shader_program); g_border_shader_program=0;
-		glDeleteShader(g_border_vertex_shader); g_border_vertex_shader=0;
-		glDeleteShader(g_border_fragment_shader); g_border_fragment_shader=0;
-		return false;
+static bool init_overlay_shader(void) {
+	g_overlay_program = gl_program_build("overlay", g_overlay_vs_src, g_overlay_fs_src, NULL, NULL);
+	if (!g_overlay_program) return false;
+	g_overlay_a_position_loc = glGetAttribLocation(g_overlay_program, "a_position");
+	g_overlay_a_color_loc = glGetAttribLocation(g_overlay_program, "a_color");
+	g_overlay_a_local_loc = glGetAttribLocation(g_overlay_program, "a_local");
+
+	static GLushort indices[OVERLAY_MAX_QUADS * 6];
+	for (int q = 0; q < OVERLAY_MAX_QUADS; q++) {
+		const GLushort quad[6] = {0, 1, 2, 2, 1, 3};
+		for (int k = 0; k < 6; k++) indices[q*6 + k] = (GLushort)(q*4 + quad[k]);
 	}
-	g_border_a_position_loc = glGetAttribLocation(g_border_shader_program, "a_position");
-	g_border_u_color_loc = glGetUniformLocation(g_border_shader_program, "u_color");
+	glGenBuffers(1, &g_overlay_ibo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_overlay_ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glGenBuffers(1, &g_overlay_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, g_overlay_vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(g_overlay_verts), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	g_overlay_uploaded = -1;
 	return true;
 }
 
+static void overlay_destroy(void) {
+	if (g_overlay_program) { glDeleteProgram(g_overlay_program); g_overlay_program = 0; }
+	if (g_overlay_vbo) { glDeleteBuffers(1, &g_overlay_vbo); g_overlay_vbo = 0; }
+	if (g_overlay_ibo) { glDeleteBuffers(1, &g_overlay_ibo); g_overlay_ibo = 0; }
+	g_overlay_failed = false;
+}
+
+// Overlay geometry under construction: pixel coordinates, origin top-left
+typedef struct {
+	int quads;
+	float w, h;                  // Screen size in pixels
+} overlay_build_t;
+
+/**
+ * Append a quad centred at (cx, cy) with half-extent vectors ax (local x) and ay (local y), in pixels
+ */
+static void overlay_push_quad(overlay_build_t *b, float cx, float cy, const float ax[2], const float ay[2], const float rgba[4]) {
+	if (b->quads >= OVERLAY_MAX_QUADS) return;
+	float hx = sqrtf(ax[0] * ax[0] + ax[1] * ax[1]), hy = sqrtf(ay[0] * ay[0] + ay[1] * ay[1]);
+	float *v = &g_overlay_verts[(size_t)b->quads * 4 * OVERLAY_VERTEX_FLOATS];
+	const float sx[4] = {-1.0f, 1.0f, -1.0f, 1.0f}, sy[4] = {-1.0f, -1.0f, 1.0f, 1.0f}; // TL, TR, BL, BR
+	for (int i = 0; i < 4; i++, v += OVERLAY_VERTEX_FLOATS) {
+		float px = cx + sx[i] * ax[0] + sy[i] * ay[0];
+		float py = cy + sx[i] * ax[1] + sy[i] * ay[1];
+		v[0] = px / b->w * 2.0f - 1.0f;
+		v[1] = 1.0f - py / b->h * 2.0f;
+		memcpy(&v[2], rgba, 4 * sizeof(float));
+		v[6] = sx[i]; v[7] = sy[i]; v[8] = hx; v[9] = hy;
+	}
+	b->quads++;
+}
+
+// Square marker of size px at a normalized point, kept fully on screen
+static void overlay_push_marker(overlay_build_t *b, float nx, float ny, float size, const float rgba[4]) {
+	float x = nx * b->w - size * 0.5f, y = ny * b->h - size * 0.5f;
+	if (x < 0.0f) x = 0.0f; else if (x > b->w - size) x = b->w - size;
+	if (y < 0.0f) y = 0.0f; else if (y > b->h - size) y = b->h - size;
+	const float ax[2] = {size * 0.5f, 0.0f}, ay[2] = {0.0f, size * 0.5f};
+	overlay_push_quad(b, x + size * 0.5f, y + size * 0.5f, ax, ay, rgba);
+}
+
+// Outline of a keystone quad as four thick edges (square caps close the corners)
+static void overlay_push_border(overlay_build_t *b, const keystone_t *ks, float width, const float rgba[4]) {
+	for (int i = 0; i < 4; i++) {
+		const float *p = ks->points[i], *q = ks->points[(i + 1) % 4];
+		float px = p[0] * b->w, py = p[1] * b->h, qx = q[0] * b->w, qy = q[1] * b->h;
+		float dx = qx - px, dy = qy - py, len = sqrtf(dx * dx + dy * dy);
+		if (len < 1e-3f) continue;
+		dx /= len; dy /= len;
+		float half = width * 0.5f;
+		const float ax[2] = {dx * (len * 0.5f + half), dy * (len * 0.5f + half)};
+		const float ay[2] = {-dy * half, dx * half};
+		overlay_push_quad(b, (px + qx) * 0.5f, (py + qy) * 0.5f, ax, ay, rgba);
+	}
+}
+
+/**
+ * Draw the border and corner markers of every keystone in the current snapshot with
+ * one draw call over the composed frame (scanout framebuffer bound, full viewport)
+ */
+static void overlay_draw(int screen_w, int screen_h) {
+	render_snapshot_t *rs = g_rs;
+	overlay_build_t b = { 0, (float)screen_w, (float)screen_h };
+	const float yellow[4] = {1.0f, 1.0f, 0.0f, 1.0f}, red[4] = {1.0f, 0.0f, 0.0f, 1.0f}, green[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+	if (g_num_videos > 1) {
+		for (int i = 0; i < g_num_videos; i++) {
+			const keystone_t *ks = &rs->video[i].ks;
+			if (rs->show_border) overlay_push_border(&b, ks, (float)rs->border_width, yellow);
+			if (!rs->show_corner_markers) continue;
+			const float *rgb = g_instance_marker_colors[i % (int)(sizeof(g_instance_marker_colors) / sizeof(g_instance_marker_colors[0]))];
+			const float inactive[4] = {rgb[0], rgb[1], rgb[2], 1.0f};
+			for (int c = 0; c < 4; c++)
+				overlay_push_marker(&b, ks->points[c][0], ks->points[c][1], 12.0f, c == ks->active_corner ? yellow : inactive);
+		}
+	} else {
+		const keystone_t *ks = &rs->main.ks;
+		if (rs->show_border) overlay_push_border(&b, ks, (float)rs->border_width, yellow);
+		if (ks->enabled && rs->show_corner_markers) {
+			if (ks->mesh_enabled && ks->mesh_x) {
+				// Mesh mode: mark every control point instead of the four corners
+				for (int r = 0; r < ks->mesh_size; r++) {
+					for (int c = 0; c < ks->mesh_size; c++) {
+						bool active = (r == ks->active_mesh_point[0] && c == ks->active_mesh_point[1]);
+						overlay_push_marker(&b, ks->mesh_x[r * ks->mesh_size + c], ks->mesh_y[r * ks->mesh_size + c], 6.0f,
+						                    active ? red : green);
+					}
+				}
+			} else {
+				for (int c = 0; c < 4; c++)
+					overlay_push_marker(&b, ks->points[c][0], ks->points[c][1], 10.0f, c == ks->active_corner ? red : green);
+			}
+		}
+	}
+	if (b.quads == 0) return;
+	if (!g_overlay_program) {
+		if (g_overlay_failed) return;
+		if (!init_overlay_shader()) {
+			LOG_WARN("Failed to initialize overlay shader; border and markers will be disabled");
+			g_overlay_failed = true;
+			return;
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, g_overlay_vbo);
+	// Re-uploaded only when a marker or border moved (the common case is a static overlay)
+	static float uploaded[OVERLAY_MAX_QUADS * 4 * OVERLAY_VERTEX_FLOATS];
+	size_t bytes = (size_t)b.quads * 4 * OVERLAY_VERTEX_FLOATS * sizeof(float);
+	if (g_overlay_uploaded != b.quads || memcmp(uploaded, g_overlay_verts, bytes) != 0) {
+		glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)bytes, g_overlay_verts);
+		memcpy(uploaded, g_overlay_verts, bytes);
+		g_overlay_uploaded = b.quads;
+	}
+	gl_set_blend(true);
+	gl_use_program(g_overlay_program);
+	GLsizei stride = (GLsizei)(OVERLAY_VERTEX_FLOATS * sizeof(float));
+	glEnableVertexAttribArray((GLuint)g_overlay_a_position_loc);
+	glVertexAttribPointer((GLuint)g_overlay_a_position_loc, 2, GL_FLOAT, GL_FALSE, stride, (const void *)0);
+	glEnableVertexAttribArray((GLuint)g_overlay_a_color_loc);
+	glVertexAttribPointer((GLuint)g_overlay_a_color_loc, 4, GL_FLOAT, GL_FALSE, stride, (const void *)(2 * sizeof(float)));
+	glEnableVertexAttribArray((GLuint)g_overlay_a_local_loc);
+	glVertexAttribPointer((GLuint)g_overlay_a_local_loc, 4, GL_FLOAT, GL_FALSE, stride, (const void *)(6 * sizeof(float)));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_overlay_ibo);
+	glDrawElements(GL_TRIANGLES, b.quads * 6, GL_UNSIGNED_SHORT, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glDisableVertexAttribArray((GLuint)g_overlay_a_position_loc);
+	glDisableVertexAttribArray((GLuint)g_overlay_a_color_loc);
+	glDisableVertexAttribArray((GLuint)g_overlay_a_local_loc);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 // Compile shader of the specified type
 static GLuint compile_shader(GLenum shader_type, const char* source) {
     GLuint shader = glCreateShader(shader_type);
@@ -2098,7 +5330,10 @@ static GLuint compile_shader(GLenum shader_type, const char* source) {
         return 0;
     }
     
-    glShaderSource(shader, 1, &source, NULL);
+    // Vertex stages flip Y when composing into the scanout ring (see g_scanout_y_flip)
+    const char *sources[2] = { "", source };
+    if (shader_type == GL_VERTEX_SHADER && g_scanout_y_flip) sources[0] = "#define SCANOUT_Y_FLIP\n";
+    glShaderSource(shader, 2, sources, NULL);
     glCompileShader(shader);
     
     GLint compiled;
@@ -2119,59 +5354,197 @@ static GLuint compile_shader(GLenum shader_type, const char* source) {
     return shader;
 }
 
+// Program binary cache: linked programs are stored under $XDG_CACHE_HOME/pickle (or
+// ~/.cache/pickle) through GL_OES_get_program_binary and loaded back with no GLSL
+// compile or link. Each file is keyed by the driver (GL_RENDERER, GL_VERSION), the
+// sources and the attribute bindings; a driver update or any shader edit changes the
+// key and the program is rebuilt and re-saved. PICKLE_SHADER_CACHE=0 disables it.
+#define PROGCACHE_MAGIC 0x47525050u   // "PPRG" read as a little-endian u32
+typedef struct {
+	uint32_t magic;
+	uint32_t key;            // FNV-1a over driver strings, sources and attribute bindings
+	uint32_t format;         // Binary format from glGetProgramBinaryOES
+	uint32_t length;         // Binary bytes following the header
+	uint32_t checksum;       // FNV-1a over the binary
+} progcache_header_t;
+
+static struct {
+	int state;               // 0 = not probed, 1 = enabled, -1 = unavailable or disabled
+	uint32_t driver;         // Hash of GL_RENDERER and GL_VERSION
+	char dir[512];
+	PFNGLGETPROGRAMBINARYOESPROC get_binary;
+	PFNGLPROGRAMBINARYOESPROC load_binary;
+} g_progcache;
+static int g_progcache_hits = 0;
+static int g_progcache_builds = 0;
+
+// mkdir that tolerates an existing directory
+static bool progcache_mkdir(const char *path) {
+	return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+// Probe the extension and the cache directory once (needs the GL context current)
+static void progcache_init(void) {
+	if (g_progcache.state) return;
+	g_progcache.state = -1;
+	const char *e = getenv("PICKLE_SHADER_CACHE");
+	if (e && *e && strcmp(e, "0") == 0) { LOG_GL("Program binary cache disabled (PICKLE_SHADER_CACHE=0)"); return; }
+	const char *gl_exts = (const char *)glGetString(GL_EXTENSIONS);
+	GLint formats = 0;
+	if (gl_exts && strstr(gl_exts, "GL_OES_get_program_binary")) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+	if (formats <= 0) { LOG_GL("Program binary cache unavailable (no GL_OES_get_program_binary formats)"); return; }
+	g_progcache.get_binary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+	g_progcache.load_binary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+	if (!g_progcache.get_binary || !g_progcache.load_binary) return;
+
+	const char *xdg = getenv("XDG_CACHE_HOME"), *home = getenv("HOME");
+	if (xdg && *xdg) {
+		if (!progcache_mkdir(xdg)) return;
+		snprintf(g_progcache.dir, sizeof(g_progcache.dir), "%s/pickle", xdg);
+	} else if (home && *home) {
+		snprintf(g_progcache.dir, sizeof(g_progcache.dir), "%s/.cache", home);
+		if (!progcache_mkdir(g_progcache.dir)) return;
+		snprintf(g_progcache.dir, sizeof(g_progcache.dir), "%s/.cache/pickle", home);
+	} else {
+		return;
+	}
+	if (!progcache_mkdir(g_progcache.dir)) {
+		LOG_WARN("Program binary cache: cannot create %s (%s)", g_progcache.dir, strerror(errno));
+		return;
+	}
+	const char *renderer = (const char *)glGetString(GL_RENDERER), *version = (const char *)glGetString(GL_VERSION);
+	uint32_t h = fnv1a32(2166136261u, renderer ? renderer : "", renderer ? strlen(renderer) + 1 : 1);
+	g_progcache.driver = fnv1a32(h, version ? version : "", version ? strlen(version) + 1 : 1);
+	g_progcache.state = 1;
+	LOG_GL("Program binary cache: %s (%d formats)", g_progcache.dir, formats);
+}
+
+// Cached program for key, or 0 on a miss, a stale file or a binary the driver rejects
+static GLuint progcache_load(const char *path, uint32_t key) {
+	FILE *f = fopen(path, "rb");
+	if (!f) return 0;
+	progcache_header_t h;
+	void *bin = NULL;
+	GLuint prog = 0;
+	if (fread(&h, sizeof(h), 1, f) == 1 && h.magic == PROGCACHE_MAGIC && h.key == key &&
+	    h.length > 0 && h.length <= (64u << 20) && (bin = malloc(h.length)) != NULL &&
+	    fread(bin, 1, h.length, f) == h.length && kcal_checksum(bin, h.length) == h.checksum) {
+		prog = glCreateProgram();
+		g_progcache.load_binary(prog, (GLenum)h.format, bin, (GLint)h.length);
+		GLint linked = 0;
+		glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+		if (!linked) { glDeleteProgram(prog); prog = 0; }
+	}
+	free(bin);
+	fclose(f);
+	return prog;
+}
+
+static void progcache_save(const char *path, uint32_t key, GLuint prog) {
+	GLint len = 0;
+	glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH_OES, &len);
+	if (len <= 0) return;
+	unsigned char *buf = malloc(sizeof(progcache_header_t) + (size_t)len);
+	if (!buf) return;
+	progcache_header_t h = { PROGCACHE_MAGIC, key, 0, 0, 0 };
+	GLenum format = 0;
+	GLsizei got = 0;
+	g_progcache.get_binary(prog, len, &got, &format, buf + sizeof(h));
+	if (got > 0) {
+		h.format = (uint32_t)format;
+		h.length = (uint32_t)got;
+		h.checksum = kcal_checksum(buf + sizeof(h), (size_t)got);
+		memcpy(buf, &h, sizeof(h));
+		char tmp[620];
+		FILE *f = atomic_file_open(path, tmp, sizeof(tmp));
+		size_t total = sizeof(h) + (size_t)got;
+		bool ok = f && fwrite(buf, 1, total, f) == total;
+		if (f) ok = atomic_file_commit(f, tmp, path) && ok;
+		if (!ok) LOG_WARN("Program binary cache: failed to save %s", path);
+	}
+	free(buf);
+}
+
+/**
+ * Build a GL program from vertex and fragment sources, loading it from the program
+ * binary cache when possible and saving it there after a fresh compile and link
+ *
+ * @param name Cache file stem ("keystone", "blend", ...); one file per program
+ * @param vs_src Vertex shader source (compile_shader() adds the scanout define)
+ * @param fs_src Fragment shader source
+ * @param attribs NULL-terminated attribute names to bind before linking, or NULL
+ * @param binds Locations for attribs
+ * @return Linked program, or 0 on failure
+ */
+static GLuint gl_program_build(const char *name, const char *vs_src, const char *fs_src,
+                               const char *const *attribs, const GLint *binds) {
+	progcache_init();
+	int64_t t0 = mono_now_us();
+	char path[600] = "";
+	uint32_t key = 0;
+	if (g_progcache.state > 0) {
+		const unsigned char flip = (unsigned char)g_scanout_y_flip;
+		key = fnv1a32(g_progcache.driver, vs_src, strlen(vs_src) + 1);
+		key = fnv1a32(key, fs_src, strlen(fs_src) + 1);
+		key = fnv1a32(key, &flip, 1);
+		for (int i = 0; attribs && attribs[i]; i++) {
+			key = fnv1a32(key, attribs[i], strlen(attribs[i]) + 1);
+			key = fnv1a32(key, &binds[i], sizeof(binds[i]));
+		}
+		snprintf(path, sizeof(path), "%s/%s.bin", g_progcache.dir, name);
+		GLuint prog = progcache_load(path, key);
+		if (prog) {
+			g_progcache_hits++;
+			LOG_GL("Program %s loaded from cache in %.2f ms", name, (double)(mono_now_us() - t0) / 1000.0);
+			return prog;
+		}
+	}
+
+	GLuint vs = compile_shader(GL_VERTEX_SHADER, vs_src);
+	if (!vs) return 0;
+	GLuint fs = compile_shader(GL_FRAGMENT_SHADER, fs_src);
+	if (!fs) { glDeleteShader(vs); return 0; }
+	GLuint prog = glCreateProgram();
+	if (prog) {
+		glAttachShader(prog, vs);
+		glAttachShader(prog, fs);
+		for (int i = 0; attribs && attribs[i]; i++) glBindAttribLocation(prog, (GLuint)binds[i], attribs[i]);
+		glLinkProgram(prog);
+		GLint linked = 0;
+		glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+		if (!linked) {
+			GLint info_len = 0;
+			glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &info_len);
+			if (info_len > 1) {
+				char *info_log = malloc((size_t)info_len);
+				if (info_log) {
+					glGetProgramInfoLog(prog, info_len, NULL, info_log);
+					LOG_ERROR("Error linking %s program: %s", name, info_log);
+					free(info_log);
+				}
+			}
+			glDeleteProgram(prog);
+			prog = 0;
+		} else {
+			// The linked program keeps the code; the shader objects are not needed again
+			glDetachShader(prog, vs);
+			glDetachShader(prog, fs);
+		}
+	}
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+	if (!prog) return 0;
+	g_progcache_builds++;
+	if (g_progcache.state > 0) progcache_save(path, key, prog);
+	LOG_GL("Program %s compiled in %.2f ms", name, (double)(mono_now_us() - t0) / 1000.0);
+	return prog;
+}
+
 // Initialize keystone shader program
 static bool init_keystone_shader() {
-    // Compile vertex shader
-    g_keystone_vertex_shader = compile_shader(GL_VERTEX_SHADER, g_vertex_shader_src);
-    if (!g_keystone_vertex_shader) {
-        LOG_ERROR("Failed to compile vertex shader");
-        return false;
-    }
-    
-    // Compile fragment shader
-    g_keystone_fragment_shader = compile_shader(GL_FRAGMENT_SHADER, g_fragment_shader_src);
-    if (!g_keystone_fragment_shader) {
-        LOG_ERROR("Failed to compile fragment shader");
-        glDeleteShader(g_keystone_vertex_shader);
-        g_keystone_vertex_shader = 0;
-        return false;
-    }
-    
-    // Create shader program
-    g_keystone_shader_program = glCreateProgram();
+    g_keystone_shader_program = gl_program_build("keystone", g_vertex_shader_src, g_fragment_shader_src, NULL, NULL);
     if (!g_keystone_shader_program) {
-        LOG_ERROR("Failed to create shader program");
-        glDeleteShader(g_keystone_vertex_shader);
-        glDeleteShader(g_keystone_fragment_shader);
-        g_keystone_vertex_shader = 0;
-        g_keystone_fragment_shader = 0;
-        return false;
-    }
-    
-    // Attach shaders
-    glAttachShader(g_keystone_shader_program, g_keystone_vertex_shader);
-    glAttachShader(g_keystone_shader_program, g_keystone_fragment_shader);
-    
-    // Link program
-    glLinkProgram(g_keystone_shader_program);
-    
-    GLint linked;
-    glGetProgramiv(g_keystone_shader_program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint info_len = 0;
-        glGetProgramiv(g_keystone_shader_program, GL_INFO_LOG_LENGTH, &info_len);
-        if (info_len > 1) {
-			char* info_log = malloc(sizeof(char) * (size_t)info_len);
-            glGetProgramInfoLog(g_keystone_shader_program, info_len, NULL, info_log);
-            LOG_ERROR("Error linking shader program: %s", info_log);
-            free(info_log);
-        }
-        glDeleteProgram(g_keystone_shader_program);
-        glDeleteShader(g_keystone_vertex_shader);
-        glDeleteShader(g_keystone_fragment_shader);
-        g_keystone_shader_program = 0;
-        g_keystone_vertex_shader = 0;
-        g_keystone_fragment_shader = 0;
+        LOG_ERROR("Failed to build keystone shader program");
         return false;
     }
     
@@ -2179,80 +5552,571 @@ static bool init_keystone_shader() {
     g_keystone_a_position_loc = glGetAttribLocation(g_keystone_shader_program, "a_position");
     g_keystone_a_texcoord_loc = glGetAttribLocation(g_keystone_shader_program, "a_texCoord");
     g_keystone_u_texture_loc = glGetUniformLocation(g_keystone_shader_program, "u_texture");
+    gl_use_program(g_keystone_shader_program);
+    glUniform1i(g_keystone_u_texture_loc, 0);
     
-    // Create vertex buffer for the quad
-    glGenBuffers(1, &g_keystone_vertex_buffer);
+    // Vertex array objects let the steady-state quad draw be one bind + one draw call
+    const char *gl_exts = (const char *)glGetString(GL_EXTENSIONS);
+    if (gl_exts && strstr(gl_exts, "GL_OES_vertex_array_object")) {
+        g_gl_gen_vertex_arrays = (PFNGLGENVERTEXARRAYSOESPROC)eglGetProcAddress("glGenVertexArraysOES");
+        g_gl_bind_vertex_array = (PFNGLBINDVERTEXARRAYOESPROC)eglGetProcAddress("glBindVertexArrayOES");
+        g_gl_delete_vertex_arrays = (PFNGLDELETEVERTEXARRAYSOESPROC)eglGetProcAddress("glDeleteVertexArraysOES");
+        if (!g_gl_gen_vertex_arrays || !g_gl_bind_vertex_array || !g_gl_delete_vertex_arrays) {
+            g_gl_gen_vertex_arrays = NULL;
+            g_gl_bind_vertex_array = NULL;
+            g_gl_delete_vertex_arrays = NULL;
+        }
+    }
+    LOG_GL("OES_vertex_array_object %s", g_gl_bind_vertex_array ? "available" : "missing");
+    if (gl_exts && strstr(gl_exts, "GL_OES_mapbuffer")) {
+        g_gl_map_buffer = (PFNGLMAPBUFFEROESPROC)eglGetProcAddress("glMapBufferOES");
+        g_gl_unmap_buffer = (PFNGLUNMAPBUFFEROESPROC)eglGetProcAddress("glUnmapBufferOES");
+        if (!g_gl_map_buffer || !g_gl_unmap_buffer) {
+            g_gl_map_buffer = NULL;
+            g_gl_unmap_buffer = NULL;
+        }
+    }
+    LOG_GL("OES_mapbuffer %s", g_gl_map_buffer ? "available" : "missing");
     
     LOG_INFO("Keystone shader program initialized successfully");
     return true;
 }
 
-// Free allocated mesh resources
-static void cleanup_mesh_resources(void) {
-    if (g_keystone.mesh_points) {
-        for (int i = 0; i < g_keystone.mesh_size; i++) {
-            if (g_keystone.mesh_points[i]) {
-                free(g_keystone.mesh_points[i]);
-            }
+// Tessellated vertices per side for an n x n control mesh (16-bit indices stay addressable)
+static int mesh_grid_for(int n) {
+    int subdiv = g_mesh_subdiv;
+    while (subdiv > 1 && ((n - 1) * subdiv + 1) * ((n - 1) * subdiv + 1) > 65535) subdiv--;
+    return (n - 1) * subdiv + 1;
+}
+
+/**
+ * Tessellate the control mesh into interleaved x,y,u,v vertices (clip space)
+ *
+ * @param ks Keystone with a mesh (mesh_x/mesh_y)
+ * @param u0,u1,v0,v1 Texture coordinates at the left/right/top/bottom edges
+ * @param out grid*grid*WARP_VERTEX_FLOATS floats for mesh_grid_for(mesh_size), or NULL to allocate
+ * @param grid_out Receives the vertices per side
+ * @return out, a malloc'd array when out was NULL, or NULL on allocation failure
+ */
+static float *mesh_tessellate(const keystone_t *ks, float u0, float u1, float v0, float v1, float *out, int *grid_out) {
+    int n = ks->mesh_size;
+    int grid = mesh_grid_for(n);
+    int subdiv = (grid - 1) / (n - 1);
+    size_t vcount = (size_t)grid * (size_t)grid;
+    const float tex[4] = { u0, u1, v0, v1 };
+
+    float *verts = out ? out : malloc(vcount * WARP_VERTEX_FLOATS * sizeof(float));
+    float *scratch = malloc(warp_mesh_scratch_floats(n, subdiv) * sizeof(float));
+    if (!verts || !scratch) {
+        if (!out) free(verts);
+        free(scratch);
+        return NULL;
+    }
+    warp_mesh_grid(ks->mesh_x, ks->mesh_y, n, subdiv, tex, scratch, verts);
+    free(scratch);
+    *grid_out = grid;
+    return verts;
+}
+
+// Index topology only depends on the grid size
+static bool mesh_geom_build_indices(mesh_geom_t *m, int grid) {
+    if (m->ibo != 0 && m->grid == grid) return true;
+    size_t icount = (size_t)(grid - 1) * (size_t)(grid - 1) * 6;
+    GLushort *idx = malloc(icount * sizeof(GLushort));
+    if (!idx) return false;
+    size_t k = 0;
+    for (int gi = 0; gi < grid - 1; gi++) {
+        for (int gj = 0; gj < grid - 1; gj++) {
+            GLushort tl = (GLushort)(gi * grid + gj), tr = (GLushort)(tl + 1);
+            GLushort bl = (GLushort)(tl + grid), br = (GLushort)(bl + 1);
+            idx[k++] = tl; idx[k++] = tr; idx[k++] = bl;
+            idx[k++] = bl; idx[k++] = tr; idx[k++] = br;
         }
-        free(g_keystone.mesh_points);
-        g_keystone.mesh_points = NULL;
     }
+    if (m->ibo == 0) glGenBuffers(1, &m->ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(icount * sizeof(GLushort)), idx, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    free(idx);
+    m->index_count = (GLsizei)icount;
+    m->grid = grid;
+    return true;
 }
 
-// Cleanup keystone shader resources
-static void cleanup_keystone_shader(void) {
-    if (g_keystone_vertex_buffer) {
-        glDeleteBuffers(1, &g_keystone_vertex_buffer);
-        g_keystone_vertex_buffer = 0;
+/**
+ * Rebuild mesh-warp geometry if the control points or texcoord range changed
+ *
+ * @param m Geometry cache
+ * @param ks Keystone whose mesh_x/mesh_y drive the warp
+ * @param u0,u1,v0,v1 Texture coordinates at the left/right/top/bottom edges
+ * @return true if drawable geometry is available
+ */
+static bool mesh_geom_update(mesh_geom_t *m, const keystone_t *ks, float u0, float u1, float v0, float v1) {
+    int n = ks->mesh_size;
+    if (n < 2 || !ks->mesh_x) return false;
+
+    size_t plane = (size_t)n * (size_t)n;
+    size_t plane_bytes = plane * sizeof(float);
+    bool changed = (m->src_size != n) || !m->src_points || m->vbo == 0 ||
+                   m->tex[0] != u0 || m->tex[1] != u1 || m->tex[2] != v0 || m->tex[3] != v1 ||
+                   memcmp(m->src_points, ks->mesh_x, plane_bytes) != 0 ||
+                   memcmp(m->src_points + plane, ks->mesh_y, plane_bytes) != 0;
+    if (!changed) return true;
+
+    int64_t t0 = mono_now_us();
+    int grid = mesh_grid_for(n);
+    // Indices first: a failure here must not leave new vertices behind old topology
+    int prev_grid = m->grid;
+    if (!mesh_geom_build_indices(m, grid)) return false;
+    GLsizeiptr vbo_bytes = (GLsizeiptr)((size_t)grid * (size_t)grid * WARP_VERTEX_FLOATS * sizeof(float));
+    if (m->vbo == 0) glGenBuffers(1, &m->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
+    bool built = false;
+    if (g_gl_map_buffer) {
+        // Orphan the old storage so the driver never waits on a frame still drawing from it,
+        // then tessellate straight into the mapping (no staging copy)
+        glBufferData(GL_ARRAY_BUFFER, vbo_bytes, NULL, GL_STATIC_DRAW);
+        float *mapped = g_gl_map_buffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY_OES);
+        if (mapped) {
+            built = mesh_tessellate(ks, u0, u1, v0, v1, mapped, &grid) != NULL;
+            // A lost mapping (GL_FALSE) leaves undefined contents: fall back to an upload
+            if (!g_gl_unmap_buffer(GL_ARRAY_BUFFER)) built = false;
+        }
+    }
+    if (!built) {
+        float *verts = mesh_tessellate(ks, u0, u1, v0, v1, NULL, &grid);
+        if (!verts) {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            // The old vertices still match unless the grid changed or the storage was orphaned
+            return prev_grid == grid && !g_gl_map_buffer;
+        }
+        glBufferData(GL_ARRAY_BUFFER, vbo_bytes, verts, GL_STATIC_DRAW);
+        free(verts);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Remember what we built from
+    if (m->src_size != n || !m->src_points) {
+        free(m->src_points);
+        m->src_points = malloc(2 * plane_bytes);
+        m->src_size = m->src_points ? n : 0;
+    }
+    if (m->src_points) {
+        memcpy(m->src_points, ks->mesh_x, plane_bytes);
+        memcpy(m->src_points + plane, ks->mesh_y, plane_bytes);
+    }
+    m->tex[0] = u0; m->tex[1] = u1; m->tex[2] = v0; m->tex[3] = v1;
+    LOG_DEBUG("Mesh warp rebuilt: %dx%d control points -> %dx%d vertices in %.3f ms", n, n, grid, grid,
+              (double)(mono_now_us() - t0) / 1000.0);
+    return true;
+}
+
+/**
+ * Draw the mesh warp with the keystone shader (program and texture must be bound)
+ *
+ * @return false if the keystone has no usable mesh (caller draws the 4-corner quad)
+ */
+static bool mesh_geom_draw(mesh_geom_t *m, const keystone_t *ks, float u0, float u1, float v0, float v1) {
+    if (!mesh_geom_update(m, ks, u0, u1, v0, v1)) return false;
+    GLsizei stride = (GLsizei)(4 * sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, m->vbo);
+    glEnableVertexAttribArray((GLuint)g_keystone_a_position_loc);
+    glVertexAttribPointer((GLuint)g_keystone_a_position_loc, 2, GL_FLOAT, GL_FALSE, stride, (const void *)0);
+    glEnableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
+    glVertexAttribPointer((GLuint)g_keystone_a_texcoord_loc, 2, GL_FLOAT, GL_FALSE, stride, (const void *)(2 * sizeof(float)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->ibo);
+    glDrawElements(GL_TRIANGLES, m->index_count, GL_UNSIGNED_SHORT, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray((GLuint)g_keystone_a_position_loc);
+    glDisableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+// Release mesh-warp GL buffers and the cached control points
+static void mesh_geom_destroy(mesh_geom_t *m) {
+    if (m->vbo) { glDeleteBuffers(1, &m->vbo); m->vbo = 0; }
+    if (m->ibo) { glDeleteBuffers(1, &m->ibo); m->ibo = 0; }
+    free(m->src_points);
+    m->src_points = NULL;
+    m->src_size = 0;
+    m->grid = 0;
+    m->index_count = 0;
+}
+
+// Create the static index buffer shared by every keystone quad
+static void ensure_quad_index_buffers(void) {
+    if (g_keystone_index_buffer == 0) {
+        GLushort indices[] = {0, 1, 2, 2, 1, 3};
+        glGenBuffers(1, &g_keystone_index_buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_keystone_index_buffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
+
+// Interleaved quad vertices (x, y, u*q, v*q, 0, q) in draw order TL, TR, BL, BR
+static void quad_fill_verts(keystone_t *ks, float u0, float u1, float v0, float v1, float verts[24]) {
+    float tc[16];
+    keystone_fill_texcoords(ks, u0, u1, v0, v1, tc);
+    const int corner[4] = {0, 1, 3, 2}; // draw order TL, TR, BL, BR from points[] TL, TR, BR, BL
+    for (int i = 0; i < 4; i++) {
+        verts[i*6 + 0] = ks->points[corner[i]][0] * 2.0f - 1.0f;
+        verts[i*6 + 1] = 1.0f - ks->points[corner[i]][1] * 2.0f;
+        memcpy(&verts[i*6 + 2], &tc[i*4], 4 * sizeof(float));
+    }
+}
+
+/**
+ * Upload the keystone quad if its geometry generation or the texcoord range changed
+ *
+ * @param qg Persistent quad geometry
+ * @param ks Keystone whose corners define the quad
+ * @param u0,u1,v0,v1 Texture coordinates at the left/right/top/bottom edges
+ */
+static void quad_geom_upload(quad_geom_t *qg, keystone_t *ks, float u0, float u1, float v0, float v1) {
+    ensure_quad_index_buffers();
+    bool fresh = (qg->vbo == 0);
+    if (!fresh && qg->gen == ks->geom_gen &&
+        qg->tex[0] == u0 && qg->tex[1] == u1 && qg->tex[2] == v0 && qg->tex[3] == v1) {
+        return;
     }
     
-    if (g_keystone_texcoord_buffer) {
-        glDeleteBuffers(1, &g_keystone_texcoord_buffer);
-        g_keystone_texcoord_buffer = 0;
+    float verts[24];
+    quad_fill_verts(ks, u0, u1, v0, v1, verts);
+    
+    if (fresh) glGenBuffers(1, &qg->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, qg->vbo);
+    if (fresh) glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+    else glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    qg->tex[0] = u0; qg->tex[1] = u1; qg->tex[2] = v0; qg->tex[3] = v1;
+    qg->gen = ks->geom_gen;
+}
+
+// Point the keystone shader attributes at the quad VBO and bind the triangle indices
+static void quad_geom_set_attribs(const quad_geom_t *qg) {
+    GLsizei stride = (GLsizei)(6 * sizeof(float));
+    glBindBuffer(GL_ARRAY_BUFFER, qg->vbo);
+    glEnableVertexAttribArray((GLuint)g_keystone_a_position_loc);
+    glVertexAttribPointer((GLuint)g_keystone_a_position_loc, 2, GL_FLOAT, GL_FALSE, stride, (const void *)0);
+    glEnableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
+    glVertexAttribPointer((GLuint)g_keystone_a_texcoord_loc, 4, GL_FLOAT, GL_FALSE, stride, (const void *)(2 * sizeof(float)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_keystone_index_buffer);
+}
+
+/**
+ * Draw the keystone quad with the keystone shader (program and texture must be bound)
+ */
+static void quad_geom_draw(quad_geom_t *qg, keystone_t *ks, float u0, float u1, float v0, float v1) {
+    quad_geom_upload(qg, ks, u0, u1, v0, v1);
+    if (g_gl_bind_vertex_array) {
+        if (qg->vao == 0) {
+            g_gl_gen_vertex_arrays(1, &qg->vao);
+            g_gl_bind_vertex_array(qg->vao);
+            quad_geom_set_attribs(qg); // recorded in the VAO once
+        } else {
+            g_gl_bind_vertex_array(qg->vao);
+        }
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
+        g_gl_bind_vertex_array(0); // keep mpv's attribute state out of our VAO
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return;
+    }
+    quad_geom_set_attribs(qg);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray((GLuint)g_keystone_a_position_loc);
+    glDisableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Release the quad VBO and its vertex array object
+static void quad_geom_destroy(quad_geom_t *qg) {
+    if (qg->vao && g_gl_delete_vertex_arrays) g_gl_delete_vertex_arrays(1, &qg->vao);
+    qg->vao = 0;
+    if (qg->vbo) { glDeleteBuffers(1, &qg->vbo); qg->vbo = 0; }
+}
+
+// Edge blending: a variant of the keystone program (EDGE_BLEND) multiplies each pixel by
+// the instance's blend LUT. Overlapping projectors each fade out across the shared band;
+// the falloff is built in linear light and corrected for the projector gamma on the CPU.
+static GLuint g_blend_program = 0;
+static GLint g_blend_u_xform_loc = -1;
+static bool g_blend_failed = false;          // Variant unavailable: draw hard edges
+static float g_blend_gamma = 2.2f;           // Projector gamma (PICKLE_BLEND_GAMMA)
+static float g_blend_curve = 2.0f;           // Falloff exponent, 1 = linear (PICKLE_BLEND_CURVE)
+
+static bool init_blend_shader(void) {
+    const char *e = getenv("PICKLE_BLEND_GAMMA");
+    if (e && *e) { float g = strtof(e, NULL); if (g >= 1.0f && g <= 3.0f) g_blend_gamma = g; }
+    e = getenv("PICKLE_BLEND_CURVE");
+    if (e && *e) { float c = strtof(e, NULL); if (c >= 1.0f && c <= 4.0f) g_blend_curve = c; }
+
+    char vs_src[2048], fs_src[1024];
+    snprintf(vs_src, sizeof(vs_src), "#define EDGE_BLEND\n%s", g_vertex_shader_src);
+    snprintf(fs_src, sizeof(fs_src), "#define EDGE_BLEND\n%s", g_fragment_shader_src);
+    // Same attribute slots as the keystone program, so quad VAOs and mesh draws work unchanged
+    static const char *const attribs[] = { "a_position", "a_texCoord", NULL };
+    const GLint binds[] = { g_keystone_a_position_loc, g_keystone_a_texcoord_loc };
+    g_blend_program = gl_program_build("blend", vs_src, fs_src, attribs, binds);
+    if (!g_blend_program) {
+        LOG_WARN("Edge-blend shader failed to build; drawing hard edges");
+        return false;
+    }
+    g_blend_u_xform_loc = glGetUniformLocation(g_blend_program, "u_blendXform");
+    gl_use_program(g_blend_program);
+    glUniform1i(glGetUniformLocation(g_blend_program, "u_texture"), 0);
+    glUniform1i(glGetUniformLocation(g_blend_program, "u_blend"), 1);
+    LOG_GL("Edge-blend shader ready (gamma %.2f, curve %.2f)", (double)g_blend_gamma, (double)g_blend_curve);
+    return true;
+}
+
+// Overlap ramp over x in [0,1]: f(x) + f(1 - x) = 1, so two projectors sum to full light
+static float blend_ramp(float x) {
+    float p = g_blend_curve;
+    return x < 0.5f ? 0.5f * powf(2.0f * x, p) : 1.0f - 0.5f * powf(2.0f * (1.0f - x), p);
+}
+
+// Linear-light weight at s in [0,1] with soft edges lo (towards 0) and hi (towards 1)
+static float blend_edge_weight(float s, float lo, float hi) {
+    float w = 1.0f;
+    if (lo > 0.0f && s < lo) w *= blend_ramp(s / lo);
+    if (hi > 0.0f && s > 1.0f - hi) w *= blend_ramp((1.0f - s) / hi);
+    return w;
+}
+
+/**
+ * Regenerate the blend LUT if the keystone's blend widths changed (binds it to
+ * texture unit 1). Axes without blending collapse to 1 texel.
+ *
+ * @return true if lut->tex holds the mask for ks
+ */
+static bool blend_lut_update(blend_lut_t *lut, const keystone_t *ks) {
+    if (lut->tex && memcmp(lut->built, ks->blend, sizeof(lut->built)) == 0) {
+        gl_bind_texture(1, lut->tex);
+        return true;
+    }
+    int w = (ks->blend[0] > 0.0f || ks->blend[1] > 0.0f) ? BLEND_LUT_SIZE : 1;
+    int h = (ks->blend[2] > 0.0f || ks->blend[3] > 0.0f) ? BLEND_LUT_SIZE : 1;
+    unsigned char *texels = malloc((size_t)w * (size_t)h);
+    if (!texels) return false;
+    float wx[BLEND_LUT_SIZE], wy[BLEND_LUT_SIZE];
+    for (int i = 0; i < w; i++) wx[i] = blend_edge_weight(((float)i + 0.5f) / (float)w, ks->blend[0], ks->blend[1]);
+    for (int j = 0; j < h; j++) wy[j] = blend_edge_weight(((float)j + 0.5f) / (float)h, ks->blend[2], ks->blend[3]);
+    // The projector raises the output to g_blend_gamma: store weight^(1/gamma) so light falls off as the ramp
+    float inv_gamma = 1.0f / g_blend_gamma;
+    for (int j = 0; j < h; j++)
+        for (int i = 0; i < w; i++)
+            texels[(size_t)j * (size_t)w + (size_t)i] = (unsigned char)(powf(wx[i] * wy[j], inv_gamma) * 255.0f + 0.5f);
+
+    bool fresh = lut->tex == 0 || lut->w != w || lut->h != h;
+    if (lut->tex == 0) glGenTextures(1, &lut->tex);
+    gl_bind_texture(1, lut->tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (fresh) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, w, h, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, texels);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_LUMINANCE, GL_UNSIGNED_BYTE, texels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    free(texels);
+    lut->w = w;
+    lut->h = h;
+    memcpy(lut->built, ks->blend, sizeof(lut->built));
+    LOG_DEBUG("Edge-blend LUT %dx%d rebuilt (L %.3f R %.3f T %.3f B %.3f)", w, h,
+              (double)ks->blend[0], (double)ks->blend[1], (double)ks->blend[2], (double)ks->blend[3]);
+    return true;
+}
+
+static void blend_lut_destroy(blend_lut_t *lut) {
+    if (lut->tex) {
+        glDeleteTextures(1, &lut->tex);
+        gl_state_invalidate(); // the name may be reused while the shadow still has it bound
+    }
+    memset(lut, 0, sizeof(*lut));
+}
+
+/**
+ * Bind the keystone program (the edge-blend variant when ks has soft edges) and the
+ * source texture on unit 0; the blend LUT goes on unit 1
+ *
+ * @param ks Keystone being drawn
+ * @param lut Its blend LUT cache
+ * @param texture Source texture
+ * @param u0,u1,v0,v1 Texture coordinates at the left/right/top/bottom edges of the quad
+ */
+static void keystone_use_program(const keystone_t *ks, blend_lut_t *lut, GLuint texture,
+                                 float u0, float u1, float v0, float v1) {
+    bool blend = keystone_has_blend(ks) && !g_blend_failed && fabsf(u1 - u0) > 1e-6f && fabsf(v1 - v0) > 1e-6f;
+    if (blend && !g_blend_program && !init_blend_shader()) { g_blend_failed = true; blend = false; }
+    if (blend) blend = blend_lut_update(lut, ks);
+    if (blend) {
+        gl_use_program(g_blend_program);
+        float sx = 1.0f / (u1 - u0), sy = 1.0f / (v1 - v0);
+        glUniform4f(g_blend_u_xform_loc, sx, sy, -u0 * sx, -v0 * sy);
+    } else {
+        gl_use_program(g_keystone_shader_program); // u_texture is set to unit 0 at init
+    }
+    gl_bind_texture(0, texture);
+}
+
+static void blend_destroy(void) {
+    blend_lut_destroy(&g_blend_lut);
+    for (int i = 0; i < MAX_VIDEOS; i++) blend_lut_destroy(&g_videos[i].blend);
+    if (g_blend_program) { glDeleteProgram(g_blend_program); g_blend_program = 0; }
+    g_blend_failed = false;
+}
+
+// Batched multi-video quads: every instance's quad lives in one VBO (slot i = instance i).
+// A run of quads shares the keystone program and one attribute setup; each quad is then
+// one indexed draw with its own texture on unit 0. GLES2 has no texture arrays, and
+// picking the sampler per fragment would branch over every unit for every pixel.
+static GLuint g_batch_vbo = 0;               // MAX_VIDEOS quads x 4 vertices x 6 floats
+static GLuint g_batch_ibo = 0;               // 6 indices per quad slot
+static int g_batch_units = 0;                // Quads per run; 0 = not initialized
+static bool g_batch_failed = false;          // Keystone program unavailable: draw instances one by one
+static float g_batch_slot[MAX_VIDEOS][24];   // Vertices last uploaded to each slot
+
+static bool init_batch_geometry(void) {
+    if (!g_keystone_shader_program) return false;
+
+    GLushort indices[MAX_VIDEOS * 6];
+    for (int q = 0; q < MAX_VIDEOS; q++) {
+        const GLushort quad[6] = {0, 1, 2, 2, 1, 3};
+        for (int k = 0; k < 6; k++) indices[q*6 + k] = (GLushort)(q*4 + quad[k]);
     }
+    glGenBuffers(1, &g_batch_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_batch_ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    memset(g_batch_slot, 0, sizeof(g_batch_slot));
+    glGenBuffers(1, &g_batch_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, g_batch_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(g_batch_slot), g_batch_slot, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    g_batch_units = MAX_VIDEOS;
+    return true;
+}
+
+/**
+ * Draw instances first..first+count-1 from the shared quad buffer
+ * (count <= g_batch_units; every instance must have an FBO texture)
+ */
+static void batch_draw_run(int first, int count) {
+    for (int k = 0; k < count; k++) {
+        video_instance_t *inst = &g_videos[first + k];
+        keystone_t *ks = &g_rs->video[first + k].ks;
+        float u0 = inst->use_subrect ? inst->u0 : 0.0f;
+        float u1 = inst->use_subrect ? inst->u1 : 1.0f;
+        float v0 = inst->use_subrect ? inst->v0 : 0.0f;
+        float v1 = inst->use_subrect ? inst->v1 : 1.0f;
+        float verts[24];
+        quad_fill_verts(ks, u0, u1, v0, v1, verts);
+        // Re-upload only slots whose corners or texcoords changed
+        if (memcmp(verts, g_batch_slot[first + k], sizeof(verts)) != 0) {
+            memcpy(g_batch_slot[first + k], verts, sizeof(verts));
+            glBindBuffer(GL_ARRAY_BUFFER, g_batch_vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)((size_t)(first + k) * sizeof(verts)), sizeof(verts), verts);
+        }
+    }
+
+    GLsizei stride = (GLsizei)(6 * sizeof(float));
+    gl_use_program(g_keystone_shader_program); // u_texture is set to unit 0 at init
+    glBindBuffer(GL_ARRAY_BUFFER, g_batch_vbo);
+    glEnableVertexAttribArray((GLuint)g_keystone_a_position_loc);
+    glVertexAttribPointer((GLuint)g_keystone_a_position_loc, 2, GL_FLOAT, GL_FALSE, stride, (const void *)0);
+    glEnableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
+    glVertexAttribPointer((GLuint)g_keystone_a_texcoord_loc, 4, GL_FLOAT, GL_FALSE, stride, (const void *)(2 * sizeof(float)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_batch_ibo);
+    for (int k = 0; k < count; k++) {
+        gl_bind_texture(0, g_videos[first + k].fbo_texture);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const void *)((size_t)(first + k) * 6 * sizeof(GLushort)));
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray((GLuint)g_keystone_a_position_loc);
+    glDisableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Release the batched quad buffers
+static void batch_destroy(void) {
+    if (g_batch_vbo) { glDeleteBuffers(1, &g_batch_vbo); g_batch_vbo = 0; }
+    if (g_batch_ibo) { glDeleteBuffers(1, &g_batch_ibo); g_batch_ibo = 0; }
+    g_batch_units = 0;
+}
+
+// Free allocated mesh resources
+static void cleanup_mesh_resources(void) {
+    keystone_mesh_free(&g_keystone);
+}
+
+// Cleanup keystone shader resources
+static void cleanup_keystone_shader(void) {
+    quad_geom_destroy(&g_quad_geom);
+    for (int i = 0; i < MAX_VIDEOS; i++) quad_geom_destroy(&g_videos[i].quad);
+    batch_destroy();
+    blend_destroy();
     
     if (g_keystone_shader_program) {
         glDeleteProgram(g_keystone_shader_program);
         g_keystone_shader_program = 0;
     }
     
-    if (g_keystone_vertex_shader) {
-        glDeleteShader(g_keystone_vertex_shader);
-        g_keystone_vertex_shader = 0;
-    }
-    
-    if (g_keystone_fragment_shader) {
-        glDeleteShader(g_keystone_fragment_shader);
-        g_keystone_fragment_shader = 0;
-    }
-    
-	// Cached index buffer
+	// Cached index buffers
 	if (g_keystone_index_buffer) {
 		glDeleteBuffers(1, &g_keystone_index_buffer);
 		g_keystone_index_buffer = 0;
 	}
 
 	// Cached FBO/texture
-	if (g_keystone_fbo) {
-		glDeleteFramebuffers(1, &g_keystone_fbo);
-		g_keystone_fbo = 0;
-	}
-	if (g_keystone_fbo_texture) {
-		glDeleteTextures(1, &g_keystone_fbo_texture);
-		g_keystone_fbo_texture = 0;
-	}
+	fbo_pool_destroy(&g_keystone_pool);
+	g_keystone_fbo = g_keystone_fbo_texture = 0;
 	g_keystone_fbo_w = g_keystone_fbo_h = 0;
 
-	// Border shader
-	if (g_border_shader_program) { glDeleteProgram(g_border_shader_program); g_border_shader_program=0; }
-	if (g_border_vertex_shader) { glDeleteShader(g_border_vertex_shader); g_border_vertex_shader=0; }
-	if (g_border_fragment_shader) { glDeleteShader(g_border_fragment_shader); g_border_fragment_shader=0; }
+	// Border and marker overlay pass
+	overlay_destroy();
+	gl_state_invalidate();
 
     // Cleanup mesh resources
+    mesh_geom_destroy(&g_mesh_geom);
+    for (int i = 0; i < MAX_VIDEOS; i++) mesh_geom_destroy(&g_videos[i].mesh);
     cleanup_mesh_resources();
 }
 
+/**
+ * Save every keystone to its local config file (keystone.conf, or keystone_<N>.conf per video)
+ * 
+ * @return true if all of them were saved
+ */
+static bool keystone_save_all(void) {
+    if (g_num_videos > 1) {
+        // Multi-video mode: save each keystone to its own file
+        bool all_ok = true;
+        for (int i = 0; i < g_num_videos; i++) {
+            if (!keystone_save_instance_config(&g_videos[i])) {
+                LOG_ERROR("Failed to save keystone %d configuration", i + 1);
+                all_ok = false;
+            }
+        }
+        if (all_ok) {
+            LOG_INFO("Keystone configurations saved to keystone_0.conf..keystone_%d.conf", g_num_videos - 1);
+        }
+        return all_ok;
+    }
+    if (keystone_save_config("./keystone.conf")) {
+        LOG_INFO("Keystone configuration saved to local file: keystone.conf");
+        return true;
+    }
+    LOG_ERROR("Failed to save keystone configuration to local file");
+    return false;
+}
+
 /**
  * Process keystone adjustment key commands
  * 
@@ -2371,7 +6235,33 @@ static bool keystone_handle_key(char key) {
     // When keystone mode is active
     float step = (float)g_keystone_adjust_step / 1000.0f; // Convert to 0-1 range
     
+    // Multi-video: 'v' then 1-9 selects the instance; 1-4 then pick one of its corners
+    if (g_select_video_pending) {
+        g_select_video_pending = false;
+        if (key >= '1' && key <= '9') {
+            int v = key - '1';
+            if (v >= g_num_videos) {
+                LOG_INFO("No video %d (%d playing)", v + 1, g_num_videos);
+                return true;
+            }
+            int local_corner = g_videos[v].keystone.active_corner >= 0 ? g_videos[v].keystone.active_corner : 0;
+            g_selected_video = v;
+            g_active_corner_global = CORNER_GLOBAL(v, local_corner);
+            for (int i = 0; i < g_num_videos; i++) g_videos[i].keystone.active_corner = i == v ? local_corner : -1;
+            LOG_INFO("Adjusting keystone %d, corner %d (global %d)", v + 1, local_corner + 1, g_active_corner_global + 1);
+            return true;
+        }
+    }
+    
     switch (key) {
+        case 'v': // Select instance (multi-video): followed by 1-9
+            if (g_num_videos > 1) {
+                g_select_video_pending = true;
+                LOG_INFO("Select video: press 1-%d", g_num_videos);
+                return true;
+            }
+            break;
+            
         case 'k': // Toggle keystone mode
             g_keystone.enabled = false;
             g_keystone.active_corner = -1;
@@ -2386,21 +6276,23 @@ static bool keystone_handle_key(char key) {
                 g_keystone.active_mesh_point[1] = -1;
                 LOG_INFO("Adjusting corner %d", g_keystone.active_corner + 1);
             } else {
-                // Multi-video mode: keys 1-4 select corners on keystone 0
+                // Multi-video mode: keys 1-4 select corners on the selected keystone ('v' + 1-9)
                 int local_corner = key - '1';
-                g_active_corner_global = CORNER_GLOBAL(0, local_corner);
-                g_videos[0].keystone.active_corner = local_corner;
-                g_videos[1].keystone.active_corner = -1;  // Deselect other keystone
-                LOG_INFO("Adjusting keystone 1, corner %d (global %d)", local_corner + 1, g_active_corner_global + 1);
+                int v = g_selected_video < g_num_videos ? g_selected_video : 0;
+                g_active_corner_global = CORNER_GLOBAL(v, local_corner);
+                for (int i = 0; i < g_num_videos; i++) g_videos[i].keystone.active_corner = -1; // Deselect others
+                g_videos[v].keystone.active_corner = local_corner;
+                LOG_INFO("Adjusting keystone %d, corner %d (global %d)", v + 1, local_corner + 1, g_active_corner_global + 1);
             }
             return true;
             
         case '5': case '6': case '7': case '8': // Select corner (keystone 1, multi-video only)
             if (g_num_videos > 1) {
                 int local_corner = key - '5';
+                g_selected_video = 1;
                 g_active_corner_global = CORNER_GLOBAL(1, local_corner);
+                for (int i = 0; i < g_num_videos; i++) g_videos[i].keystone.active_corner = -1; // Deselect others
                 g_videos[1].keystone.active_corner = local_corner;
-                g_videos[0].keystone.active_corner = -1;  // Deselect other keystone
                 LOG_INFO("Adjusting keystone 2, corner %d (global %d)", local_corner + 1, g_active_corner_global + 1);
                 return true;
             }
@@ -2412,10 +6304,11 @@ static bool keystone_handle_key(char key) {
                 g_keystone.active_corner = (g_keystone.active_corner + 1) % 4;
                 LOG_INFO("Adjusting corner %d", g_keystone.active_corner + 1);
             } else {
-                // Multi-video: cycle 0-7
+                // Multi-video: cycle through every instance's corners
                 g_active_corner_global = (g_active_corner_global + 1) % (g_num_videos * 4);
                 int video_idx = CORNER_VIDEO(g_active_corner_global);
                 int local_corner = CORNER_LOCAL(g_active_corner_global);
+                g_selected_video = video_idx;
                 
                 // Update active corners on each keystone
                 for (int i = 0; i < g_num_videos; i++) {
@@ -2451,22 +6344,8 @@ static bool keystone_handle_key(char key) {
             LOG_INFO("Mesh warping %s", g_keystone.mesh_enabled ? "enabled" : "disabled");
             
             // If enabling, ensure mesh points are allocated
-            if (g_keystone.mesh_enabled && !g_keystone.mesh_points) {
-				g_keystone.mesh_points = malloc((size_t)g_keystone.mesh_size * sizeof(float*));
-                if (g_keystone.mesh_points) {
-                    for (int i = 0; i < g_keystone.mesh_size; i++) {
-						g_keystone.mesh_points[i] = malloc((size_t)g_keystone.mesh_size * 2 * sizeof(float));
-                        if (g_keystone.mesh_points[i]) {
-                            // Initialize regular grid
-                            for (int j = 0; j < g_keystone.mesh_size; j++) {
-								float x = (float)j / (float)(g_keystone.mesh_size - 1);
-								float y = (float)i / (float)(g_keystone.mesh_size - 1);
-                                g_keystone.mesh_points[i][j*2] = x;
-                                g_keystone.mesh_points[i][j*2+1] = y;
-                            }
-                        }
-                    }
-                }
+            if (g_keystone.mesh_enabled && !g_keystone.mesh_x) {
+                keystone_mesh_alloc(&g_keystone, g_keystone.mesh_size);
             }
             
             if (g_keystone.mesh_enabled) {
@@ -2486,26 +6365,8 @@ static bool keystone_handle_key(char key) {
             if (g_keystone.mesh_enabled && g_keystone.mesh_size < 10) {
                 int new_size = g_keystone.mesh_size + 1;
                 
-                // Clean up old mesh
-                cleanup_mesh_resources();
-                
-                // Allocate new mesh
-                g_keystone.mesh_size = new_size;
-				g_keystone.mesh_points = malloc((size_t)new_size * sizeof(float*));
-                if (g_keystone.mesh_points) {
-                    for (int i = 0; i < new_size; i++) {
-						g_keystone.mesh_points[i] = malloc((size_t)new_size * 2 * sizeof(float));
-                        if (g_keystone.mesh_points[i]) {
-                            // Initialize grid
-                            for (int j = 0; j < new_size; j++) {
-								float x = (float)j / (float)(new_size - 1);
-								float y = (float)i / (float)(new_size - 1);
-                                g_keystone.mesh_points[i][j*2] = x;
-                                g_keystone.mesh_points[i][j*2+1] = y;
-                            }
-                        }
-                    }
-                }
+                // Replace the mesh with a regular grid of the new size
+                keystone_mesh_alloc(&g_keystone, new_size);
                 
                 // Reset active point
                 g_keystone.active_mesh_point[0] = 0;
@@ -2520,26 +6381,8 @@ static bool keystone_handle_key(char key) {
             if (g_keystone.mesh_enabled && g_keystone.mesh_size > 2) {
                 int new_size = g_keystone.mesh_size - 1;
                 
-                // Clean up old mesh
-                cleanup_mesh_resources();
-                
-                // Allocate new mesh
-                g_keystone.mesh_size = new_size;
-				g_keystone.mesh_points = malloc((size_t)new_size * sizeof(float*));
-                if (g_keystone.mesh_points) {
-                    for (int i = 0; i < new_size; i++) {
-						g_keystone.mesh_points[i] = malloc((size_t)new_size * 2 * sizeof(float));
-                        if (g_keystone.mesh_points[i]) {
-                            // Initialize grid
-                            for (int j = 0; j < new_size; j++) {
-								float x = (float)j / (float)(new_size - 1);
-								float y = (float)i / (float)(new_size - 1);
-                                g_keystone.mesh_points[i][j*2] = x;
-                                g_keystone.mesh_points[i][j*2+1] = y;
-                            }
-                        }
-                    }
-                }
+                // Replace the mesh with a regular grid of the new size
+                keystone_mesh_alloc(&g_keystone, new_size);
                 
                 // Reset active point
                 g_keystone.active_mesh_point[0] = 0;
@@ -2634,19 +6477,7 @@ static bool keystone_handle_key(char key) {
                     keystone_t *ks = &g_videos[video_idx].keystone;
                     
                     // Reset to default split position for this video
-                    if (video_idx == 0) {
-                        // Video 0: left half
-                        ks->points[0][0] = 0.0f; ks->points[0][1] = 0.0f; // Top-left
-                        ks->points[1][0] = 0.5f; ks->points[1][1] = 0.0f; // Top-right
-                        ks->points[2][0] = 0.5f; ks->points[2][1] = 1.0f; // Bottom-right
-                        ks->points[3][0] = 0.0f; ks->points[3][1] = 1.0f; // Bottom-left
-                    } else {
-                        // Video 1: right half
-                        ks->points[0][0] = 0.5f; ks->points[0][1] = 0.0f; // Top-left
-                        ks->points[1][0] = 1.0f; ks->points[1][1] = 0.0f; // Top-right
-                        ks->points[2][0] = 1.0f; ks->points[2][1] = 1.0f; // Bottom-right
-                        ks->points[3][0] = 0.5f; ks->points[3][1] = 1.0f; // Bottom-left
-                    }
+                    keystone_default_points(ks, video_idx, g_num_videos);
                     
                     // Reset pins
                     for (int i = 0; i < 4; i++) {
@@ -2676,17 +6507,8 @@ static bool keystone_handle_key(char key) {
                 }
                 
                 // Reset mesh if enabled
-                if (was_mesh_enabled && g_keystone.mesh_points) {
-                    for (int i = 0; i < g_keystone.mesh_size; i++) {
-                        if (g_keystone.mesh_points[i]) {
-                            for (int j = 0; j < g_keystone.mesh_size; j++) {
-								float x = (float)j / (float)(g_keystone.mesh_size - 1);
-								float y = (float)i / (float)(g_keystone.mesh_size - 1);
-                                g_keystone.mesh_points[i][j*2] = x;
-                                g_keystone.mesh_points[i][j*2+1] = y;
-                            }
-                        }
-                    }
+                if (was_mesh_enabled && g_keystone.mesh_x) {
+                    keystone_mesh_reset(&g_keystone);
                 }
                 
                 // Restore enabled states
@@ -2752,25 +6574,7 @@ static bool keystone_handle_key(char key) {
 			return false;
             
         case 'S': // Save keystone configuration to local file
-            if (g_num_videos > 1) {
-                // Multi-video mode: save each keystone to its own file
-                bool all_ok = true;
-                for (int i = 0; i < g_num_videos; i++) {
-                    if (!keystone_save_instance_config(&g_videos[i])) {
-                        LOG_ERROR("Failed to save keystone %d configuration", i + 1);
-                        all_ok = false;
-                    }
-                }
-                if (all_ok) {
-                    LOG_INFO("Keystone configurations saved to keystone_0.conf and keystone_1.conf");
-                }
-            } else {
-                if (keystone_save_config("./keystone.conf")) {
-                    LOG_INFO("Keystone configuration saved to local file: keystone.conf");
-                } else {
-                    LOG_ERROR("Failed to save keystone configuration to local file");
-                }
-            }
+            keystone_save_all();
             return true;
             
 		default:
@@ -2782,51 +6586,930 @@ static bool keystone_handle_key(char key) {
 }
 
 /**
- * Save keystone configuration to a specified file path
+ * Save keystone configuration to a specified file path
+ * 
+ * @param path The file path to save the configuration to
+ * @return true if the configuration was saved successfully, false otherwise
+ */
+static bool keystone_save_config(const char* path) {
+    if (!path) return false;
+    
+    char cache_path[520];
+    keystone_cache_path(path, cache_path, sizeof(cache_path));
+    if (!keystone_text_export()) return kcal_save(cache_path, &g_keystone, true);
+    
+    char tmp[520];
+    FILE* f = atomic_file_open(path, tmp, sizeof(tmp));
+    if (!f) return false;
+    
+    fprintf(f, "# Pickle keystone configuration\n");
+    fprintf(f, "enabled=%d\n", g_keystone.enabled ? 1 : 0);
+    fprintf(f, "mesh_enabled=%d\n", g_keystone.mesh_enabled ? 1 : 0);
+    fprintf(f, "mesh_size=%d\n", g_keystone.mesh_size);
+    
+    // Save the corner points
+    for (int i = 0; i < 4; i++) {
+        fprintf(f, "corner%d=%.6f,%.6f\n", i+1, g_keystone.points[i][0], g_keystone.points[i][1]);
+        fprintf(f, "pin%d=%d\n", i+1, g_keystone.perspective_pins[i] ? 1 : 0);
+    }
+    
+    // Save border and corner marker settings
+    fprintf(f, "border=%d\n", g_show_border ? 1 : 0);
+    fprintf(f, "cornermarks=%d\n", g_show_corner_markers ? 1 : 0);
+    fprintf(f, "blend=%.4f,%.4f,%.4f,%.4f\n", g_keystone.blend[0], g_keystone.blend[1],
+            g_keystone.blend[2], g_keystone.blend[3]);
+    
+    // Save mesh points if mesh warping is enabled
+    if (g_keystone.mesh_enabled && g_keystone.mesh_x) {
+        int n = g_keystone.mesh_size;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                fprintf(f, "mesh_%d_%d=%.6f,%.6f\n", i, j, 
+                        g_keystone.mesh_x[i * n + j],
+                        g_keystone.mesh_y[i * n + j]);
+            }
+        }
+    }
+    
+    if (!atomic_file_commit(f, tmp, path)) return false;
+    return kcal_save(cache_path, &g_keystone, true);
+}
+
+// --- Control socket (PICKLE_CONTROL_SOCKET) ---
+// Line-oriented text commands on a Unix-domain socket, serviced from the control
+// thread's poll() loop like the metrics endpoint. Commands edit the same control-thread
+// state as the keyboard and controller; everything one service pass applies goes out
+// in a single render_publish(), so the render thread takes it up as one snapshot at
+// its next frame. "begin" ... "commit" groups lines that arrive in separate writes:
+// once its commit is in, the batch is parsed in full and run against a staged copy of
+// the state it edits; only if every command succeeds there (allocations included) is
+// it committed, so a batch is applied whole or not at all. Every command and every
+// batch gets one "ok" or "err <reason>" reply line.
+#define CTL_MAX_CLIENTS 4
+#define CTL_BUF 4096             // Per-client line buffer; also bounds one begin/commit batch
+#define CTL_BATCH_MAX 64         // Commands per begin/commit batch
+
+typedef enum {
+	CTL_CORNER, CTL_MESH, CTL_MESH_SIZE, CTL_KEYSTONE, CTL_RESET, CTL_LOAD,
+	CTL_BORDER, CTL_BORDER_WIDTH, CTL_MARKERS, CTL_HELP, CTL_SAVE, CTL_GET,
+} ctl_op_t;
+
+typedef struct {
+	ctl_op_t op;
+	int video;
+	int a, b;                // Corner, mesh row/col, mesh size or border width
+	int mode;                // on/off/toggle: 1, 0, 2
+	float x, y;
+	const char *path;        // CTL_LOAD; points into the client buffer
+} ctl_cmd_t;
+
+static struct {
+	int listen_fd;
+	char path[108];          // sun_path; empty for an abstract socket
+	int client_fd[CTL_MAX_CLIENTS];
+	char buf[CTL_MAX_CLIENTS][CTL_BUF];
+	size_t len[CTL_MAX_CLIENTS];
+	char files[MAX_VIDEOS][512]; // Files loaded over the socket (g_videos[].video_file)
+} g_ctl = { .listen_fd = -1, .client_fd = { -1, -1, -1, -1 } };
+
+static bool ctl_open(const char *path) {
+	g_ctl.listen_fd = unix_listen("PICKLE_CONTROL_SOCKET", path, g_ctl.path, CTL_MAX_CLIENTS);
+	if (g_ctl.listen_fd < 0) return false;
+	LOG_INFO("Control commands accepted on unix socket %s", path);
+	return true;
+}
+
+static void ctl_close(void) {
+	for (int i = 0; i < CTL_MAX_CLIENTS; i++) {
+		if (g_ctl.client_fd[i] >= 0) { close(g_ctl.client_fd[i]); g_ctl.client_fd[i] = -1; }
+	}
+	if (g_ctl.listen_fd >= 0) { close(g_ctl.listen_fd); g_ctl.listen_fd = -1; }
+	if (g_ctl.path[0]) { unlink(g_ctl.path); g_ctl.path[0] = '\0'; }
+}
+
+static void ctl_reply(int fd, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void ctl_reply(int fd, const char *fmt, ...) {
+	char line[512];
+	va_list ap;
+	va_start(ap, fmt);
+	int w = vsnprintf(line, sizeof(line) - 1, fmt, ap);
+	va_end(ap);
+	if (w < 0) return;
+	size_t len = (size_t)w < sizeof(line) - 1 ? (size_t)w : sizeof(line) - 2;
+	line[len++] = '\n';
+	// Replies are short; a client that stops reading loses them rather than stalling the loop
+	if (send(fd, line, len, MSG_NOSIGNAL | MSG_DONTWAIT) < (ssize_t)len) LOG_DEBUG("Control client %d: short write", fd);
+}
+
+// Next space-separated token of *p (terminated in place), NULL at the end of the line
+static char *ctl_token(char **p) {
+	char *s = *p;
+	while (*s == ' ' || *s == '\t') s++;
+	if (!*s) { *p = s; return NULL; }
+	char *t = s;
+	while (*s && *s != ' ' && *s != '\t') s++;
+	if (*s) *s++ = '\0';
+	*p = s;
+	return t;
+}
+
+static bool ctl_int(const char *t, int lo, int hi, int *out) {
+	if (!t) return false;
+	char *end;
+	long v = strtol(t, &end, 10);
+	if (end == t || *end || v < lo || v > hi) return false;
+	*out = (int)v;
+	return true;
+}
+
+// Normalized coordinate, clamped like interactive adjustments are
+static bool ctl_coord(const char *t, float *out) {
+	if (!t) return false;
+	char *end;
+	float v = strtof(t, &end);
+	if (end == t || *end || !isfinite(v) || v < -0.5f || v > 1.5f) return false;
+	*out = v;
+	return true;
+}
+
+static bool ctl_mode(const char *t, int *out) {
+	if (!t) return false;
+	if (!strcasecmp(t, "on") || !strcmp(t, "1")) *out = 1;
+	else if (!strcasecmp(t, "off") || !strcmp(t, "0")) *out = 0;
+	else if (!strcasecmp(t, "toggle")) *out = 2;
+	else return false;
+	return true;
+}
+
+static bool ctl_flag(bool cur, int mode) {
+	return mode == 2 ? !cur : mode == 1;
+}
+
+// Keystone of a video: the per-instance ones with several videos, g_keystone otherwise
+static keystone_t *ctl_keystone(int video) {
+	return g_num_videos > 1 ? &g_videos[video].keystone : &g_keystone;
+}
+
+// State ctl_apply() edits: the live control-thread state, or a batch's staged copy
+typedef struct {
+	keystone_t ks[MAX_VIDEOS];   // Staged copies (batch only)
+	keystone_t *k[MAX_VIDEOS];   // Keystone per video (ctl_keystone() layout)
+	bool show_border, show_markers;
+	int border_width, help_toggle;
+	bool *border, *markers;      // Live globals or the staged fields above
+	int *width, *help;
+	bool staged;                 // load and save are only checked; ctl_run_batch() runs them
+} ctl_state_t;
+
+static int ctl_videos(void) {
+	return g_num_videos > 1 ? g_num_videos : 1;
+}
+
+static void ctl_state_live(ctl_state_t *st) {
+	for (int v = 0; v < ctl_videos(); v++) st->k[v] = ctl_keystone(v);
+	st->border = &g_show_border;
+	st->markers = &g_show_corner_markers;
+	st->width = &g_border_width;
+	st->help = &g_help_toggle_request;
+	st->staged = false;
+}
+
+// Free the staged meshes of videos 0..count-1
+static void ctl_state_drop(ctl_state_t *st, int count) {
+	for (int v = 0; v < count; v++) keystone_mesh_free(&st->ks[v]);
+}
+
+/**
+ * Stage a deep copy of everything a batch can edit
+ *
+ * @return false if a mesh copy could not be allocated (nothing staged)
+ */
+static bool ctl_state_stage(ctl_state_t *st) {
+	for (int v = 0; v < ctl_videos(); v++) {
+		const keystone_t *src = ctl_keystone(v);
+		keystone_t *dst = &st->ks[v];
+		*dst = *src;
+		dst->mesh_x = dst->mesh_y = NULL;
+		if (src->mesh_x) {
+			if (!keystone_mesh_alloc(dst, src->mesh_size)) { ctl_state_drop(st, v); return false; }
+			size_t bytes = (size_t)src->mesh_size * (size_t)src->mesh_size * sizeof(float);
+			memcpy(dst->mesh_x, src->mesh_x, bytes);
+			memcpy(dst->mesh_y, src->mesh_y, bytes);
+		}
+		st->k[v] = dst;
+	}
+	st->show_border = g_show_border;
+	st->show_markers = g_show_corner_markers;
+	st->border_width = g_border_width;
+	st->help_toggle = g_help_toggle_request;
+	st->border = &st->show_border;
+	st->markers = &st->show_markers;
+	st->width = &st->border_width;
+	st->help = &st->help_toggle;
+	st->staged = true;
+	return true;
+}
+
+// Swap staged and live state (cannot fail); swapping again undoes it
+static void ctl_state_swap(ctl_state_t *st) {
+	for (int v = 0; v < ctl_videos(); v++) {
+		keystone_t *live = ctl_keystone(v), tmp = *live;
+		*live = st->ks[v];
+		st->ks[v] = tmp;
+	}
+	bool b = g_show_border; g_show_border = st->show_border; st->show_border = b;
+	b = g_show_corner_markers; g_show_corner_markers = st->show_markers; st->show_markers = b;
+	int i = g_border_width; g_border_width = st->border_width; st->border_width = i;
+	i = g_help_toggle_request; g_help_toggle_request = st->help_toggle; st->help_toggle = i;
+}
+
+// Why a load cannot run, or NULL
+static const char *ctl_load_check(const ctl_cmd_t *c, const mpv_player_t *players, int num_players) {
+	if (g_pl.count) return "not available with a playlist";
+	if (g_num_videos > 1 && g_single_mpv_mode) return "not available in single-mpv mode";
+	if (c->video >= num_players || !players[c->video].mpv) return "no player for video";
+	return NULL;
+}
+
+// Replace the file playing in a video; false if mpv refused the loadfile
+static bool ctl_loadfile(mpv_player_t *players, int video, const char *path) {
+	cache_profile_apply(&players[video], path);
+	const char *cmd[] = { "loadfile", path, "replace", NULL };
+	if (mpv_command_async(players[video].mpv, 0, cmd) < 0) { // mpv copies the arguments
+		if (g_videos[video].video_file) cache_profile_apply(&players[video], g_videos[video].video_file);
+		return false;
+	}
+	if (path != g_ctl.files[video]) snprintf(g_ctl.files[video], sizeof(g_ctl.files[0]), "%s", path);
+	g_videos[video].video_file = g_ctl.files[video];
+	LOG_INFO("Control socket: loading %s into video %d", path, video);
+	return true;
+}
+
+/**
+ * Parse one command line, tokenizing it in place
+ *
+ * @param line NUL-terminated line without its newline
+ * @param c Receives the command
+ * @return NULL on success, else the reason for the error reply
+ */
+static const char *ctl_parse(char *line, ctl_cmd_t *c) {
+	char *p = line;
+	const char *op = ctl_token(&p);
+	int videos = ctl_videos();
+	memset(c, 0, sizeof(*c));
+	if (!op) return "empty command";
+
+	if (!strcmp(op, "corner") || !strcmp(op, "mesh") || !strcmp(op, "mesh-size") || !strcmp(op, "keystone") ||
+	    !strcmp(op, "reset") || !strcmp(op, "load") || !strcmp(op, "get")) {
+		if (!ctl_int(ctl_token(&p), 0, videos - 1, &c->video)) return "bad video index";
+	}
+	if (!strcmp(op, "corner")) {
+		c->op = CTL_CORNER;
+		if (!ctl_int(ctl_token(&p), 0, 3, &c->a)) return "bad corner (0-3: TL TR BR BL)";
+		if (!ctl_coord(ctl_token(&p), &c->x) || !ctl_coord(ctl_token(&p), &c->y)) return "bad coordinate (-0.5..1.5)";
+	} else if (!strcmp(op, "mesh")) {
+		c->op = CTL_MESH;
+		if (!ctl_int(ctl_token(&p), 0, KEYSTONE_MESH_MAX - 1, &c->a) ||
+		    !ctl_int(ctl_token(&p), 0, KEYSTONE_MESH_MAX - 1, &c->b)) return "bad mesh row/column";
+		if (!ctl_coord(ctl_token(&p), &c->x) || !ctl_coord(ctl_token(&p), &c->y)) return "bad coordinate (-0.5..1.5)";
+	} else if (!strcmp(op, "mesh-size")) {
+		c->op = CTL_MESH_SIZE;
+		if (!ctl_int(ctl_token(&p), 0, KEYSTONE_MESH_MAX, &c->a) || c->a == 1) return "bad mesh size (0 or 2-10)";
+	} else if (!strcmp(op, "keystone")) {
+		c->op = CTL_KEYSTONE;
+		if (!ctl_mode(ctl_token(&p), &c->mode)) return "expected on, off or toggle";
+	} else if (!strcmp(op, "reset")) {
+		c->op = CTL_RESET;
+	} else if (!strcmp(op, "load")) {
+		// The rest of the line is the path, spaces included
+		c->op = CTL_LOAD;
+		while (*p == ' ' || *p == '\t') p++;
+		if (!*p) return "missing file";
+		if (strlen(p) >= sizeof(g_ctl.files[0])) return "path too long";
+		c->path = p;
+		return NULL;
+	} else if (!strcmp(op, "border") || !strcmp(op, "markers") || !strcmp(op, "help")) {
+		c->op = op[0] == 'b' ? CTL_BORDER : (op[0] == 'm' ? CTL_MARKERS : CTL_HELP);
+		if (!ctl_mode(ctl_token(&p), &c->mode)) return "expected on, off or toggle";
+	} else if (!strcmp(op, "border-width")) {
+		c->op = CTL_BORDER_WIDTH;
+		if (!ctl_int(ctl_token(&p), 1, 50, &c->a)) return "bad border width (1-50)";
+	} else if (!strcmp(op, "save")) {
+		c->op = CTL_SAVE;
+	} else if (!strcmp(op, "get")) {
+		c->op = CTL_GET;
+	} else {
+		return "unknown command";
+	}
+	return ctl_token(&p) ? "too many arguments" : NULL;
+}
+
+/**
+ * Apply a parsed command
+ *
+ * @param c Command from ctl_parse()
+ * @param st Live state (ctl_state_live) or a batch's staged copy (ctl_state_stage)
+ * @param out Receives text for the ok reply (empty if none)
+ * @return NULL on success, else the reason for the error reply
+ */
+static const char *ctl_apply(const ctl_cmd_t *c, ctl_state_t *st, mpv_player_t *players, int num_players,
+                             char *out, size_t out_len) {
+	keystone_t *ks = st->k[c->video];
+	out[0] = '\0';
+	switch (c->op) {
+	case CTL_CORNER:
+		if (ks->perspective_pins[c->a]) return "corner pinned"; // as for the keyboard and joystick
+		ks->points[c->a][0] = c->x;
+		ks->points[c->a][1] = c->y;
+		keystone_update_matrix_for(ks);
+		break;
+	case CTL_MESH:
+		if (!ks->mesh_enabled || !ks->mesh_x || c->a >= ks->mesh_size || c->b >= ks->mesh_size) return "no such mesh point";
+		ks->mesh_x[c->a * ks->mesh_size + c->b] = c->x;
+		ks->mesh_y[c->a * ks->mesh_size + c->b] = c->y;
+		break;
+	case CTL_MESH_SIZE:
+		if (c->a == 0) {
+			ks->mesh_enabled = false;
+		} else {
+			if (!keystone_mesh_alloc(ks, c->a)) return "out of memory";
+			ks->mesh_enabled = true;
+		}
+		ks->active_mesh_point[0] = ks->active_mesh_point[1] = -1;
+		break;
+	case CTL_KEYSTONE:
+		ks->enabled = ctl_flag(ks->enabled, c->mode);
+		if (g_num_videos <= 1) ks->active_corner = ks->enabled ? g_selected_corner : -1;
+		keystone_update_matrix_for(ks);
+		break;
+	case CTL_RESET: {
+		static const float rect[4][2] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
+		memcpy(ks->points, rect, sizeof(rect));
+		if (ks->mesh_x) keystone_mesh_reset(ks);
+		keystone_update_matrix_for(ks);
+		break;
+	}
+	case CTL_LOAD: {
+		const char *e = ctl_load_check(c, players, num_players);
+		if (e) return e;
+		if (!st->staged && !ctl_loadfile(players, c->video, c->path)) return "loadfile failed";
+		break;
+	}
+	case CTL_BORDER:
+		*st->border = ctl_flag(*st->border, c->mode);
+		break;
+	case CTL_BORDER_WIDTH:
+		*st->width = c->a;
+		break;
+	case CTL_MARKERS:
+		*st->markers = ctl_flag(*st->markers, c->mode);
+		break;
+	case CTL_HELP:
+		// Shown and hidden by the control loop, which owns the OSD state
+		if (ctl_flag(g_help_visible != 0, c->mode) != (g_help_visible != 0)) *st->help = 1;
+		break;
+	case CTL_SAVE:
+		if (!st->staged && !keystone_save_all()) return "save failed";
+		break;
+	case CTL_GET:
+		snprintf(out, out_len, "%d %.4f %.4f %.4f %.4f %.4f %.4f %.4f %.4f %d", ks->enabled ? 1 : 0,
+		         ks->points[0][0], ks->points[0][1], ks->points[1][0], ks->points[1][1],
+		         ks->points[2][0], ks->points[2][1], ks->points[3][0], ks->points[3][1],
+		         ks->mesh_enabled ? ks->mesh_size : 0);
+		break;
+	}
+	return NULL;
+}
+
+// Line starting at buf[pos], trimmed of leading blanks and a trailing CR; false if no newline yet
+static bool ctl_line(char *buf, size_t len, size_t pos, char **line, size_t *next) {
+	char *nl = memchr(buf + pos, '\n', len - pos);
+	if (!nl) return false;
+	*nl = '\0';
+	if (nl > buf + pos && nl[-1] == '\r') nl[-1] = '\0';
+	char *s = buf + pos;
+	while (*s == ' ' || *s == '\t') s++;
+	*line = s;
+	*next = (size_t)(nl - buf) + 1;
+	return true;
+}
+
+// Run a begin/commit batch whose lines start at buf[pos]; returns false (buffer untouched) until its commit arrives
+static bool ctl_run_batch(int slot, size_t pos, size_t *next, bool *changed, mpv_player_t *players, int num_players) {
+	char *buf = g_ctl.buf[slot];
+	size_t len = g_ctl.len[slot];
+	// Find the commit before touching anything (ctl_line terminates lines in place)
+	size_t end = pos;
+	bool found = false;
+	while (end < len) {
+		char *nl = memchr(buf + end, '\n', len - end);
+		if (!nl) break;
+		const char *s = buf + end;
+		while (*s == ' ' || *s == '\t') s++;
+		size_t n = (size_t)(nl - s);
+		if (n && s[n - 1] == '\r') n--;
+		end = (size_t)(nl - buf) + 1;
+		if (n == 6 && !memcmp(s, "commit", 6)) { found = true; break; }
+	}
+	if (!found) return false;
+
+	int fd = g_ctl.client_fd[slot];
+	ctl_cmd_t cmds[CTL_BATCH_MAX];
+	int count = 0, bad_line = 0;
+	const char *err = NULL;
+	char *line;
+	size_t at = pos, after;
+	while (ctl_line(buf, len, at, &line, &after) && after < end) {
+		at = after;
+		if (!*line || *line == '#') continue;
+		if (count == CTL_BATCH_MAX) { err = "batch too long"; bad_line = count + 1; break; }
+		if ((err = ctl_parse(line, &cmds[count])) != NULL) { bad_line = count + 1; break; }
+		count++;
+	}
+	*next = end;
+	if (err) {
+		ctl_reply(fd, "err batch line %d: %s (nothing applied)", bad_line, err);
+		return true;
+	}
+	// Run everything on a staged copy first: a command that fails there leaves no trace
+	ctl_state_t st;
+	if (!ctl_state_stage(&st)) {
+		ctl_reply(fd, "err out of memory (nothing applied)");
+		return true;
+	}
+	char out[256];
+	bool save = false;
+	for (int i = 0; i < count; i++) {
+		const char *e = ctl_apply(&cmds[i], &st, players, num_players, out, sizeof(out));
+		if (e) {
+			ctl_state_drop(&st, ctl_videos());
+			ctl_reply(fd, "err batch line %d: %s (nothing applied)", i + 1, e);
+			return true;
+		}
+		save |= cmds[i].op == CTL_SAVE;
+	}
+	// Loads are the one step that leaves pickle; if mpv refuses one, the earlier ones are
+	// undone by reloading the file each video was playing (from its start)
+	char prev[MAX_VIDEOS][sizeof(g_ctl.files[0])];
+	bool loaded[MAX_VIDEOS] = { false };
+	const char *err_load = NULL;
+	for (int i = 0; i < count && !err_load; i++) {
+		const ctl_cmd_t *c = &cmds[i];
+		if (c->op != CTL_LOAD) continue;
+		if (!loaded[c->video]) {
+			const char *cur = g_videos[c->video].video_file;
+			snprintf(prev[c->video], sizeof(prev[0]), "%s", cur ? cur : "");
+		}
+		if (!ctl_loadfile(players, c->video, c->path)) err_load = "loadfile failed";
+		else loaded[c->video] = true;
+	}
+	ctl_state_swap(&st); // commit; st now holds the previous state
+	if (!err_load && save && !keystone_save_all()) err_load = "save failed";
+	if (err_load) {
+		ctl_state_swap(&st);
+		for (int v = 0; v < MAX_VIDEOS; v++)
+			if (loaded[v] && prev[v][0] && !ctl_loadfile(players, v, prev[v])) LOG_WARN("Control socket: could not reload %s", prev[v]);
+		if (save) keystone_save_all(); // put the previous calibration back on disk
+		ctl_state_drop(&st, ctl_videos());
+		ctl_reply(fd, "err batch: %s (nothing applied)", err_load);
+		return true;
+	}
+	ctl_state_drop(&st, ctl_videos()); // previous meshes
+	*changed = true;
+	ctl_reply(fd, "ok %d", count);
+	return true;
+}
+
+/**
+ * Run every complete line a client has sent (control thread)
+ *
+ * @return true if any command changed state
+ */
+static bool ctl_run(int slot, mpv_player_t *players, int num_players) {
+	char *buf = g_ctl.buf[slot];
+	int fd = g_ctl.client_fd[slot];
+	size_t pos = 0, next;
+	bool changed = false;
+	for (;;) {
+		// Peek for a batch start without consuming it, so an incomplete batch is kept as is
+		const char *s = buf + pos;
+		while (s < buf + g_ctl.len[slot] && (*s == ' ' || *s == '\t')) s++;
+		size_t left = g_ctl.len[slot] - (size_t)(s - buf);
+		if (left >= 6 && !memcmp(s, "begin", 5) && (s[5] == '\n' || s[5] == '\r')) {
+			char *nl = memchr(s, '\n', left);
+			if (!nl) break;
+			if (!ctl_run_batch(slot, (size_t)(nl - buf) + 1, &next, &changed, players, num_players)) break;
+			pos = next;
+			continue;
+		}
+		char *line;
+		if (!ctl_line(buf, g_ctl.len[slot], pos, &line, &next)) break;
+		pos = next;
+		if (!*line || *line == '#') continue;
+		ctl_cmd_t cmd;
+		ctl_state_t live;
+		char out[256];
+		ctl_state_live(&live);
+		const char *err = ctl_parse(line, &cmd);
+		if (!err) err = ctl_apply(&cmd, &live, players, num_players, out, sizeof(out));
+		if (err) {
+			ctl_reply(fd, "err %s", err);
+		} else {
+			changed = true;
+			ctl_reply(fd, out[0] ? "ok %s" : "ok%s", out);
+		}
+	}
+	memmove(buf, buf + pos, g_ctl.len[slot] - pos);
+	g_ctl.len[slot] -= pos;
+	if (g_ctl.len[slot] == CTL_BUF) {
+		ctl_reply(fd, "err line or batch too long");
+		g_ctl.len[slot] = 0;
+	}
+	return changed;
+}
+
+// Add the listening socket and connected clients to a poll set; returns the count added
+static int ctl_poll_fds(struct pollfd *pfds) {
+	int n = 0;
+	if (g_ctl.listen_fd < 0) return 0;
+	pfds[n].fd = g_ctl.listen_fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++;
+	for (int i = 0; i < CTL_MAX_CLIENTS; i++) {
+		if (g_ctl.client_fd[i] < 0) continue;
+		pfds[n].fd = g_ctl.client_fd[i]; pfds[n].events = POLLIN; pfds[n].revents = 0; n++;
+	}
+	return n;
+}
+
+/**
+ * Accept control clients and run the commands they sent (control thread)
+ *
+ * @param pfds Poll set after poll() returned
+ * @param n Entries in pfds
+ */
+static void ctl_service(const struct pollfd *pfds, int n, mpv_player_t *players, int num_players) {
+	if (g_ctl.listen_fd < 0) return;
+	bool changed = false;
+	for (int i = 0; i < n; i++) {
+		if (!pfds[i].revents) continue;
+		if (pfds[i].fd == g_ctl.listen_fd) {
+			int c;
+			while ((c = accept4(g_ctl.listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+				int slot = -1;
+				for (int k = 0; k < CTL_MAX_CLIENTS && slot < 0; k++) if (g_ctl.client_fd[k] < 0) slot = k;
+				if (slot < 0) { ctl_reply(c, "err busy"); close(c); continue; }
+				g_ctl.client_fd[slot] = c;
+				g_ctl.len[slot] = 0;
+			}
+			continue;
+		}
+		for (int k = 0; k < CTL_MAX_CLIENTS; k++) {
+			if (g_ctl.client_fd[k] != pfds[i].fd) continue;
+			ssize_t r = read(pfds[i].fd, g_ctl.buf[k] + g_ctl.len[k], CTL_BUF - g_ctl.len[k]);
+			if (r > 0) {
+				g_ctl.len[k] += (size_t)r;
+				if (ctl_run(k, players, num_players)) changed = true;
+			} else if (!(r < 0 && errno == EAGAIN)) {
+				close(pfds[i].fd); // done; an unfinished line or batch is dropped
+				g_ctl.client_fd[k] = -1;
+			}
+		}
+	}
+	// The whole pass reaches the render thread as one snapshot
+	if (changed) render_publish();
+}
+
+// --- Controller input: evdev batching, coalesced corner moves, input timers ---
+// The controller is read through evdev (/dev/input/event*) when a gamepad node is found,
+// with joydev (/dev/input/js0) as the fallback. evdev buttons and axes are numbered the
+// way joydev numbers them, so the JS_* mappings above apply to both paths. evdev reads
+// are batched and handled per SYN_REPORT frame, keeping only the last value of each axis.
+// Corner moves from one batch are summed and applied with a single matrix update before
+// the control loop publishes one snapshot. The START+SELECT hold and held-direction
+// repeat are timerfds in the control loop's poll(), so nothing is timed per iteration.
+
+#define INPUT_QUIT_HOLD_MS 2000
+#define INPUT_REPEAT_MS 250           // Held direction repeat (the old joydev axis debounce)
+#define INPUT_AXIS_THRESHOLD 16384    // Half deflection counts as a direction
+#define EVDEV_BUTTONS (KEY_CNT - BTN_MISC)
+#define EVDEV_LONG_BITS (8 * sizeof(unsigned long))
+#define EVDEV_BITS(n) (((n) + EVDEV_LONG_BITS - 1) / EVDEV_LONG_BITS)
+
+static uint8_t g_evdev_btn[EVDEV_BUTTONS];     // key code - BTN_MISC -> js button number (0xff: none)
+static uint8_t g_evdev_axis[ABS_CNT];          // abs code -> js axis number (0xff: none)
+static struct input_absinfo g_evdev_absinfo[ABS_CNT];
+static unsigned long g_evdev_keys[EVDEV_BITS(KEY_CNT)]; // Key state as last reported
+static int8_t g_input_held[ABS_CNT];           // Held direction per js axis number (-1, 0, 1)
+static bool g_input_repeat_armed = false;
+
+// Events of the SYN_REPORT frame being read
+static struct {
+    struct { uint8_t number; int16_t value; } btn[32];
+    int nbtn;
+    int32_t abs[ABS_CNT];
+    uint64_t abs_set;                          // Bit per abs code reported in this frame
+    bool dropped;                              // SYN_DROPPED: skip to the next SYN_REPORT and resync
+} g_evdev_frame;
+
+// Corner move queued by the current input batch
+static struct {
+    bool pending;
+    int corner, corner_global;
+    float dx, dy;
+} g_input_move;
+
+static bool evdev_test_bit(const unsigned long *bits, int n) {
+    size_t u = (size_t)n;
+    return (bits[u / EVDEV_LONG_BITS] >> (u % EVDEV_LONG_BITS)) & 1UL;
+}
+
+/**
+ * Apply the queued corner move, if any, with one keystone update
+ */
+static void input_flush_moves(void) {
+    if (!g_input_move.pending) return;
+    g_input_move.pending = false;
+    keystone_adjust_corner(g_input_move.corner, g_input_move.dx, g_input_move.dy);
+}
+
+/**
+ * Queue a move of the active corner; moves of the same corner within a batch are summed
+ * 
+ * @param dx The X adjustment delta
+ * @param dy The Y adjustment delta
+ */
+static void input_queue_move(float dx, float dy) {
+    if (g_input_move.pending && (g_input_move.corner != g_keystone.active_corner ||
+                                 g_input_move.corner_global != g_active_corner_global)) {
+        input_flush_moves();
+    }
+    if (!g_input_move.pending) {
+        g_input_move.pending = true;
+        g_input_move.corner = g_keystone.active_corner;
+        g_input_move.corner_global = g_active_corner_global;
+        g_input_move.dx = g_input_move.dy = 0.0f;
+    }
+    g_input_move.dx += dx;
+    g_input_move.dy += dy;
+}
+
+static int input_timer_create(void) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) LOG_WARN("timerfd_create failed: %s", strerror(errno));
+    return fd;
+}
+
+// Arm a timer to fire after first_ms, then every period_ms (0: once); first_ms 0 disarms it
+static void input_timer_set(int fd, int first_ms, int period_ms) {
+    if (fd < 0) return;
+    struct itimerspec its = {
+        .it_value = { first_ms / 1000, (long)(first_ms % 1000) * 1000000L },
+        .it_interval = { period_ms / 1000, (long)(period_ms % 1000) * 1000000L },
+    };
+    timerfd_settime(fd, 0, &its, NULL);
+}
+
+// Expirations since the last read (0 if none)
+static uint64_t input_timer_read(int fd) {
+    uint64_t n = 0;
+    if (read(fd, &n, sizeof(n)) != (ssize_t)sizeof(n)) return 0;
+    return n;
+}
+
+// (Re)start or stop the START+SELECT hold timer after either button changed
+static void input_quit_update(void) {
+    input_timer_set(g_input_quit_fd, (g_js_start_down && g_js_select_down) ? INPUT_QUIT_HOLD_MS : 0, 0);
+}
+
+/**
+ * Feed an axis value: a direction acts once when it is entered, then repeats from the
+ * repeat timer while held
+ * 
+ * @param number js axis number
+ * @param value Axis position (-32767..32767)
+ * @return true if it resulted in a keystone adjustment
+ */
+static bool input_axis(int number, int value) {
+    if (number < 0 || number >= ABS_CNT) return false;
+    int dir = value < -INPUT_AXIS_THRESHOLD ? -1 : (value > INPUT_AXIS_THRESHOLD ? 1 : 0);
+    if (dir == g_input_held[number]) return false;
+    g_input_held[number] = (int8_t)dir;
+
+    bool held = false;
+    for (int a = 0; a < ABS_CNT; a++) if (g_input_held[a]) { held = true; break; }
+    if (held && !g_input_repeat_armed) input_timer_set(g_input_repeat_fd, INPUT_REPEAT_MS, INPUT_REPEAT_MS);
+    else if (!held && g_input_repeat_armed) input_timer_set(g_input_repeat_fd, 0, 0);
+    g_input_repeat_armed = held;
+
+    if (!dir) return false;
+    struct js_event e = { .value = (int16_t)(dir * 32767), .type = JS_EVENT_AXIS, .number = (uint8_t)number };
+    return handle_joystick_event(&e);
+}
+
+/**
+ * Repeat every held direction (repeat timer expired)
+ * 
+ * @return true if it resulted in a keystone adjustment
+ */
+static bool input_repeat_fire(void) {
+    bool handled = false;
+    for (int a = 0; a < ABS_CNT; a++) {
+        if (!g_input_held[a]) continue;
+        struct js_event e = { .value = (int16_t)(g_input_held[a] * 32767), .type = JS_EVENT_AXIS, .number = (uint8_t)a };
+        if (handle_joystick_event(&e)) handled = true;
+    }
+    return handled;
+}
+
+// Number buttons and axes the way joydev does: BTN_JOYSTICK..KEY_MAX, then BTN_MISC..
+static void evdev_build_maps(int fd) {
+    unsigned long keys[EVDEV_BITS(KEY_CNT)] = {0}, abs_bits[EVDEV_BITS(ABS_CNT)] = {0};
+    ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys);
+    ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+    memset(g_evdev_btn, 0xff, sizeof(g_evdev_btn));
+    memset(g_evdev_axis, 0xff, sizeof(g_evdev_axis));
+    int nb = 0, na = 0;
+    for (int c = BTN_JOYSTICK; c < KEY_CNT && nb < 0xff; c++)
+        if (evdev_test_bit(keys, c)) g_evdev_btn[c - BTN_MISC] = (uint8_t)nb++;
+    for (int c = BTN_MISC; c < BTN_JOYSTICK && nb < 0xff; c++)
+        if (evdev_test_bit(keys, c)) g_evdev_btn[c - BTN_MISC] = (uint8_t)nb++;
+    for (int c = 0; c < ABS_CNT; c++) {
+        if (!evdev_test_bit(abs_bits, c)) continue;
+        g_evdev_axis[c] = (uint8_t)na++;
+        if (ioctl(fd, EVIOCGABS((unsigned)c), &g_evdev_absinfo[c]) < 0) memset(&g_evdev_absinfo[c], 0, sizeof(g_evdev_absinfo[c]));
+    }
+    memset(g_evdev_keys, 0, sizeof(g_evdev_keys));
+    ioctl(fd, EVIOCGKEY(sizeof(g_evdev_keys)), g_evdev_keys);
+    LOG_DEBUG("evdev controller: %d buttons, %d axes", nb, na);
+}
+
+// Open path as an evdev gamepad (gamepad or joystick buttons); -1 if it is not one
+static int evdev_open_path(const char *path) {
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+    int version;
+    unsigned long keys[EVDEV_BITS(KEY_CNT)] = {0};
+    if (ioctl(fd, EVIOCGVERSION, &version) < 0 || ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0 ||
+        !(evdev_test_bit(keys, BTN_GAMEPAD) || evdev_test_bit(keys, BTN_JOYSTICK))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Find the controller's evdev node: PICKLE_INPUT_DEVICE if set, else the first
+ * /dev/input/event* with gamepad or joystick buttons
+ * 
+ * @param path Receives the device path
+ * @param path_len Size of path
+ * @return The open fd, or -1 to fall back to joydev
+ */
+static int evdev_open(char *path, size_t path_len) {
+    const char *env = getenv("PICKLE_INPUT_DEVICE");
+    if (env && *env) {
+        snprintf(path, path_len, "%s", env);
+        return evdev_open_path(path);
+    }
+    for (int i = 0; i < 32; i++) {
+        snprintf(path, path_len, "/dev/input/event%d", i);
+        int fd = evdev_open_path(path);
+        if (fd >= 0) return fd;
+    }
+    return -1;
+}
+
+// Scale an evdev axis to the joydev range around the centre of its reported extent
+static int evdev_axis_value(int code, int32_t v) {
+    const struct input_absinfo *ai = &g_evdev_absinfo[code];
+    int64_t span = (int64_t)ai->maximum - ai->minimum;
+    if (span <= 0) return 0;
+    int64_t out = (2 * (int64_t)v - ai->minimum - ai->maximum) * 32767 / span;
+    return (int)(out < -32767 ? -32767 : (out > 32767 ? 32767 : out));
+}
+
+static void evdev_frame_key(int code, int value) {
+    if (code < BTN_MISC || code >= KEY_CNT || value == 2) return; // 2: key autorepeat
+    size_t u = (size_t)code;
+    unsigned long bit = 1UL << (u % EVDEV_LONG_BITS);
+    if (value) g_evdev_keys[u / EVDEV_LONG_BITS] |= bit;
+    else g_evdev_keys[u / EVDEV_LONG_BITS] &= ~bit;
+    uint8_t number = g_evdev_btn[code - BTN_MISC];
+    int max = (int)(sizeof(g_evdev_frame.btn) / sizeof(g_evdev_frame.btn[0]));
+    if (number == 0xff || g_evdev_frame.nbtn >= max) return;
+    g_evdev_frame.btn[g_evdev_frame.nbtn].number = number;
+    g_evdev_frame.btn[g_evdev_frame.nbtn].value = (int16_t)(value ? 1 : 0);
+    g_evdev_frame.nbtn++;
+}
+
+// After SYN_DROPPED the events in between are lost: diff the device state against ours
+static void evdev_resync(int fd) {
+    unsigned long keys[EVDEV_BITS(KEY_CNT)] = {0};
+    g_evdev_frame.nbtn = 0;
+    g_evdev_frame.abs_set = 0;
+    if (ioctl(fd, EVIOCGKEY(sizeof(keys)), keys) >= 0) {
+        for (int c = BTN_MISC; c < KEY_CNT; c++) {
+            int down = evdev_test_bit(keys, c);
+            if (down != evdev_test_bit(g_evdev_keys, c)) evdev_frame_key(c, down);
+        }
+    }
+    for (int c = 0; c < ABS_CNT; c++) {
+        struct input_absinfo ai;
+        if (g_evdev_axis[c] == 0xff || ioctl(fd, EVIOCGABS((unsigned)c), &ai) < 0) continue;
+        g_evdev_frame.abs[c] = ai.value;
+        g_evdev_frame.abs_set |= 1ULL << c;
+    }
+    LOG_DEBUG("evdev: events dropped, controller state resynced");
+}
+
+// Hand one SYN_REPORT frame to the joystick handler: buttons in order, then each moved axis once
+static bool evdev_frame_end(void) {
+    bool handled = false;
+    for (int i = 0; i < g_evdev_frame.nbtn; i++) {
+        struct js_event e = { .value = g_evdev_frame.btn[i].value, .type = JS_EVENT_BUTTON,
+                              .number = g_evdev_frame.btn[i].number };
+        if (handle_joystick_event(&e)) handled = true;
+    }
+    for (int c = 0; c < ABS_CNT; c++) {
+        if (!((g_evdev_frame.abs_set >> c) & 1) || g_evdev_axis[c] == 0xff) continue;
+        if (input_axis(g_evdev_axis[c], evdev_axis_value(c, g_evdev_frame.abs[c]))) handled = true;
+    }
+    g_evdev_frame.nbtn = 0;
+    g_evdev_frame.abs_set = 0;
+    return handled;
+}
+
+/**
+ * Read all pending evdev events, handling each completed SYN_REPORT frame
+ * 
+ * @return true if any resulted in a keystone adjustment
+ */
+static bool evdev_read(void) {
+    struct input_event ev[64];
+    bool handled = false;
+    ssize_t r;
+    while ((r = read(g_joystick_fd, ev, sizeof(ev))) >= (ssize_t)sizeof(ev[0])) {
+        size_t count = (size_t)r / sizeof(ev[0]);
+        for (size_t i = 0; i < count; i++) {
+            const struct input_event *e = &ev[i];
+            if (e->type == EV_SYN && e->code == SYN_DROPPED) {
+                g_evdev_frame.dropped = true;
+            } else if (e->type == EV_SYN && e->code == SYN_REPORT) {
+                if (g_evdev_frame.dropped) {
+                    g_evdev_frame.dropped = false;
+                    evdev_resync(g_joystick_fd);
+                }
+                if (evdev_frame_end()) handled = true;
+            } else if (g_evdev_frame.dropped) {
+                continue;
+            } else if (e->type == EV_KEY) {
+                evdev_frame_key(e->code, e->value);
+            } else if (e->type == EV_ABS && e->code < ABS_CNT) {
+                g_evdev_frame.abs[e->code] = e->value;
+                g_evdev_frame.abs_set |= 1ULL << e->code;
+            }
+        }
+    }
+    if (r < 0 && errno == ENODEV) {
+        LOG_WARN("Controller disconnected: %s", g_joystick_name);
+        cleanup_joystick();
+    }
+    return handled;
+}
+
+// Buttons on the joydev path keep a 100ms debounce
+static bool js_debounce(void) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    long time_diff_ms = (now.tv_sec - g_last_js_event_time.tv_sec) * 1000 + 
+                       (now.tv_usec - g_last_js_event_time.tv_usec) / 1000;
+    if (time_diff_ms < 100) return false;
+    g_last_js_event_time = now;
+    return true;
+}
+
+/**
+ * Read all pending joydev events
  * 
- * @param path The file path to save the configuration to
- * @return true if the configuration was saved successfully, false otherwise
+ * @return true if any resulted in a keystone adjustment
  */
-static bool keystone_save_config(const char* path) {
-    if (!path) return false;
-    
-    FILE* f = fopen(path, "w");
-    if (!f) {
-        LOG_ERROR("Failed to open file for writing: %s (%s)", path, strerror(errno));
-        return false;
-    }
-    
-    fprintf(f, "# Pickle keystone configuration\n");
-    fprintf(f, "enabled=%d\n", g_keystone.enabled ? 1 : 0);
-    fprintf(f, "mesh_enabled=%d\n", g_keystone.mesh_enabled ? 1 : 0);
-    fprintf(f, "mesh_size=%d\n", g_keystone.mesh_size);
-    
-    // Save the corner points
-    for (int i = 0; i < 4; i++) {
-        fprintf(f, "corner%d=%.6f,%.6f\n", i+1, g_keystone.points[i][0], g_keystone.points[i][1]);
-        fprintf(f, "pin%d=%d\n", i+1, g_keystone.perspective_pins[i] ? 1 : 0);
-    }
-    
-    // Save border and corner marker settings
-    fprintf(f, "border=%d\n", g_show_border ? 1 : 0);
-    fprintf(f, "cornermarks=%d\n", g_show_corner_markers ? 1 : 0);
-    
-    // Save mesh points if mesh warping is enabled
-    if (g_keystone.mesh_enabled && g_keystone.mesh_points) {
-        for (int i = 0; i < g_keystone.mesh_size; i++) {
-            for (int j = 0; j < g_keystone.mesh_size; j++) {
-                if (g_keystone.mesh_points[i]) {
-                    fprintf(f, "mesh_%d_%d=%.6f,%.6f\n", i, j, 
-                            g_keystone.mesh_points[i][j*2],
-                            g_keystone.mesh_points[i][j*2+1]);
-                }
-            }
+static bool joydev_read(void) {
+    struct js_event event;
+    bool handled = false;
+    ssize_t r;
+    while ((r = read(g_joystick_fd, &event, sizeof(event))) == (ssize_t)sizeof(event)) {
+        // Skip initial state events sent when joystick is first opened
+        if (event.type & JS_EVENT_INIT) continue;
+        if (event.type == JS_EVENT_AXIS) {
+            if (input_axis(event.number, event.value)) handled = true;
+        } else if (js_debounce() && handle_joystick_event(&event)) {
+            handled = true;
         }
     }
-    
-    fclose(f);
-    
-    return true;
+    if (r < 0 && errno == ENODEV) {
+        LOG_WARN("Controller disconnected: %s", g_joystick_name);
+        cleanup_joystick();
+    }
+    return handled;
 }
 
 /**
@@ -2836,22 +7519,35 @@ static bool keystone_save_config(const char* path) {
  * @return true if a joystick was found and initialized
  */
 static bool init_joystick(void) {
-    // Try to open joystick device
-    const char *device = "/dev/input/js0";
-    g_joystick_fd = open(device, O_RDONLY | O_NONBLOCK);
-    
-    if (g_joystick_fd < 0) {
-        LOG_WARN("Could not open joystick at %s: %s", device, strerror(errno));
-        return false;
-    }
-    
-    // Get joystick name
-    if (ioctl(g_joystick_fd, JSIOCGNAME(sizeof(g_joystick_name)), g_joystick_name) < 0) {
-        strcpy(g_joystick_name, "Unknown Controller");
+    // Prefer an evdev node; joydev (or a PICKLE_INPUT_DEVICE that is not evdev) otherwise
+    char device[64];
+    g_joystick_fd = evdev_open(device, sizeof(device));
+    g_input_evdev = g_joystick_fd >= 0;
+    if (g_input_evdev) {
+        if (ioctl(g_joystick_fd, EVIOCGNAME(sizeof(g_joystick_name)), g_joystick_name) < 0) {
+            strcpy(g_joystick_name, "Unknown Controller");
+        }
+        evdev_build_maps(g_joystick_fd);
+    } else {
+        const char *env = getenv("PICKLE_INPUT_DEVICE");
+        snprintf(device, sizeof(device), "%s", (env && *env) ? env : "/dev/input/js0");
+        g_joystick_fd = open(device, O_RDONLY | O_NONBLOCK);
+        
+        if (g_joystick_fd < 0) {
+            LOG_WARN("Could not open joystick at %s: %s", device, strerror(errno));
+            return false;
+        }
+        
+        // Get joystick name
+        if (ioctl(g_joystick_fd, JSIOCGNAME(sizeof(g_joystick_name)), g_joystick_name) < 0) {
+            strcpy(g_joystick_name, "Unknown Controller");
+        }
     }
     
-    LOG_INFO("Joystick initialized: %s", g_joystick_name);
+    LOG_INFO("Joystick initialized: %s (%s, %s)", g_joystick_name, device, g_input_evdev ? "evdev" : "joydev");
     g_joystick_enabled = true;
+    g_input_quit_fd = input_timer_create();
+    g_input_repeat_fd = input_timer_create();
     
     // Initialize the first corner as selected
     g_selected_corner = 0;
@@ -2888,6 +7584,12 @@ static void cleanup_joystick(void) {
         close(g_joystick_fd);
         g_joystick_fd = -1;
     }
+    if (g_input_quit_fd >= 0) { close(g_input_quit_fd); g_input_quit_fd = -1; }
+    if (g_input_repeat_fd >= 0) { close(g_input_repeat_fd); g_input_repeat_fd = -1; }
+    memset(g_input_held, 0, sizeof(g_input_held));
+    g_input_repeat_armed = false;
+    g_js_start_down = g_js_select_down = false;
+    g_input_evdev = false;
     g_joystick_enabled = false;
 }
 
@@ -2899,21 +7601,6 @@ static void cleanup_joystick(void) {
  * @return true if the event was handled and resulted in a keystone adjustment
  */
 static bool handle_joystick_event(struct js_event *event) {
-    // Debounce to prevent too many events
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    long time_diff_ms = (now.tv_sec - g_last_js_event_time.tv_sec) * 1000 + 
-                       (now.tv_usec - g_last_js_event_time.tv_usec) / 1000;
-    
-    // Require 100ms between events for buttons, 250ms for analog sticks
-    int min_ms = (event->type == JS_EVENT_BUTTON) ? 100 : 250;
-    if (time_diff_ms < min_ms) {
-        return false;
-    }
-    
-    // Track timestamp for debouncing
-    g_last_js_event_time = now;
-    
     // Skip initial state events sent when joystick is first opened
     if (event->type & JS_EVENT_INIT) {
         return false;
@@ -2921,13 +7608,16 @@ static bool handle_joystick_event(struct js_event *event) {
     
 	// Handle button events
 	if (event->type == JS_EVENT_BUTTON) {
+		// Anything but a d-pad move acts on the corners as moved so far in this batch
+		if (event->number < JS_BUTTON_DPAD_UP || event->number > JS_BUTTON_DPAD_RIGHT) input_flush_moves();
+
 		// Track Start/Select state for quit combo
 		if (event->number == JS_BUTTON_START) {
-			if (event->value == 1) { g_js_start_down = true; gettimeofday(&g_js_start_time, NULL); }
-			else if (event->value == 0) { g_js_start_down = false; }
+			g_js_start_down = event->value == 1;
+			input_quit_update();
 		} else if (event->number == JS_BUTTON_SELECT) {
-			if (event->value == 1) { g_js_select_down = true; gettimeofday(&g_js_select_time, NULL); }
-			else if (event->value == 0) { g_js_select_down = false; }
+			g_js_select_down = event->value == 1;
+			input_quit_update();
 		}
 
 		// If keystone enabled and cycle button is pressed, optionally cycle corners TL->TR->BR->BL
@@ -3085,7 +7775,7 @@ static bool handle_joystick_event(struct js_event *event) {
 			case JS_BUTTON_DPAD_LEFT:
 				if (g_keystone.enabled) {
 					float step = (float)g_keystone_adjust_step / 1000.0f;
-					keystone_adjust_corner(g_keystone.active_corner, -step, 0.0f);
+					input_queue_move(-step, 0.0f);
 					LOG_INFO("Moving corner %d left (dpad button)", g_keystone.active_corner + 1);
 					return true;
 				}
@@ -3093,7 +7783,7 @@ static bool handle_joystick_event(struct js_event *event) {
 			case JS_BUTTON_DPAD_RIGHT:
 				if (g_keystone.enabled) {
 					float step = (float)g_keystone_adjust_step / 1000.0f;
-					keystone_adjust_corner(g_keystone.active_corner, step, 0.0f);
+					input_queue_move(step, 0.0f);
 					LOG_INFO("Moving corner %d right (dpad button)", g_keystone.active_corner + 1);
 					return true;
 				}
@@ -3101,7 +7791,7 @@ static bool handle_joystick_event(struct js_event *event) {
 			case JS_BUTTON_DPAD_UP:
 				if (g_keystone.enabled) {
 					float step = (float)g_keystone_adjust_step / 1000.0f;
-					keystone_adjust_corner(g_keystone.active_corner, 0.0f, -step);
+					input_queue_move(0.0f, -step);
 					LOG_INFO("Moving corner %d up (dpad button)", g_keystone.active_corner + 1);
 					return true;
 				}
@@ -3109,7 +7799,7 @@ static bool handle_joystick_event(struct js_event *event) {
 			case JS_BUTTON_DPAD_DOWN:
 				if (g_keystone.enabled) {
 					float step = (float)g_keystone_adjust_step / 1000.0f;
-					keystone_adjust_corner(g_keystone.active_corner, 0.0f, step);
+					input_queue_move(0.0f, step);
 					LOG_INFO("Moving corner %d down (dpad button)", g_keystone.active_corner + 1);
 					return true;
 				}
@@ -3135,22 +7825,22 @@ static bool handle_joystick_event(struct js_event *event) {
         // D-pad or left analog stick
         if ((event->number == JS_AXIS_DPAD_X || event->number == JS_AXIS_LEFT_X) && abs(event->value) > 16384) {
             if (event->value < 0) {  // Left
-                keystone_adjust_corner(g_keystone.active_corner, -step, 0.0f);
+                input_queue_move(-step, 0.0f);
                 LOG_INFO("Moving corner %d left", g_keystone.active_corner + 1);
                 return true;
             } else {  // Right
-                keystone_adjust_corner(g_keystone.active_corner, step, 0.0f);
+                input_queue_move(step, 0.0f);
                 LOG_INFO("Moving corner %d right", g_keystone.active_corner + 1);
                 return true;
             }
         }
         else if ((event->number == JS_AXIS_DPAD_Y || event->number == JS_AXIS_LEFT_Y) && abs(event->value) > 16384) {
             if (event->value < 0) {  // Up
-                keystone_adjust_corner(g_keystone.active_corner, 0.0f, -step);
+                input_queue_move(0.0f, -step);
                 LOG_INFO("Moving corner %d up", g_keystone.active_corner + 1);
                 return true;
             } else {  // Down
-                keystone_adjust_corner(g_keystone.active_corner, 0.0f, step);
+                input_queue_move(0.0f, step);
                 LOG_INFO("Moving corner %d down", g_keystone.active_corner + 1);
                 return true;
             }
@@ -3163,7 +7853,6 @@ static bool handle_joystick_event(struct js_event *event) {
 // Removed const from drm_ctx parameter because drmModeSetCrtc expects a non-const drmModeModeInfoPtr.
 // We cache framebuffer IDs per gbm_bo to avoid per-frame AddFB/RmFB churn.
 // user data holds a small struct with fb id + drm fd and a destroy handler.
-static int g_scanout_disabled = 0; // when set, we skip page flips/modeset and just let mpv decode & render offscreen
 struct fb_holder { uint32_t fb; int fd; };
 static void bo_destroy_handler(struct gbm_bo *bo, void *data) {
 	(void)bo;
@@ -3174,399 +7863,636 @@ static void bo_destroy_handler(struct gbm_bo *bo, void *data) {
 	}
 }
 
+// Delete every level of an FBO pool
+static void fbo_pool_destroy(fbo_pool_t *pool) {
+	for (int l = 0; l < GOV_LEVELS; l++) {
+		if (pool->fbo[l]) { glDeleteFramebuffers(1, &pool->fbo[l]); pool->fbo[l] = 0; }
+		if (pool->tex[l]) { glDeleteTextures(1, &pool->tex[l]); pool->tex[l] = 0; }
+		pool->w[l] = pool->h[l] = 0;
+	}
+	atomic_fetch_sub(&g_mem_fbo_bytes, pool->bytes);
+	pool->bytes = 0;
+	pool->base_w = pool->base_h = 0;
+	pool->levels = 0;
+	gl_state_invalidate(); // deleted names may come back from glGenTextures
+}
+
 /**
- * Update a video instance's FBO by rendering from mpv
- * This is the expensive operation we want to do less frequently in dual-video mode
+ * Level size of an offscreen target. In low-memory mode the pool holds a single level
+ * at the governor's current scale, capped at LOW_MEM_FBO_MAX_PX.
  */
-static bool update_video_fbo(video_instance_t *inst, int screen_w, int screen_h) {
-	if (!inst || !inst->player || !inst->player->rctx) return false;
-	
-	mpv_player_t *p = inst->player;
-	
-	// In dual-video mode, use quarter resolution to reduce GPU load significantly
-	// mpv renders at 960x540, keystone shader upscales to screen
-	// This reduces pixel fill by 75% per video
-	int want_w = screen_w;
-	int want_h = screen_h;
-	if (g_num_videos > 1) {
-		want_w = screen_w / 2;
-		want_h = screen_h / 2;  // Quarter resolution (half width × half height)
-	}
-	bool need_recreate = (inst->fbo == 0) || (inst->fbo_w != want_w) || (inst->fbo_h != want_h);
-	if (need_recreate) {
-		if (inst->fbo) {
-			glDeleteFramebuffers(1, &inst->fbo);
-			inst->fbo = 0;
-		}
-		if (inst->fbo_texture) {
-			glDeleteTextures(1, &inst->fbo_texture);
-			inst->fbo_texture = 0;
-		}
-		glGenTextures(1, &inst->fbo_texture);
-		glBindTexture(GL_TEXTURE_2D, inst->fbo_texture);
-		// Use LINEAR filtering for smooth upscaling from quarter-res FBO
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+static void fbo_level_size(int base_w, int base_h, int level, int *w_out, int *h_out) {
+	float scale = g_gov_scales[level];
+	if (g_low_mem && (double)base_w * base_h * scale * scale > LOW_MEM_FBO_MAX_PX)
+		scale = sqrtf((float)LOW_MEM_FBO_MAX_PX / ((float)base_w * (float)base_h));
+	int w = (int)((float)base_w * scale) & ~1;
+	int h = (int)((float)base_h * scale) & ~1;
+	*w_out = w < 16 ? 16 : w;
+	*h_out = h < 16 ? 16 : h;
+}
+
+// Pool level holding the governor's current scale
+static int fbo_pool_level(const fbo_pool_t *pool) {
+	return pool->levels > 1 ? g_gov.level : 0;
+}
+
+// Allocate every level of an empty pool in g_fbo_formats[pool->format]
+static bool fbo_pool_alloc(fbo_pool_t *pool, int base_w, int base_h, int screen_w, int screen_h, const char *what) {
+	const fbo_format_t *fmt = &g_fbo_formats[pool->format];
+	int levels = g_low_mem ? 1 : GOV_LEVELS;
+	for (int l = 0; l < levels; l++) {
+		int w, h;
+		fbo_level_size(base_w, base_h, g_low_mem ? g_gov.level : l, &w, &h);
+		GLint filter = (w == screen_w && h == screen_h) ? GL_NEAREST : GL_LINEAR; // LINEAR to upscale smaller levels
+		glGenTextures(1, &pool->tex[l]);
+		glBindTexture(GL_TEXTURE_2D, pool->tex[l]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, want_w, want_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-		
-		glGenFramebuffers(1, &inst->fbo);
-		glBindFramebuffer(GL_FRAMEBUFFER, inst->fbo);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, inst->fbo_texture, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, (GLint)fmt->format, w, h, 0, fmt->format, fmt->type, NULL);
 		
+		glGenFramebuffers(1, &pool->fbo[l]);
+		glBindFramebuffer(GL_FRAMEBUFFER, pool->fbo[l]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pool->tex[l], 0);
 		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 		if (status != GL_FRAMEBUFFER_COMPLETE) {
-			LOG_ERROR("Instance %d FBO setup failed, status: %d", inst->index, status);
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
-			glDeleteFramebuffers(1, &inst->fbo);
-			glDeleteTextures(1, &inst->fbo_texture);
-			inst->fbo = 0;
-			inst->fbo_texture = 0;
+			LOG_WARN("%s FBO setup failed at %dx%d %s, status: %d", what, w, h, fmt->name, status);
+			glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
+			fbo_pool_destroy(pool);
+			return false;
+		}
+		pool->w[l] = w;
+		pool->h[l] = h;
+		uint64_t bytes = (uint64_t)w * (uint64_t)h * (uint64_t)fmt->bytes;
+		pool->bytes += bytes;
+		pool->levels = l + 1;
+		atomic_fetch_add(&g_mem_fbo_bytes, bytes);
+	}
+	pool->gov_level = g_gov.level;
+	uint64_t total = atomic_load(&g_mem_fbo_bytes);
+	if (total > atomic_load(&g_mem_fbo_peak)) atomic_store(&g_mem_fbo_peak, total);
+	glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
+	gl_state_invalidate(); // level textures were bound on whichever unit was active
+	return true;
+}
+
+/**
+ * Whether a pool must be rebuilt by fbo_pool_ensure(): another base size, a format since
+ * dropped, or (single-level low-memory pools) sized for another governor level.
+ */
+static bool fbo_pool_stale(const fbo_pool_t *pool, int base_w, int base_h) {
+	return pool->base_w != base_w || pool->base_h != base_h || pool->format != g_fbo_format ||
+	       (pool->levels == 1 && pool->gov_level != g_gov.level);
+}
+
+/**
+ * Make sure an FBO pool exists for a base size in the current target format. All
+ * GOV_LEVELS sizes are allocated here, so governor steps only switch between existing
+ * textures. A format the driver cannot render to is dropped for the next one in
+ * g_fbo_formats, for this and every later pool.
+ *
+ * @param pool Pool to (re)build; unchanged if it already has this base size and format
+ * @param base_w,base_h Level 0 size
+ * @param screen_w,screen_h Screen size (a 1:1 level samples with GL_NEAREST)
+ * @param what Name for log messages
+ * @return false if a level could not be set up (pool left empty)
+ */
+static bool fbo_pool_ensure(fbo_pool_t *pool, int base_w, int base_h, int screen_w, int screen_h, const char *what) {
+	if (!fbo_pool_stale(pool, base_w, base_h)) return true;
+	fbo_pool_destroy(pool);
+	for (;;) {
+		pool->format = g_fbo_format;
+		if (fbo_pool_alloc(pool, base_w, base_h, screen_w, screen_h, what)) break;
+		if (g_fbo_format == FBO_FORMATS - 1) {
+			LOG_ERROR("%s FBO setup failed", what);
 			return false;
 		}
-		inst->fbo_w = want_w;
-		inst->fbo_h = want_h;
+		g_fbo_format++;
+		LOG_WARN("Offscreen targets fall back to %s", g_fbo_formats[g_fbo_format].name);
+	}
+	pool->base_w = base_w;
+	pool->base_h = base_h;
+	LOG_GL("%s FBO pool %dx%d (down to %dx%d), %s, %.1f MB", what, pool->w[0], pool->h[0], pool->w[pool->levels - 1],
+	       pool->h[pool->levels - 1], g_fbo_formats[pool->format].name, (double)pool->bytes / 1e6);
+	return true;
+}
+
+/**
+ * Render mpv into a level of an FBO pool. If mpv rejects the target format, later
+ * pools use the next format in g_fbo_formats (their next fbo_pool_ensure rebuilds them).
+ * Counts the write and the warp pass's read of the target in the FBO traffic stats.
+ *
+ * @param p Player to render
+ * @param pool Pool the target belongs to
+ * @param fbo,w,h Target level
+ * @param flip_y MPV_RENDER_PARAM_FLIP_Y
+ * @return mpv_render_context_render() result
+ */
+static int fbo_pool_render_mpv(mpv_player_t *p, const fbo_pool_t *pool, GLuint fbo, int w, int h, int flip_y) {
+	const fbo_format_t *fmt = &g_fbo_formats[pool->format];
+	mpv_opengl_fbo mpv_fbo = { .fbo = (int)fbo, .w = w, .h = h, .internal_format = (int)fmt->internal };
+	mpv_render_param r_params[] = {
+		{MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
+		{MPV_RENDER_PARAM_FLIP_Y, &flip_y},
+		{MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &g_mpv_block_for_target},
+		{0}
+	};
+	int rc = mpv_render_context_render(p->rctx, r_params);
+	gl_state_invalidate(); // mpv leaves its own program, textures and blend state bound
+	if (rc < 0 && pool->format == g_fbo_format && g_fbo_format < FBO_FORMATS - 1) {
+		g_fbo_format++;
+		LOG_WARN("mpv cannot render to %s targets (%s); falling back to %s", fmt->name, mpv_error_string(rc),
+		         g_fbo_formats[g_fbo_format].name);
+	}
+	uint64_t px = (uint64_t)w * (uint64_t)h * 2; // written by mpv, read back by the warp pass
+	atomic_fetch_add_explicit(&g_stats_fbo_bytes, px * (uint64_t)fmt->bytes, memory_order_relaxed);
+	atomic_fetch_add_explicit(&g_stats_fbo_saved, px * (uint64_t)(4 - fmt->bytes), memory_order_relaxed);
+	return rc;
+}
+
+/**
+ * Split the multi-video FBO pixel budget (g_mv_fbo_budget x screen pixels) between
+ * instances in proportion to the screen area their keystone quads cover. Each FBO
+ * keeps the screen's aspect ratio and is scaled in 1/16 steps; an instance is only
+ * resized once its scale moves by two steps, so dragging a corner does not keep
+ * reallocating its FBOs. Two half-screen videos get a
+ * quarter-resolution FBO each (960x540 at 1080p).
+ */
+static void mv_assign_fbo_budgets(int screen_w, int screen_h) {
+	float area[MAX_VIDEOS], total = 0.0f;
+	for (int i = 0; i < g_num_videos; i++) {
+		const keystone_t *ks = &g_rs->video[i].ks;
+		float x0 = 1.0f, x1 = 0.0f, y0 = 1.0f, y1 = 0.0f;
+		for (int c = 0; c < 4; c++) {
+			x0 = fminf(x0, ks->points[c][0]); x1 = fmaxf(x1, ks->points[c][0]);
+			y0 = fminf(y0, ks->points[c][1]); y1 = fmaxf(y1, ks->points[c][1]);
+		}
+		// On-screen part of the quad's bounding box (never zero, so every instance gets pixels)
+		float w = fminf(x1, 1.0f) - fmaxf(x0, 0.0f), h = fminf(y1, 1.0f) - fmaxf(y0, 0.0f);
+		area[i] = fmaxf(w, 0.05f) * fmaxf(h, 0.05f);
+		total += area[i];
+	}
+	for (int i = 0; i < g_num_videos; i++) {
+		float share = g_mv_fbo_budget * area[i] / total; // fraction of full-screen pixels
+		// Never above the source resolution (the governor scales down from here)
+		float scale = gov_base_scale(g_videos[i].player, share >= 1.0f ? 1.0f : sqrtf(share), screen_w, screen_h);
+		// Hysteresis: a one-step change keeps the current size, so a share hovering
+		// around a step boundary does not re-create the pool on every corner nudge
+		if (g_videos[i].fbo_want_w > 0 && g_videos[i].fbo_want_w <= screen_w) {
+			float cur = (float)g_videos[i].fbo_want_w / (float)screen_w;
+			if (fabsf(scale - cur) < 1.5f / 16.0f) continue;
+		}
+		g_videos[i].fbo_want_w = (int)((float)screen_w * scale) & ~1;
+		g_videos[i].fbo_want_h = (int)((float)screen_h * scale) & ~1;
+	}
+}
+
+/**
+ * Update a video instance's FBO by rendering from mpv
+ * This is the expensive operation the multi-video scheduler rations per composite
+ */
+static bool update_video_fbo(video_instance_t *inst, int screen_w, int screen_h) {
+	if (!inst || !inst->player || !inst->player->rctx) return false;
+	
+	mpv_player_t *p = inst->player;
+	
+	// Multi-video: render at the instance's share of the pixel budget, scaled by the
+	// governor level; the keystone shader upscales to screen
+	int want_w = inst->fbo_want_w > 0 ? inst->fbo_want_w : screen_w;
+	int want_h = inst->fbo_want_h > 0 ? inst->fbo_want_h : screen_h;
+	if (fbo_pool_stale(&inst->pool, want_w, want_h)) {
+		inst->fbo = inst->fbo_texture = 0; // the old pool's textures go away
+		char what[32];
+		snprintf(what, sizeof(what), "Instance %d", inst->index);
+		if (!fbo_pool_ensure(&inst->pool, want_w, want_h, screen_w, screen_h, what)) return false;
 	}
+	// The new level becomes visible only once it holds this frame
+	int level = fbo_pool_level(&inst->pool);
+	inst->fbo = inst->pool.fbo[level];
+	inst->fbo_texture = inst->pool.tex[level];
+	inst->fbo_w = inst->pool.w[level];
+	inst->fbo_h = inst->pool.h[level];
 	
 	// Render mpv to this instance's FBO
 	glBindFramebuffer(GL_FRAMEBUFFER, inst->fbo);
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);  // Transparent black
 	glClear(GL_COLOR_BUFFER_BIT);
 	
-	mpv_opengl_fbo mpv_fbo = { .fbo = (int)inst->fbo, .w = inst->fbo_w, .h = inst->fbo_h, .internal_format = 0 };
-	int mpv_flip_y = 0;
-	mpv_render_param r_params[] = {
-		{MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
-		{MPV_RENDER_PARAM_FLIP_Y, &mpv_flip_y},
-		{0}
-	};
-	mpv_render_context_render(p->rctx, r_params);
+	fbo_pool_render_mpv(p, &inst->pool, inst->fbo, inst->fbo_w, inst->fbo_h, 0);
 	
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
 	return true;
 }
 
-// Render both videos (already composed by lavfi) into a single composite FBO
-static bool update_composite_fbo(mpv_player_t *p, int screen_w, int screen_h) {
+// Render both videos (already composed by lavfi) into a single composite FBO; without
+// video damage the FBO keeps the last mpv frame and mpv is not asked to render again
+static bool update_composite_fbo(mpv_player_t *p, int screen_w, int screen_h, bool video) {
+	static GLuint rendered = 0; // FBO holding the last mpv frame (0 = none)
 	if (!p || !p->rctx) return false;
 
 	// Composite output at half height to reduce fill; width matches screen for keystone mapping
-	int want_w = screen_w;
-	int want_h = screen_h / 2; // 1920x540 for 1080p
-	bool need_recreate = (g_composite_fbo == 0) || (g_composite_w != want_w) || (g_composite_h != want_h);
-	if (need_recreate) {
-		if (g_composite_fbo) { glDeleteFramebuffers(1, &g_composite_fbo); g_composite_fbo = 0; }
-		if (g_composite_texture) { glDeleteTextures(1, &g_composite_texture); g_composite_texture = 0; }
-		glGenTextures(1, &g_composite_texture);
-		glBindTexture(GL_TEXTURE_2D, g_composite_texture);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, want_w, want_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-
-		glGenFramebuffers(1, &g_composite_fbo);
-		glBindFramebuffer(GL_FRAMEBUFFER, g_composite_fbo);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_composite_texture, 0);
-		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-		if (status != GL_FRAMEBUFFER_COMPLETE) {
-			LOG_ERROR("Composite FBO setup failed, status: %d", status);
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
-			glDeleteFramebuffers(1, &g_composite_fbo);
-			glDeleteTextures(1, &g_composite_texture);
-			g_composite_fbo = 0; g_composite_texture = 0;
-			return false;
-		}
-		g_composite_w = want_w;
-		g_composite_h = want_h;
+	// (1920x540 for 1080p), capped at the lavfi output size and scaled by the governor
+	float scale = gov_base_scale(p, 1.0f, screen_w, screen_h / 2);
+	int want_w = (int)((float)screen_w * scale) & ~1;
+	int want_h = (int)((float)(screen_h / 2) * scale) & ~1;
+	if (fbo_pool_stale(&g_composite_pool, want_w, want_h)) {
+		g_composite_fbo = g_composite_texture = 0;
+		rendered = 0;
+		if (!fbo_pool_ensure(&g_composite_pool, want_w, want_h, screen_w, screen_h, "Composite")) return false;
+	}
+	int level = fbo_pool_level(&g_composite_pool);
+	g_composite_fbo = g_composite_pool.fbo[level];
+	g_composite_texture = g_composite_pool.tex[level];
+	g_composite_w = g_composite_pool.w[level];
+	g_composite_h = g_composite_pool.h[level];
+	if (!video && rendered == g_composite_fbo) {
+		atomic_fetch_add(&g_stats_composed, 1);
+		return true;
 	}
+	rendered = g_composite_fbo;
 
 	glBindFramebuffer(GL_FRAMEBUFFER, g_composite_fbo);
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	mpv_opengl_fbo mpv_fbo = { .fbo = (int)g_composite_fbo, .w = g_composite_w, .h = g_composite_h, .internal_format = 0 };
-	int mpv_flip_y = 0;
-	mpv_render_param r_params[] = {
-		{MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
-		{MPV_RENDER_PARAM_FLIP_Y, &mpv_flip_y},
-		{0}
-	};
-	mpv_render_context_render(p->rctx, r_params);
+	fbo_pool_render_mpv(p, &g_composite_pool, g_composite_fbo, g_composite_w, g_composite_h, 0);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
 	return true;
 }
 
 /**
  * Render the keystone quad for a video instance using its cached FBO texture
- * This is cheap and can be done every frame
+ * This is cheap and can be done every frame (mesh warps, soft edges and unbatched fallback)
  */
-static bool render_keystone_quad(video_instance_t *inst, int screen_w, int screen_h) {
+static bool render_keystone_quad(video_instance_t *inst) {
 	if (!inst || inst->fbo_texture == 0) return false;
 	
-	keystone_t *ks = &inst->keystone;
+	keystone_t *ks = &g_rs->video[inst->index].ks; // render thread's snapshot of inst->keystone
 	
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	
-	glUseProgram(g_keystone_shader_program);
-	
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, inst->fbo_texture);
-	glUniform1i(g_keystone_u_texture_loc, 0);
-	
-	// Convert keystone points to clip space
-	float vertices[] = {
-		ks->points[0][0] * 2.0f - 1.0f, 1.0f - (ks->points[0][1] * 2.0f),  // Top left 
-		ks->points[1][0] * 2.0f - 1.0f, 1.0f - (ks->points[1][1] * 2.0f),  // Top right
-		ks->points[3][0] * 2.0f - 1.0f, 1.0f - (ks->points[3][1] * 2.0f),  // Bottom left 
-		ks->points[2][0] * 2.0f - 1.0f, 1.0f - (ks->points[2][1] * 2.0f)   // Bottom right
-	};
+	gl_set_blend(true);
 	
 	float u0 = inst->use_subrect ? inst->u0 : 0.0f;
 	float u1 = inst->use_subrect ? inst->u1 : 1.0f;
 	float v0 = inst->use_subrect ? inst->v0 : 0.0f;
 	float v1 = inst->use_subrect ? inst->v1 : 1.0f;
-	float texcoords[] = {
-		u0, v0,  // Top left
-		u1, v0,  // Top right
-		u0, v1,  // Bottom left
-		u1, v1   // Bottom right
-	};
 	
-	glEnableVertexAttribArray((GLuint)g_keystone_a_position_loc);
-	glBindBuffer(GL_ARRAY_BUFFER, g_keystone_vertex_buffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-	glVertexAttribPointer((GLuint)g_keystone_a_position_loc, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	keystone_use_program(ks, &inst->blend, inst->fbo_texture, u0, u1, v0, v1);
 	
-	if (g_keystone_texcoord_buffer == 0) {
-		glGenBuffers(1, &g_keystone_texcoord_buffer);
+	if (!ks->mesh_enabled || !mesh_geom_draw(&inst->mesh, ks, u0, u1, v0, v1)) {
+		quad_geom_draw(&inst->quad, ks, u0, u1, v0, v1);
 	}
-	glBindBuffer(GL_ARRAY_BUFFER, g_keystone_texcoord_buffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_DYNAMIC_DRAW);
-	glEnableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
-	glVertexAttribPointer((GLuint)g_keystone_a_texcoord_loc, 2, GL_FLOAT, GL_FALSE, 0, 0);
-	
-	if (g_keystone_index_buffer == 0) {
-		GLushort indices[] = {0, 1, 2, 2, 1, 3};
-		glGenBuffers(1, &g_keystone_index_buffer);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_keystone_index_buffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-	} else {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_keystone_index_buffer);
+	return true;
+}
+
+/**
+ * Deadline of an instance's pending frame: mpv's target display time when it
+ * publishes one (MPV_RENDER_PARAM_NEXT_FRAME_INFO), else when the frame arrived.
+ */
+static int64_t mv_frame_deadline_us(video_instance_t *inst, int64_t now) {
+	mpv_player_t *p = inst->player;
+	if (p && p->rctx && p->mpv) {
+		mpv_render_frame_info info = {0};
+		if (mpv_render_context_get_info(p->rctx, (mpv_render_param){MPV_RENDER_PARAM_NEXT_FRAME_INFO, &info}) >= 0 &&
+		    (info.flags & MPV_RENDER_FRAME_INFO_PRESENT) && info.target_time > 0)
+			return info.target_time - mpv_get_time_us(p->mpv) + now; // mpv timebase -> CLOCK_MONOTONIC
 	}
-	
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
-	
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-	glDisableVertexAttribArray((GLuint)g_keystone_a_position_loc);
-	glDisableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glUseProgram(0);
-	glDisable(GL_BLEND);
-	
-	// Draw corner markers for this keystone (always show when enabled)
-	if (g_show_corner_markers) {
-		int corner_size = 12;
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		
-		for (int i = 0; i < 4; i++) {
-			int x = (int)(ks->points[i][0] * (float)screen_w);
-			int y = (int)(ks->points[i][1] * (float)screen_h);
-			
-			// Color: active corner = yellow, inactive corners = green/blue by keystone
-			if (i == ks->active_corner) {
-				glClearColor(1.0f, 1.0f, 0.0f, 0.9f);  // Yellow for active corner
-			} else if (inst->index == 0) {
-				glClearColor(0.0f, 0.7f, 0.0f, 0.6f);  // Green for keystone 0
-			} else {
-				glClearColor(0.0f, 0.4f, 0.8f, 0.6f);  // Blue for keystone 1
-			}
-			
-			x = x - corner_size/2;
-			y = y - corner_size/2;
-			if (x < 0) x = 0; else if (x > screen_w - corner_size) x = screen_w - corner_size;
-			if (y < 0) y = 0; else if (y > screen_h - corner_size) y = screen_h - corner_size;
-			
-			glScissor(x, screen_h - y - corner_size, corner_size, corner_size);
-			glEnable(GL_SCISSOR_TEST);
-			glClear(GL_COLOR_BUFFER_BIT);
+	return inst->pending_since_us;
+}
+
+/**
+ * Pick which instances re-render their mpv FBO in this composite: those with a
+ * pending frame, earliest deadline first, at most g_mv_updates_per_frame. An
+ * instance passed over g_num_videos times outranks every deadline, so a source
+ * with late timestamps still gets its turn. Unpicked instances keep their frame
+ * pending and set g_mv_backlog so another composite follows.
+ *
+ * @param order Receives the indices to update, in deadline order
+ * @return Number of instances picked
+ */
+static int mv_schedule_updates(int order[MAX_VIDEOS]) {
+	int64_t now = mono_now_us();
+	int64_t key[MAX_VIDEOS];
+	int n = 0;
+	for (int i = 0; i < g_num_videos; i++) {
+		video_instance_t *inst = &g_videos[i];
+		if (!inst->player || !inst->player->rctx) continue;
+		if (inst->fbo_texture != 0 && !(inst->update_flags & MPV_RENDER_UPDATE_FRAME)) continue;
+		if (!inst->pending_since_us) inst->pending_since_us = now;
+		int64_t k = (inst->fbo_texture == 0 || inst->skipped >= g_num_videos) ? -1 - inst->skipped : mv_frame_deadline_us(inst, now);
+		// Insertion sort: n <= MAX_VIDEOS
+		int j = n++;
+		while (j > 0 && key[j - 1] > k) { key[j] = key[j - 1]; order[j] = order[j - 1]; j--; }
+		key[j] = k; order[j] = i;
+	}
+	int budget = g_mv_updates_per_frame > 0 ? g_mv_updates_per_frame : g_num_videos;
+	g_mv_backlog = n > budget;
+	for (int j = budget; j < n; j++) g_videos[order[j]].skipped++;
+	if (n > budget) n = budget;
+	for (int j = 0; j < n; j++) {
+		video_instance_t *inst = &g_videos[order[j]];
+		inst->update_flags &= ~(uint64_t)MPV_RENDER_UPDATE_FRAME;
+		inst->pending_since_us = 0;
+		inst->skipped = 0;
+	}
+	return n;
+}
+
+/**
+ * Draw every instance's keystone quad: runs of plain quads go out from the shared
+ * quad buffer with one program and attribute setup, mesh warps and soft-edged quads
+ * (and everything, if batching is unavailable) through their own paths.
+ */
+static void mv_draw_instances(void) {
+	if (!g_batch_units && !g_batch_failed && !init_batch_geometry()) g_batch_failed = true;
+	gl_set_blend(true);
+	int run_first = 0, run_len = 0;
+	for (int i = 0; i < g_num_videos; i++) {
+		video_instance_t *inst = &g_videos[i];
+		if (inst->fbo_texture == 0) {
+			if (run_len) batch_draw_run(run_first, run_len);
+			run_len = 0;
+			continue;
 		}
-		
-		glDisable(GL_SCISSOR_TEST);
-		glDisable(GL_BLEND);
+		if (g_batch_failed || g_rs->video[i].ks.mesh_enabled || keystone_has_blend(&g_rs->video[i].ks)) {
+			if (run_len) batch_draw_run(run_first, run_len);
+			run_len = 0;
+			if (!render_keystone_quad(inst)) LOG_WARN("Failed to render keystone quad for video %d", i);
+			continue;
+		}
+		if (run_len == g_batch_units) { batch_draw_run(run_first, run_len); run_len = 0; }
+		if (run_len == 0) run_first = i;
+		run_len++;
 	}
-	
-	return true;
+	if (run_len) batch_draw_run(run_first, run_len);
 }
 
 /**
- * Render a single video instance with its keystone to the current framebuffer
- * Used in multi-video mode (legacy wrapper, now uses split functions)
- * 
- * @param d DRM context
- * @param e EGL context
- * @param inst Video instance to render
- * @param screen_w Screen width
- * @param screen_h Screen height
- * @return true on success
+ * Low-memory multi-video composition: each instance is rendered into the one shared
+ * target and warped onto the scanout buffer before the next instance reuses it, so N
+ * videos hold a single intermediate texture instead of N. Nothing survives between
+ * composites, so every instance renders every time (no update budget, no batching).
  */
+static void mv_draw_shared(int screen_w, int screen_h) {
+	int want_w = 0, want_h = 0;
+	for (int i = 0; i < g_num_videos; i++) {
+		if (g_videos[i].fbo_want_w > want_w) want_w = g_videos[i].fbo_want_w;
+		if (g_videos[i].fbo_want_h > want_h) want_h = g_videos[i].fbo_want_h;
+	}
+	if (want_w <= 0 || want_h <= 0) { want_w = screen_w; want_h = screen_h; }
+	if (fbo_pool_stale(&g_shared_pool, want_w, want_h) &&
+	    !fbo_pool_ensure(&g_shared_pool, want_w, want_h, screen_w, screen_h, "Shared")) return;
+	int level = fbo_pool_level(&g_shared_pool);
+	GLuint fbo = g_shared_pool.fbo[level];
+	int w = g_shared_pool.w[level], h = g_shared_pool.h[level];
+	g_mv_backlog = 0;
+	for (int i = 0; i < g_num_videos; i++) {
+		video_instance_t *inst = &g_videos[i];
+		inst->fbo = inst->fbo_texture = 0;
+		if (!inst->player || !inst->player->rctx) continue;
+		inst->update_flags &= ~(uint64_t)MPV_RENDER_UPDATE_FRAME;
+		inst->pending_since_us = 0;
+		prof_mark(PROF_MPV);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		fbo_pool_render_mpv(inst->player, &g_shared_pool, fbo, w, h, 0);
+		prof_mark(PROF_WARP);
+		glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
+		glViewport(0, 0, screen_w, screen_h);
+		inst->fbo = fbo;
+		inst->fbo_texture = g_shared_pool.tex[level];
+		inst->fbo_w = w;
+		inst->fbo_h = h;
+		if (!render_keystone_quad(inst)) LOG_WARN("Failed to render keystone quad for video %d", i);
+	}
+}
+
 /**
- * Combined render function - updates FBO and renders keystone quad
- * Used for single video mode or when alternate frame mode is disabled
+ * Move the single video between the overlay plane and GL composition (render thread).
+ * mpv's drmprime-overlay interop never hands frames to GL, so the
+ * render context is re-created with the other interop; leaving the plane also
+ * switches it off in the next primary-plane commit.
+ *
+ * @param p Player presented in single-video mode
+ * @param on true to scan the video out on the plane again
+ * @return false if no render context could be created
  */
-static bool render_video_instance(kms_ctx_t *d, egl_ctx_t *e, video_instance_t *inst, int screen_w, int screen_h) {
-	(void)d; (void)e;  // Unused parameters, kept for API compatibility
-	if (!inst || !inst->player || !inst->player->rctx) return false;
-	
-	// Update FBO from mpv
-	if (!update_video_fbo(inst, screen_w, screen_h)) return false;
-	
-	// Render keystone quad to screen
-	return render_keystone_quad(inst, screen_w, screen_h);
+static bool video_plane_switch(mpv_player_t *p, bool on) {
+	if (p->rctx) { mpv_render_context_free(p->rctx); p->rctx = NULL; }
+	if (g_atomic_req) { drmModeAtomicFree(g_atomic_req); g_atomic_req = NULL; }
+	g_video_plane = on;
+	p->zero_copy = 0; // mpv_apply_hwdec() picks the path for the new interop
+	if (!on) {
+		int r = mpv_set_property_string(p->mpv, "gpu-hwdec-interop", "auto");
+		log_opt_result("gpu-hwdec-interop=auto", r);
+		g_video_plane_detach = 1;
+	}
+	bool ok = init_mpv_render(p);
+	if (!ok && on) {
+		LOG_WARN("Video plane render context failed; staying on GL composition");
+		g_video_plane = g_video_plane_wanted = 0;
+		mpv_set_property_string(p->mpv, "gpu-hwdec-interop", "auto");
+		ok = init_mpv_render(p);
+	}
+	g_sched_rctx[0] = p->rctx;
+	g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+	LOG_INFO("Video %s", g_video_plane ? "back on the overlay plane" : "composed by GL (keystone, border or help on)");
+	return ok;
 }
 
-static bool render_frame_fixed(kms_ctx_t *d, egl_ctx_t *e, mpv_player_t *p) {
+/**
+ * Compose and queue one frame
+ *
+ * @param video false when only keystone/overlay state changed: mpv output cached in an
+ *              FBO is reused instead of rendering it again
+ */
+static bool render_frame_fixed(kms_ctx_t *d, egl_ctx_t *e, mpv_player_t *p, bool video) {
+	static bool first = true; // initial modeset not yet performed
+	static GLuint mpv_rendered = 0; // Keystone FBO holding the last mpv frame (0 = none)
+	static bool plane_black = false; // clear the primary plane once before the video returns to the plane
+	render_snapshot_t *rs = g_rs; // keystone/overlay state published by the control thread
+	keystone_t *ks = &rs->main.ks;
+	int in_fence = -1;
+	EGLSyncKHR gpu_fence = EGL_NO_SYNC_KHR;
+	int64_t frame_start_us = mono_now_us(); // governor: frame cost is measured up to the fence signal
+	g_flipq.kms = d;
+	g_flipq.egl = e;
 	if (!eglMakeCurrent(e->dpy, e->surf, e->surf, e->ctx)) {
 		fprintf(stderr, "eglMakeCurrent failed\n"); return false; 
 	}
+	prof_frame_begin();
+	
+	// Video plane mode: keystone, border and help are drawn by GL, so the video leaves the
+	// plane while any of them is on and returns once they are all off again
+	if (g_video_plane_wanted && d->atomic && !first && !g_scanout_disabled && p && p->mpv) {
+		bool plane = !(ks->enabled || rs->show_border || rs->show_help);
+		if ((bool)p->plane_interop != plane) {
+			if (!video_plane_switch(p, plane)) return false;
+			mpv_rendered = 0;
+			plane_black = g_video_plane;
+		}
+	}
+	// mpv adds the decoded frame to the atomic request during render
+	if (g_video_plane && d->atomic && !g_atomic_req) g_atomic_req = drmModeAtomicAlloc();
+	if (g_video_plane && d->atomic && !first && !g_scanout_disabled && !plane_black) {
+		if (!p->rctx) {
+			fprintf(stderr, "mpv render context NULL\n");
+			return false;
+		}
+		// The primary plane keeps the initial black frame; only the video plane is flipped
+		mpv_opengl_fbo mpv_fbo = { .fbo = 0, .w = (int)d->mode.hdisplay, .h = (int)d->mode.vdisplay, .internal_format = 0 };
+		int mpv_flip_y = 1;
+		mpv_render_param r_params[] = {
+			(mpv_render_param){MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
+			(mpv_render_param){MPV_RENDER_PARAM_FLIP_Y, &mpv_flip_y},
+			(mpv_render_param){MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &g_mpv_block_for_target},
+			(mpv_render_param){0}
+		};
+		prof_mark(PROF_MPV);
+		mpv_render_context_render(p->rctx, r_params);
+		gl_state_invalidate();
+		prof_mark(PROF_SWAP);
+		// The main loop only renders in plane mode with an empty queue, so this commits at once
+		flipq_push(NULL, 0, -1);
+		return flipq_kick();
+	}
 	
 	// Initialize keystone shader if needed
-	bool any_keystone = g_keystone.enabled || (g_num_videos > 1);
+	bool any_keystone = ks->enabled || (g_num_videos > 1);
 	if (any_keystone && g_keystone_shader_program == 0) {
 		if (!init_keystone_shader()) {
 			LOG_ERROR("Failed to initialize keystone shader, disabling keystone correction");
-			g_keystone.enabled = false;
+			ks->enabled = false;
 		}
 	}
-	// Initialize border shader lazily if needed for border rendering
-	if (g_show_border && g_border_shader_program == 0) {
-		if (!init_border_shader()) {
-			LOG_WARN("Failed to initialize border shader; border will be disabled");
-			g_show_border = false;
+	
+	// Scanout FB ring: compose straight into the next free BO (the main loop only
+	// renders when one is free, see flipq_can_render)
+	int ring_slot = -1;
+	if (g_fb_ring.count) {
+		ring_slot = fb_ring_acquire();
+		if (ring_slot < 0) {
+			if (g_debug) fprintf(stderr, "[fb-ring] No free buffer, skipping frame\n");
+			return true;
 		}
+		g_scanout_fbo = g_fb_ring.entries[ring_slot].fbo;
+		glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
 	}
 	
-	// Background is always black
+	// Background is always black. mpv already fills the whole default framebuffer
+	// when it renders there directly, so the clear is only needed when compositing.
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT);
+	if (plane_black) {
+		// The last GL frame would show around the video plane: put a black one under it
+		plane_black = false;
+		g_video_plane_refill = 1;
+		glClear(GL_COLOR_BUFFER_BIT);
+		goto do_swap;
+	}
+	if (g_num_videos > 1 || ks->enabled || rs->show_border) glClear(GL_COLOR_BUFFER_BIT);
 	
 	// Multi-video mode: render each video instance with its own keystone
 	if (g_num_videos > 1) {
 		int screen_w = (int)d->mode.hdisplay;
 		int screen_h = (int)d->mode.vdisplay;
 		
-		// Update active_corner for each keystone based on g_active_corner_global
+		// Update active_corner for each keystone based on the global corner selection
 		// Each keystone only has its corner active if it's the currently selected keystone
 		for (int i = 0; i < g_num_videos; i++) {
-			int current_video = CORNER_VIDEO(g_active_corner_global);
+			int current_video = CORNER_VIDEO(rs->active_corner_global);
 			if (i == current_video) {
-				g_videos[i].keystone.active_corner = CORNER_LOCAL(g_active_corner_global);
+				rs->video[i].ks.active_corner = CORNER_LOCAL(rs->active_corner_global);
 			} else {
-				g_videos[i].keystone.active_corner = -1;  // Not active
+				rs->video[i].ks.active_corner = -1;  // Not active
 			}
 		}
 		
+		prof_mark(PROF_MPV);
 		if (g_single_mpv_mode) {
 			// Single mpv: render composite once, then two keystones sampling sub-rects
-			if (!update_composite_fbo(g_videos[0].player, screen_w, screen_h)) {
+			if (!update_composite_fbo(g_videos[0].player, screen_w, screen_h, video)) {
 				LOG_WARN("Failed to update composite FBO");
 			}
-			for (int i = 0; i < g_num_videos; i++) {
-				g_videos[i].fbo_texture = g_composite_texture;
-				if (!render_keystone_quad(&g_videos[i], screen_w, screen_h)) {
-					LOG_WARN("Failed to render keystone quad for video %d", i);
-				}
-			}
-		} else if (g_alternate_frame_mode && g_num_videos == 2) {
-			int video_to_update = g_render_frame_count % 2;
-			g_render_frame_count++;
-			if (!update_video_fbo(&g_videos[video_to_update], screen_w, screen_h)) {
-				LOG_WARN("Failed to update FBO for video instance %d", video_to_update);
-			}
-			for (int i = 0; i < g_num_videos; i++) {
-				if (g_videos[i].fbo_texture != 0) {
-					if (!render_keystone_quad(&g_videos[i], screen_w, screen_h)) {
-						LOG_WARN("Failed to render keystone quad for video %d", i);
-					}
-				}
-			}
+			for (int i = 0; i < g_num_videos; i++) g_videos[i].fbo_texture = g_composite_texture;
+		} else if (g_low_mem) {
+			// One shared intermediate target: render and warp instance by instance
+			mv_assign_fbo_budgets(screen_w, screen_h);
+			mv_draw_shared(screen_w, screen_h);
+			prof_mark(PROF_OVERLAY);
+			overlay_draw(screen_w, screen_h);
+			goto do_swap;
 		} else {
-			for (int i = 0; i < g_num_videos; i++) {
-				if (!render_video_instance(d, e, &g_videos[i], screen_w, screen_h)) {
-					LOG_WARN("Failed to render video instance %d", i);
+			// Deadline-ordered, budgeted mpv renders; the rest reuse their last FBO
+			int order[MAX_VIDEOS];
+			mv_assign_fbo_budgets(screen_w, screen_h);
+			int n = mv_schedule_updates(order);
+			for (int k = 0; k < n; k++) {
+				if (!update_video_fbo(&g_videos[order[k]], screen_w, screen_h)) {
+					LOG_WARN("Failed to update FBO for video instance %d", order[k]);
 				}
 			}
 		}
+		// mpv leaves the viewport at its (reduced-size) target
+		prof_mark(PROF_WARP);
+		glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
+		glViewport(0, 0, screen_w, screen_h);
+		mv_draw_instances();
+		prof_mark(PROF_OVERLAY);
+		overlay_draw(screen_w, screen_h);
 		
 		// Skip single-video rendering path below
 		goto do_swap;
 	}
 	
 	// Single video mode: use legacy keystone rendering
-	// Ensure reusable FBO exists when keystone is enabled, sized to current mode
-	if (g_keystone.enabled) {
-		int want_w = (int)d->mode.hdisplay;
-		int want_h = (int)d->mode.vdisplay;
-		bool need_recreate = (g_keystone_fbo == 0) || (g_keystone_fbo_w != want_w) || (g_keystone_fbo_h != want_h);
-		if (need_recreate) {
-			// Destroy previous if any
-			if (g_keystone_fbo) {
-				glDeleteFramebuffers(1, &g_keystone_fbo);
-				g_keystone_fbo = 0;
-			}
-			if (g_keystone_fbo_texture) {
-				glDeleteTextures(1, &g_keystone_fbo_texture);
-				g_keystone_fbo_texture = 0;
-			}
-			// Create texture - use RGB instead of RGBA to save bandwidth
-			glGenTextures(1, &g_keystone_fbo_texture);
-			glBindTexture(GL_TEXTURE_2D, g_keystone_fbo_texture);
-			// Use nearest filtering for maximum performance
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			// Use RGBA back - RGB might not be compatible with mpv output
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, want_w, want_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-			// Create FBO
-			glGenFramebuffers(1, &g_keystone_fbo);
-			glBindFramebuffer(GL_FRAMEBUFFER, g_keystone_fbo);
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_keystone_fbo_texture, 0);
-			GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-			if (status != GL_FRAMEBUFFER_COMPLETE) {
-				LOG_ERROR("FBO setup failed, status: %d", status);
-				glBindFramebuffer(GL_FRAMEBUFFER, 0);
-				glDeleteFramebuffers(1, &g_keystone_fbo);
-				glDeleteTextures(1, &g_keystone_fbo_texture);
-				g_keystone_fbo = 0;
-				g_keystone_fbo_texture = 0;
-			} else {
-				g_keystone_fbo_w = want_w;
-				g_keystone_fbo_h = want_h;
-			}
+	prof_mark(PROF_MPV);
+	// Ensure reusable FBO exists when keystone is enabled: screen-sized at most, capped by
+	// the source resolution and the quad's on-screen extent, scaled by the governor
+	if (ks->enabled) {
+		int screen_w = (int)d->mode.hdisplay;
+		int screen_h = (int)d->mode.vdisplay;
+		float x0 = 1.0f, x1 = 0.0f, y0 = 1.0f, y1 = 0.0f;
+		for (int c = 0; c < 4; c++) {
+			x0 = fminf(x0, ks->points[c][0]); x1 = fmaxf(x1, ks->points[c][0]);
+			y0 = fminf(y0, ks->points[c][1]); y1 = fmaxf(y1, ks->points[c][1]);
+		}
+		float scale = gov_base_scale(p, fmaxf(x1 - x0, y1 - y0), screen_w, screen_h);
+		int want_w = (int)((float)screen_w * scale) & ~1;
+		int want_h = (int)((float)screen_h * scale) & ~1;
+		if (fbo_pool_stale(&g_keystone_pool, want_w, want_h)) {
+			g_keystone_fbo = g_keystone_fbo_texture = 0;
+			mpv_rendered = 0;
+			fbo_pool_ensure(&g_keystone_pool, want_w, want_h, screen_w, screen_h, "Keystone");
+		}
+		if (g_keystone_pool.base_w) {
+			int level = fbo_pool_level(&g_keystone_pool);
+			g_keystone_fbo = g_keystone_pool.fbo[level];
+			g_keystone_fbo_texture = g_keystone_pool.tex[level];
+			g_keystone_fbo_w = g_keystone_pool.w[level];
+			g_keystone_fbo_h = g_keystone_pool.h[level];
 		}
 	}
 	
 	// Render MPV frame either to our FBO or directly to screen
 	mpv_opengl_fbo mpv_fbo;
 	int mpv_flip_y = 0; // default: no flip (handled in final pass if needed)
-	if (g_keystone.enabled && g_keystone_fbo) {
+	if (ks->enabled && g_keystone_fbo) {
 		glBindFramebuffer(GL_FRAMEBUFFER, g_keystone_fbo);
 		mpv_fbo = (mpv_opengl_fbo){ .fbo = (int)g_keystone_fbo, .w = g_keystone_fbo_w, .h = g_keystone_fbo_h, .internal_format = 0 };
 	} else {
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		mpv_fbo = (mpv_opengl_fbo){ .fbo = 0, .w = (int)d->mode.hdisplay, .h = (int)d->mode.vdisplay, .internal_format = 0 };
-		// When rendering directly to the default framebuffer (no keystone), mpv should flip vertically
-		mpv_flip_y = 1;
+		glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
+		mpv_fbo = (mpv_opengl_fbo){ .fbo = (int)g_scanout_fbo, .w = (int)d->mode.hdisplay, .h = (int)d->mode.vdisplay, .internal_format = 0 };
+		// When rendering directly to the default framebuffer (no keystone), mpv should flip vertically;
+		// ring FBOs are scanned out top row first and need mpv's native orientation
+		mpv_flip_y = g_scanout_y_flip ? 0 : 1;
 	}
 	
 	mpv_render_param r_params[] = {
 		(mpv_render_param){MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
 		(mpv_render_param){MPV_RENDER_PARAM_FLIP_Y, &mpv_flip_y},
+		(mpv_render_param){MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &g_mpv_block_for_target},
 		(mpv_render_param){0}
 	};
 	
@@ -3575,165 +8501,86 @@ static bool render_frame_fixed(kms_ctx_t *d, egl_ctx_t *e, mpv_player_t *p) {
 		return false;
 	}
 	
-	// Render the mpv frame
-	mpv_render_context_render(p->rctx, r_params);
+	// Render the mpv frame (a keystone FBO that already holds it is only recomposited)
+	GLuint target = (GLuint)mpv_fbo.fbo;
+	if (!video && ks->enabled && target != g_scanout_fbo && target == mpv_rendered) {
+		atomic_fetch_add(&g_stats_composed, 1);
+	} else if (target != g_scanout_fbo) {
+		fbo_pool_render_mpv(p, &g_keystone_pool, target, mpv_fbo.w, mpv_fbo.h, mpv_flip_y);
+		mpv_rendered = target;
+	} else {
+		mpv_render_context_render(p->rctx, r_params);
+		gl_state_invalidate(); // mpv leaves its own program, textures and blend state bound
+		mpv_rendered = 0;
+	}
 	
 	// If keystone is enabled, render the FBO texture with our shader
-	if (g_keystone.enabled && g_keystone_fbo && g_keystone_fbo_texture) {
-		// Switch back to default framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		
-		// Use our shader program
-		glUseProgram(g_keystone_shader_program);
-		
-		// Set up texture
-		glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, g_keystone_fbo_texture);
-		glUniform1i(g_keystone_u_texture_loc, 0);
-		
-		// Correct warping approach: Draw a warped quad where vertices match the keystone corners
-		// Convert keystone points from normalized [0,1] space to clip space [-1,1]
-		float vertices[] = {
-			g_keystone.points[0][0] * 2.0f - 1.0f, 1.0f - (g_keystone.points[0][1] * 2.0f),  // Top left 
-			g_keystone.points[1][0] * 2.0f - 1.0f, 1.0f - (g_keystone.points[1][1] * 2.0f),  // Top right
-			g_keystone.points[3][0] * 2.0f - 1.0f, 1.0f - (g_keystone.points[3][1] * 2.0f),  // Bottom left 
-			g_keystone.points[2][0] * 2.0f - 1.0f, 1.0f - (g_keystone.points[2][1] * 2.0f)   // Bottom right
-		};
+	prof_mark(PROF_WARP);
+	if (ks->enabled && g_keystone_fbo && g_keystone_fbo_texture) {
+		// Switch back to the scanout framebuffer (the FBO may be smaller than the screen)
+		glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
+		glViewport(0, 0, (GLsizei)d->mode.hdisplay, (GLsizei)d->mode.vdisplay);
 		
 		// Texture coordinates with optional flips
-		float u0 = g_tex_flip_x ? 1.0f : 0.0f;
-		float u1 = g_tex_flip_x ? 0.0f : 1.0f;
-		float v0 = g_tex_flip_y ? 1.0f : 0.0f;
-		float v1 = g_tex_flip_y ? 0.0f : 1.0f;
-		float texcoords[] = {
-			u0, v0,  // Top left
-			u1, v0,  // Top right
-			u0, v1,  // Bottom left
-			u1, v1   // Bottom right
-		};
-		
-		// Enable vertex arrays
-		glEnableVertexAttribArray((GLuint)g_keystone_a_position_loc);
-		
-		// Bind and set vertex positions
-		glBindBuffer(GL_ARRAY_BUFFER, g_keystone_vertex_buffer);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-		glVertexAttribPointer((GLuint)g_keystone_a_position_loc, 2, GL_FLOAT, GL_FALSE, 0, 0);
-		
-		// We need another VBO for texture coordinates
-		if (g_keystone_texcoord_buffer == 0) {
-			glGenBuffers(1, &g_keystone_texcoord_buffer);
-		}
+		float u0 = rs->tex_flip_x ? 1.0f : 0.0f;
+		float u1 = rs->tex_flip_x ? 0.0f : 1.0f;
+		float v0 = rs->tex_flip_y ? 1.0f : 0.0f;
+		float v1 = rs->tex_flip_y ? 0.0f : 1.0f;
 		
-		// Bind and set texture coordinates
-		glBindBuffer(GL_ARRAY_BUFFER, g_keystone_texcoord_buffer);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_DYNAMIC_DRAW);
-		glEnableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
-		glVertexAttribPointer((GLuint)g_keystone_a_texcoord_loc, 2, GL_FLOAT, GL_FALSE, 0, 0);
+		// Keystone shader (edge-blend variant with soft edges) and the FBO texture, drawn opaque
+		gl_set_blend(false);
+		keystone_use_program(ks, &g_blend_lut, g_keystone_fbo_texture, u0, u1, v0, v1);
 		
-		// Prepare a cached index buffer for two triangles
-		if (g_keystone_index_buffer == 0) {
-			GLushort indices[] = {0, 1, 2, 2, 1, 3};
-			glGenBuffers(1, &g_keystone_index_buffer);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_keystone_index_buffer);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+		if (ks->mesh_enabled && mesh_geom_draw(&g_mesh_geom, ks, u0, u1, v0, v1)) {
+			// Curved-surface warp: tessellated control mesh from the static VBO/IBO
 		} else {
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_keystone_index_buffer);
+			// Persistent quad; re-uploaded only when a corner, pin or flip changed
+			quad_geom_draw(&g_quad_geom, ks, u0, u1, v0, v1);
 		}
-		
-	// Draw using indexed triangles
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-		
-		// Clean up
-		glDisableVertexAttribArray((GLuint)g_keystone_a_position_loc);
-		glDisableVertexAttribArray((GLuint)g_keystone_a_texcoord_loc);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glUseProgram(0);
 	}
 	
-	// Draw border around the keystone quad if enabled
-	if (g_show_border) {
-		// Determine quad positions in clip space matching the keystone corners
-		float vx = g_keystone.points[0][0]*2.0f-1.0f;
-		float vy = 1.0f-(g_keystone.points[0][1]*2.0f);
-		float v0[2] = { vx, vy }; // TL
-		float v1[2] = { g_keystone.points[1][0]*2.0f-1.0f, 1.0f-(g_keystone.points[1][1]*2.0f) }; // TR
-		float v2[2] = { g_keystone.points[3][0]*2.0f-1.0f, 1.0f-(g_keystone.points[3][1]*2.0f) }; // BL
-		float v3[2] = { g_keystone.points[2][0]*2.0f-1.0f, 1.0f-(g_keystone.points[2][1]*2.0f) }; // BR
-		float lines[] = {
-			v0[0], v0[1], v1[0], v1[1], // top edge
-			v1[0], v1[1], v3[0], v3[1], // right edge
-			v3[0], v3[1], v2[0], v2[1], // bottom edge
-			v2[0], v2[1], v0[0], v0[1], // left edge
-		};
-		// Use border shader
-		glUseProgram(g_border_shader_program);
-		glUniform4f(g_border_u_color_loc, 1.0f, 1.0f, 0.0f, 1.0f); // Yellow
-	// Upload a tiny VBO on existing vertex buffer to avoid creating a new one
-		if (g_keystone_vertex_buffer == 0) glGenBuffers(1, &g_keystone_vertex_buffer);
-		glBindBuffer(GL_ARRAY_BUFFER, g_keystone_vertex_buffer);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(lines), lines, GL_DYNAMIC_DRAW);
-		glEnableVertexAttribArray((GLuint)g_border_a_position_loc);
-		glVertexAttribPointer((GLuint)g_border_a_position_loc, 2, GL_FLOAT, GL_FALSE, 0, 0);
-	// Set line width (may be clamped to 1 on some GLES2 drivers)
-	glLineWidth((GLfloat)g_border_width);
-	// Draw 4 line segments (each pair of vertices forms a segment)
-		glDrawArrays(GL_LINES, 0, 8);
-		// Cleanup
-		glDisableVertexAttribArray((GLuint)g_border_a_position_loc);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glUseProgram(0);
-	}
-	
-	// Draw corner markers for keystone adjustment if enabled
-	// This is simplistic and would need a shader-based approach for proper GLES2 implementation
-	if (g_keystone.enabled && g_show_corner_markers) {
-		// Draw colored markers at each corner position to show their current locations
-		int corner_size = 10;
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		
-		int w = d->mode.hdisplay;
-		int h = d->mode.vdisplay;
-		
-		for (int i = 0; i < 4; i++) {
-			// Calculate screen position from normalized coordinates
-			int x = (int)((float)g_keystone.points[i][0] * (float)w);
-			int y = (int)((float)g_keystone.points[i][1] * (float)h);
-			
-			// Set color: active corner is red, others are green
-			if (i == g_keystone.active_corner) {
-				glClearColor(1.0f, 0.0f, 0.0f, 0.8f); // Red
-			} else {
-				glClearColor(0.0f, 1.0f, 0.0f, 0.8f); // Green
-			}
-			
-			// Ensure marker stays visible within screen bounds (integer clamps)
-			x = x - corner_size/2;
-			y = y - corner_size/2;
-			if (x < 0) x = 0; else if (x > w - corner_size) x = w - corner_size;
-			if (y < 0) y = 0; else if (y > h - corner_size) y = h - corner_size;
-			
-			// Draw the corner marker
-			glScissor(x, h - y - corner_size, corner_size, corner_size);
-			glEnable(GL_SCISSOR_TEST);
-			glClear(GL_COLOR_BUFFER_BIT);
-		}
-		
-		glDisable(GL_SCISSOR_TEST);
-		glDisable(GL_BLEND);
+	// Border and corner/mesh markers: one batched overlay draw
+	prof_mark(PROF_OVERLAY);
+	if (rs->show_border || (ks->enabled && rs->show_corner_markers)) {
+		glBindFramebuffer(GL_FRAMEBUFFER, g_scanout_fbo);
+		glViewport(0, 0, (GLsizei)d->mode.hdisplay, (GLsizei)d->mode.vdisplay);
+		overlay_draw((int)d->mode.hdisplay, (int)d->mode.vdisplay);
 	}
 	
 do_swap:
-	// Swap buffers to display the rendered frame
-	eglSwapBuffers(e->dpy, e->surf);
+	prof_mark(PROF_SWAP);
+	// GPU completion fence handed to KMS as IN_FENCE_FD, so the commit does not wait on the CPU
+	if (d->atomic && e->native_fence && d->plane_prop.in_fence_fd && !g_scanout_disabled) {
+		const EGLint fence_attrs[] = { EGL_SYNC_NATIVE_FENCE_FD_ANDROID, EGL_NO_NATIVE_FENCE_FD_ANDROID, EGL_NONE };
+		gpu_fence = e->create_sync(e->dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, fence_attrs);
+	}
+	struct gbm_bo *bo = NULL;
+	uint32_t fb_id = 0;
+	if (ring_slot >= 0) {
+		// Composed straight into a ring BO whose FB already exists: just flush the GPU work
+		glFlush();
+		bo = g_fb_ring.entries[ring_slot].bo;
+		fb_id = g_fb_ring.entries[ring_slot].fb_id;
+	} else {
+		// Swap buffers to display the rendered frame
+		eglSwapBuffers(e->dpy, e->surf);
+	}
+	if (gpu_fence != EGL_NO_SYNC_KHR) {
+		in_fence = e->dup_native_fence_fd(e->dpy, gpu_fence); // valid once the swap/flush has happened
+		e->destroy_sync(e->dpy, gpu_fence);
+		if (in_fence >= 0) gov_track_fence(in_fence, frame_start_us);
+	}
 
-	struct gbm_bo *bo = gbm_surface_lock_front_buffer(e->gbm_surf);
-	if (!bo) { fprintf(stderr, "gbm_surface_lock_front_buffer failed\n"); return false; }
-	struct fb_holder *h = gbm_bo_get_user_data(bo);
-	uint32_t fb_id = h ? h->fb : 0;
+	if (ring_slot < 0) {
+		bo = gbm_surface_lock_front_buffer(e->gbm_surf);
+		if (!bo) {
+			fprintf(stderr, "gbm_surface_lock_front_buffer failed\n");
+			if (in_fence >= 0) close(in_fence);
+			return false;
+		}
+		struct fb_holder *h = gbm_bo_get_user_data(bo);
+		fb_id = h ? h->fb : 0;
+	}
 	if (!fb_id) {
 		uint32_t handle = gbm_bo_get_handle(bo).u32;
 		uint32_t pitch = gbm_bo_get_stride(bo);
@@ -3742,14 +8589,42 @@ do_swap:
 		if (!g_scanout_disabled && drmModeAddFB(d->fd, width, height, 24, 32, pitch, handle, &fb_id)) {
 			fprintf(stderr, "drmModeAddFB failed (w=%u h=%u pitch=%u handle=%u err=%s)\n", width, height, pitch, handle, strerror(errno));
 			gbm_surface_release_buffer(e->gbm_surf, bo);
+			if (in_fence >= 0) close(in_fence);
+			return false;
+		}
+		struct fb_holder *nh = calloc(1, sizeof(*nh));
+		if (!nh) {
+			fprintf(stderr, "Out of memory allocating fb_holder\n");
+			gbm_surface_release_buffer(e->gbm_surf, bo);
+			if (in_fence >= 0) close(in_fence);
 			return false;
 		}
-		struct fb_holder *nh = calloc(1, sizeof(*nh));
-		if (!nh) { fprintf(stderr, "Out of memory allocating fb_holder\n"); gbm_surface_release_buffer(e->gbm_surf, bo); return false; }
 		nh->fb = fb_id; nh->fd = d->fd;
 		gbm_bo_set_user_data(bo, nh, bo_destroy_handler);
 	}
-	static bool first=true;
+	if (!g_scanout_disabled && first && d->atomic) {
+		// Initial atomic modeset (blocking); also carries mpv's video plane in plane mode
+		int ret = atomic_commit_fb(d, fb_id, in_fence, true, NULL);
+		if (ret) {
+			LOG_WARN("Atomic modeset failed (%s); using legacy modeset/page flips", strerror(-ret));
+			d->atomic = 0;
+			if (g_video_plane) {
+				LOG_WARN("Video plane scanout requires atomic modesetting; disabling it");
+				g_video_plane = g_video_plane_wanted = 0;
+			}
+		}
+	}
+	if (!d->atomic && in_fence >= 0) {
+		// Legacy paths cannot consume the fence; the swap already flushed the GPU work
+		close(in_fence);
+		in_fence = -1;
+	}
+	if (!g_scanout_disabled && first && d->atomic) {
+		if (in_fence >= 0) close(in_fence);
+		first=false;
+		g_flipq.scanout = bo; // retain; released once the next frame reaches the screen
+		return true;
+	}
 	if (!g_scanout_disabled && first) {
 		// Initial modeset; retain BO until next successful page flip to avoid premature release while scanning out.
 		if (drmModeSetCrtc(d->fd, d->crtc_id, fb_id, 0,0, &d->connector_id,1,&d->mode)) {
@@ -3759,130 +8634,542 @@ do_swap:
 				fprintf(stderr, "[DRM] Permission denied on modeset – entering NO-SCANOUT fallback (offscreen decode).\n");
 				g_scanout_disabled = 1;
 				// Release this BO immediately; no page flip path.
-				gbm_surface_release_buffer(e->gbm_surf, bo);
+				scanout_release(e, bo);
 				return true;
 			}
 			return false;
 		}
 		first=false;
-		g_first_frame_bo = bo; // retain; release after we have performed one page flip on a new frame
+		g_flipq.scanout = bo; // retain; released once the next frame reaches the screen
 		return true; // do not release now
 	}
 	if (!g_scanout_disabled) {
-		g_egl_for_handler = e;
-		gettimeofday(&g_last_flip_submit, NULL); // Record time of submission
-		
-		// For triple buffering, allow up to 2 page flips in flight
-		// If we already have max pending flips, wait for one to complete
-		int max_pending = g_triple_buffer ? 2 : 1;
-		
-		if (g_pending_flips >= max_pending) {
-			if (g_debug) fprintf(stderr, "[buffer] Waiting for page flip to complete (pending=%d)\n", g_pending_flips);
-			
-			// Wait for a pending flip to complete before scheduling another
-			fd_set fds;
-			FD_ZERO(&fds);
-			FD_SET(d->fd, &fds);
-			
-			// Set reasonable timeout to avoid indefinite wait
-			struct timeval timeout = {0, 100000}; // 100ms
-			
-			if (select(d->fd + 1, &fds, NULL, NULL, &timeout) <= 0) {
-				// Timeout or error occurred, force reset pending flip state
-				if (g_debug) fprintf(stderr, "[buffer] Page flip wait timeout, resetting state\n");
-				g_pending_flip = 0;
-			} else if (FD_ISSET(d->fd, &fds)) {
-				// Handle the page flip event
-				drmEventContext ev = { .version = DRM_EVENT_CONTEXT_VERSION, .page_flip_handler = page_flip_handler };
-				drmHandleEvent(d->fd, &ev);
-			}
-		}
-		
-		if (drmModePageFlip(d->fd, d->crtc_id, fb_id, DRM_MODE_PAGE_FLIP_EVENT, bo)) {
-			gbm_surface_release_buffer(e->gbm_surf, bo);
-			return false;
+		// Queue for scanout; submitted now if the CRTC is idle, otherwise from the flip event
+		if (!flipq_push(bo, fb_id, in_fence)) {
+			fprintf(stderr, "[buffer] Flip queue full, dropping frame\n");
+			scanout_release(e, bo);
+			if (in_fence >= 0) close(in_fence);
+			return true;
 		}
-		g_pending_flip = 1; // will release in handler
-		g_pending_flips++;  // increment pending flip count
+		return flipq_kick();
 	} else {
 		// Offscreen mode: just release BO immediately (no scanout usage).
-		gbm_surface_release_buffer(e->gbm_surf, bo);
+		scanout_release(e, bo);
 	}
 	// No need to remove FB each frame; retained until BO destroyed.
 	return true;
 }
 
-// Preallocate (discover) up to ring_size unique GBM BOs + FB IDs by performing dummy swaps.
 /**
- * Pre-allocate framebuffer objects for triple-buffering
- * 
+ * Collect the modifiers the primary plane can scan out for a format (IN_FORMATS blob).
+ *
+ * @param d Pointer to DRM context (d->plane_id must be resolved)
+ * @param format DRM fourcc
+ * @param mods Output array
+ * @param max Capacity of mods
+ * @return Number of modifiers stored (0 if the plane does not advertise any)
+ */
+static int drm_plane_modifiers(const kms_ctx_t *d, uint32_t format, uint64_t *mods, int max) {
+	uint64_t blob_id = 0;
+	if (!d->plane_id || !drm_find_prop(d->fd, d->plane_id, DRM_MODE_OBJECT_PLANE, "IN_FORMATS", &blob_id) || !blob_id)
+		return 0;
+	drmModePropertyBlobRes *blob = drmModeGetPropertyBlob(d->fd, (uint32_t)blob_id);
+	if (!blob) return 0;
+	const struct drm_format_modifier_blob *hdr = blob->data;
+	const uint32_t *formats = (const uint32_t *)((const char *)hdr + hdr->formats_offset);
+	const struct drm_format_modifier *fm = (const struct drm_format_modifier *)((const char *)hdr + hdr->modifiers_offset);
+	int n = 0;
+	for (uint32_t f = 0; f < hdr->count_formats; f++) {
+		if (formats[f] != format) continue;
+		// Each modifier entry covers a 64-format window starting at fm->offset
+		for (uint32_t m = 0; m < hdr->count_modifiers && n < max; m++) {
+			if (f < fm[m].offset || f >= fm[m].offset + 64) continue;
+			if (fm[m].formats & (1ULL << (f - fm[m].offset))) mods[n++] = fm[m].modifier;
+		}
+		break;
+	}
+	drmModeFreePropertyBlob(blob);
+	return n;
+}
+
+/**
+ * Release every FB ring entry (FBO, renderbuffer, EGLImage, FB id, BO).
+ * Rendering falls back to the EGL window surface afterwards.
+ *
+ * @param e Pointer to EGL context (current)
+ */
+static void fb_ring_destroy(egl_ctx_t *e) {
+	if (!g_fb_ring.entries) return;
+	for (int i = 0; i < g_fb_ring.count; i++) {
+		fb_ring_entry_t *r = &g_fb_ring.entries[i];
+		if (r->fbo) glDeleteFramebuffers(1, &r->fbo);
+		if (r->rbo) glDeleteRenderbuffers(1, &r->rbo);
+		if (r->image != EGL_NO_IMAGE_KHR && e->destroy_image) e->destroy_image(e->dpy, r->image);
+		if (r->fb_id) drmModeRmFB(g_fb_ring.drm_fd, r->fb_id);
+		if (r->bo) gbm_bo_destroy(r->bo);
+	}
+	free(g_fb_ring.entries);
+	memset(&g_fb_ring, 0, sizeof(g_fb_ring));
+	g_scanout_fbo = 0;
+	g_scanout_y_flip = 0;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+ * Allocate one FB ring entry: a scanout BO (with a plane-supported modifier when
+ * possible), its DRM framebuffer, and an FBO rendering into it through an EGLImage.
+ *
+ * @return true on success; partially created objects are left for fb_ring_destroy
+ */
+static bool fb_ring_create_entry(kms_ctx_t *d, egl_ctx_t *e, fb_ring_entry_t *r, const uint64_t *mods, int nmods) {
+	uint32_t w = d->mode.hdisplay, h = d->mode.vdisplay;
+	r->image = EGL_NO_IMAGE_KHR;
+	if (nmods > 0) r->bo = gbm_bo_create_with_modifiers(e->gbm_dev, w, h, GBM_FORMAT_XRGB8888, mods, (unsigned int)nmods);
+	bool with_mods = r->bo != NULL;
+	if (!r->bo) r->bo = gbm_bo_create(e->gbm_dev, w, h, GBM_FORMAT_XRGB8888, GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+	if (!r->bo) { fprintf(stderr, "[fb-ring] gbm_bo_create failed (%s)\n", strerror(errno)); return false; }
+	if (gbm_bo_get_plane_count(r->bo) != 1) { fprintf(stderr, "[fb-ring] multi-planar BO not supported\n"); return false; }
+
+	uint64_t modifier = with_mods ? gbm_bo_get_modifier(r->bo) : DRM_FORMAT_MOD_INVALID;
+	uint32_t handles[4] = { gbm_bo_get_handle(r->bo).u32 };
+	uint32_t pitches[4] = { gbm_bo_get_stride(r->bo) };
+	uint32_t offsets[4] = { gbm_bo_get_offset(r->bo, 0) };
+	uint64_t modifiers[4] = { modifier };
+	int ret = (modifier != DRM_FORMAT_MOD_INVALID)
+		? drmModeAddFB2WithModifiers(d->fd, w, h, DRM_FORMAT_XRGB8888, handles, pitches, offsets, modifiers, &r->fb_id, DRM_MODE_FB_MODIFIERS)
+		: drmModeAddFB2(d->fd, w, h, DRM_FORMAT_XRGB8888, handles, pitches, offsets, &r->fb_id, 0);
+	if (ret) { fprintf(stderr, "[fb-ring] drmModeAddFB2 failed (%s)\n", strerror(errno)); r->fb_id = 0; return false; }
+
+	int dmabuf = gbm_bo_get_fd(r->bo);
+	if (dmabuf < 0) { fprintf(stderr, "[fb-ring] gbm_bo_get_fd failed\n"); return false; }
+	EGLint attrs[32]; int n = 0;
+	attrs[n++] = EGL_WIDTH;                     attrs[n++] = (EGLint)w;
+	attrs[n++] = EGL_HEIGHT;                    attrs[n++] = (EGLint)h;
+	attrs[n++] = EGL_LINUX_DRM_FOURCC_EXT;      attrs[n++] = (EGLint)DRM_FORMAT_XRGB8888;
+	attrs[n++] = EGL_DMA_BUF_PLANE0_FD_EXT;     attrs[n++] = dmabuf;
+	attrs[n++] = EGL_DMA_BUF_PLANE0_OFFSET_EXT; attrs[n++] = (EGLint)offsets[0];
+	attrs[n++] = EGL_DMA_BUF_PLANE0_PITCH_EXT;  attrs[n++] = (EGLint)pitches[0];
+	if (modifier != DRM_FORMAT_MOD_INVALID && e->dmabuf_modifiers) {
+		attrs[n++] = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT; attrs[n++] = (EGLint)(modifier & 0xffffffffu);
+		attrs[n++] = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT; attrs[n++] = (EGLint)(modifier >> 32);
+	}
+	attrs[n++] = EGL_NONE;
+	r->image = e->create_image(e->dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, NULL, attrs);
+	close(dmabuf); // the EGLImage holds its own reference
+	if (r->image == EGL_NO_IMAGE_KHR) { fprintf(stderr, "[fb-ring] eglCreateImageKHR failed (0x%x)\n", eglGetError()); return false; }
+
+	glGenRenderbuffers(1, &r->rbo);
+	glBindRenderbuffer(GL_RENDERBUFFER, r->rbo);
+	e->image_target_renderbuffer(GL_RENDERBUFFER, (GLeglImageOES)r->image);
+	glGenFramebuffers(1, &r->fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, r->fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, r->rbo);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE) { fprintf(stderr, "[fb-ring] FBO incomplete (0x%x)\n", status); return false; }
+	// Start black so the initial modeset never scans out stale memory
+	glClearColor(0.f, 0.f, 0.f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	return true;
+}
+
+/**
+ * Allocate the scanout FB ring used for triple buffering. Every BO, FB id and
+ * render target is created here, once, instead of lazily on the frame path.
+ * Falls back to the EGL window surface when the EGLImage extensions are missing.
+ *
  * @param d Pointer to DRM context
- * @param e Pointer to EGL context
- * @param ring_size Number of framebuffers to pre-allocate (typically 3 for triple-buffering)
+ * @param e Pointer to EGL context (current)
+ * @param ring_size Number of buffers (2-4)
+ * @return true if the ring is active
  */
-static void preallocate_fb_ring(kms_ctx_t *d, egl_ctx_t *e, int ring_size) {
-	if (ring_size <= 0) return;
-	if (g_fb_ring.entries) return; // already done
+static bool init_fb_ring(kms_ctx_t *d, egl_ctx_t *e, int ring_size) {
+	if (ring_size <= 0 || g_fb_ring.entries) return g_fb_ring.count > 0;
+	if (!e->create_image || !e->destroy_image || !e->image_target_renderbuffer) {
+		fprintf(stderr, "[fb-ring] EGLImage render targets unavailable; using the EGL window surface\n");
+		return false;
+	}
 	g_fb_ring.entries = calloc((size_t)ring_size, sizeof(*g_fb_ring.entries));
-	if (!g_fb_ring.entries) { fprintf(stderr, "[fb-ring] allocation failed\n"); return; }
+	if (!g_fb_ring.entries) { fprintf(stderr, "[fb-ring] allocation failed\n"); return false; }
 	g_fb_ring.count = ring_size;
-	fprintf(stderr, "[fb-ring] Preallocating up to %d framebuffers...\n", ring_size);
-	// We intentionally do NOT modeset here; we only want FB IDs ready so first real frame
-	// can modeset without incurring drmModeAddFB latency.
-	for (int i=0; i<ring_size; ++i) {
-		// Simple clear to ensure back buffer considered updated.
-		glClearColor(0.f,0.f,0.f,1.f);
-		glClear(GL_COLOR_BUFFER_BIT);
-		eglSwapBuffers(e->dpy, e->surf);
-		struct gbm_bo *bo = gbm_surface_lock_front_buffer(e->gbm_surf);
-		if (!bo) { fprintf(stderr, "[fb-ring] lock_front_buffer failed at %d\n", i); break; }
-		// Check if this BO already seen (gbm may recycle quickly for small surfaces)
-		int seen = 0;
-		for (int j=0; j<g_fb_ring.produced; ++j) {
-			if (g_fb_ring.entries[j].bo == bo) { seen = 1; break; }
-		}
-		if (!seen) {
-			uint32_t fb_id = 0;
-			struct fb_holder *h = gbm_bo_get_user_data(bo);
-			if (h) fb_id = h->fb;
-			if (!fb_id) {
-				uint32_t handle = gbm_bo_get_handle(bo).u32;
-				uint32_t pitch  = gbm_bo_get_stride(bo);
-				uint32_t width  = gbm_bo_get_width(bo);
-				uint32_t height = gbm_bo_get_height(bo);
-				if (drmModeAddFB(d->fd, width, height, 24, 32, pitch, handle, &fb_id)) {
-					fprintf(stderr, "[fb-ring] drmModeAddFB failed (%s)\n", strerror(errno));
-					gbm_surface_release_buffer(e->gbm_surf, bo);
-					break;
+	g_fb_ring.drm_fd = d->fd;
+
+	uint64_t mods[32];
+	int nmods = 0;
+	uint64_t cap = 0;
+	if (drmGetCap(d->fd, DRM_CAP_ADDFB2_MODIFIERS, &cap) == 0 && cap)
+		nmods = drm_plane_modifiers(d, DRM_FORMAT_XRGB8888, mods, (int)(sizeof(mods) / sizeof(mods[0])));
+
+	for (int i = 0; i < ring_size; ++i) {
+		if (!fb_ring_create_entry(d, e, &g_fb_ring.entries[i], mods, nmods)) {
+			fprintf(stderr, "[fb-ring] Buffer %d setup failed; using the EGL window surface\n", i);
+			fb_ring_destroy(e);
+			return false;
+		}
+	}
+	glFinish(); // initial clears complete before any buffer is scanned out
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	g_scanout_y_flip = 1;
+	fprintf(stderr, "[fb-ring] %d scanout buffers ready (modifier 0x%llx)\n", ring_size,
+		(unsigned long long)gbm_bo_get_modifier(g_fb_ring.entries[0].bo));
+	return true;
+}
+
+// --- Memory footprint (PICKLE_LOW_MEM) ---
+// 512 MB boards (Pi Zero 2 W) share their RAM with the GPU's CMA pool, which holds the
+// scanout buffers, offscreen targets and decoder surfaces. Low-memory mode double-buffers
+// (two ring BOs, one queued frame), keeps offscreen targets at one governor level capped
+// at LOW_MEM_FBO_MAX_PX, renders all multi-video instances through one shared target,
+// halves the demuxer caches and trims mpv's extra decoder surfaces. The startup report
+// sizes what main memory and CMA will have to hold, for any mode.
+#define LOW_MEM_AUTO_KB (640 * 1024) // MemTotal at or below this turns the mode on by default
+
+// A /proc/meminfo field in kB (-1 = not present)
+static long meminfo_kb(const char *key) {
+	FILE *f = fopen("/proc/meminfo", "r");
+	if (!f) return -1;
+	char line[128];
+	long v = -1;
+	size_t n = strlen(key);
+	while (fgets(line, sizeof(line), f)) {
+		if (!strncmp(line, key, n) && line[n] == ':') { v = strtol(line + n + 1, NULL, 10); break; }
+	}
+	fclose(f);
+	return v;
+}
+
+// PICKLE_LOW_MEM=1/0, else on when the board has LOW_MEM_AUTO_KB of RAM or less
+static int low_mem_wanted(void) {
+	const char *env = getenv("PICKLE_LOW_MEM");
+	if (env && *env) return strcmp(env, "0") != 0;
+	long total = meminfo_kb("MemTotal");
+	return total > 0 && total <= LOW_MEM_AUTO_KB;
+}
+
+/**
+ * Largest GPU memory the offscreen targets can take for the current mode: the pools
+ * are sized later from the source and the warped quads, never above this. Instance
+ * shares of the multi-video budget follow quad area, so one instance may get all of
+ * it (capped at one screen) and the shares together never exceed it.
+ */
+static uint64_t mem_fbo_estimate(int screen_w, int screen_h) {
+	double screen_px = (double)screen_w * screen_h, px = 0.0;
+	if (g_video_plane) return 0;
+	if (g_num_videos == 1) {
+		if (!g_keystone.enabled) return 0; // mpv renders straight into the scanout buffer
+		px = screen_px;
+	} else if (g_single_mpv_mode) {
+		px = screen_px / 2; // lavfi composite at half height
+	} else if (g_low_mem) {
+		px = screen_px * fmin(1.0, (double)g_mv_fbo_budget); // shared target: the largest share
+	} else {
+		px = screen_px * fmin((double)g_num_videos, (double)g_mv_fbo_budget); // all shares, at most one screen each
+	}
+	double levels = 0.0;
+	if (g_low_mem) {
+		if (px > LOW_MEM_FBO_MAX_PX) px = LOW_MEM_FBO_MAX_PX;
+		levels = 1.0;
+	} else {
+		for (int l = 0; l < GOV_LEVELS; l++) levels += (double)(g_gov_scales[l] * g_gov_scales[l]);
+	}
+	return (uint64_t)(px * levels) * (uint64_t)g_fbo_formats[g_fbo_format].bytes;
+}
+
+/**
+ * Print what the configuration will allocate: scanout BOs, offscreen targets and
+ * demuxer caches, against the free CMA and available RAM (after mpv's first loadfile,
+ * so the cache profiles are applied)
+ */
+static void mem_budget_report(const kms_ctx_t *d, const mpv_player_t *players, int num_players) {
+	int screen_w = (int)d->mode.hdisplay, screen_h = (int)d->mode.vdisplay;
+	uint64_t scanout = 0;
+	int bos = g_fb_ring.count;
+	for (int i = 0; i < g_fb_ring.count; i++) {
+		struct gbm_bo *bo = g_fb_ring.entries[i].bo;
+		if (bo) scanout += (uint64_t)gbm_bo_get_stride(bo) * gbm_bo_get_height(bo);
+	}
+	if (!bos) {
+		bos = g_triple_buffer ? 3 : 2; // EGL window surface: the GBM surface allocates these on demand
+		scanout = (uint64_t)bos * (uint64_t)screen_w * (uint64_t)screen_h * 4;
+	}
+	uint64_t fbo = mem_fbo_estimate(screen_w, screen_h);
+	uint64_t cache = 0;
+	int cores = 0;
+	for (int i = 0; i < num_players; i++) {
+		if (!players[i].mpv) continue;
+		cores++;
+		if (players[i].cache) cache += (uint64_t)(players[i].cache_max_bytes + players[i].cache_back_bytes);
+	}
+	long cma_total = meminfo_kb("CmaTotal"), cma_free = meminfo_kb("CmaFree");
+	long mem_total = meminfo_kb("MemTotal"), mem_avail = meminfo_kb("MemAvailable");
+	char cma[48] = "no CMA";
+	if (cma_total >= 0) snprintf(cma, sizeof(cma), "CMA %.0f MB (%.0f MB free)", (double)cma_total / 1024.0, (double)cma_free / 1024.0);
+	fprintf(stderr, "[mem] %s mode, RAM %.0f MB (%.0f MB available), %s\n", g_low_mem ? "low-memory" : "standard",
+		(double)mem_total / 1024.0, (double)mem_avail / 1024.0, cma);
+	fprintf(stderr, "[mem]   scanout: %d GBM BOs, %.1f MB\n", bos, (double)scanout / 1e6);
+	fprintf(stderr, "[mem]   offscreen textures: up to %.1f MB (%s, %s)\n", (double)fbo / 1e6,
+		g_fbo_formats[g_fbo_format].name, g_low_mem ? "1 level" : "all governor levels");
+	fprintf(stderr, "[mem]   demuxer caches: up to %.1f MB over %d mpv core%s\n", (double)cache / 1e6, cores, cores == 1 ? "" : "s");
+	fprintf(stderr, "[mem]   decoder surfaces: codec references + %s extra per hwdec core (sized by the stream)\n",
+		g_low_mem ? LOW_MEM_HWDEC_EXTRA_FRAMES : "6");
+	uint64_t gpu = scanout + fbo;
+	fprintf(stderr, "[mem]   budget: %.1f MB GPU/CMA + %.1f MB caches\n", (double)gpu / 1e6, (double)cache / 1e6);
+	if (cma_free >= 0 && (double)gpu > (double)cma_free * 1024.0)
+		LOG_WARN("GPU buffers (%.1f MB) exceed the free CMA (%.1f MB); try PICKLE_LOW_MEM=1 or a larger cma= setting",
+			(double)gpu / 1e6, (double)cma_free * 1024.0 / 1e6);
+	if (mem_avail >= 0 && (double)cache > (double)mem_avail * 1024.0 / 2)
+		LOG_WARN("Demuxer caches (%.1f MB) would take over half the available RAM", (double)cache / 1e6);
+}
+
+typedef struct {
+	kms_ctx_t *drm;
+	egl_ctx_t *egl;
+	mpv_player_t *players;   // players[0] is primary (single video, scheduler, plane mode)
+	int num_players;         // Render contexts to update (1 in single-mpv mode)
+	int active;              // Player presented in single-video mode (playlist swaps it)
+	int force_loop;
+} render_thread_ctx_t;
+
+/**
+ * Build every GL program the compositor can use before the first frame, so no draw
+ * path compiles GLSL on first use (with the program binary cache this is a load).
+ * Programs that fail keep their lazy-init fallbacks. Video-plane mode composes nothing.
+ */
+static void gl_programs_warm(void) {
+	if (g_video_plane) return;
+	int64_t t0 = mono_now_us();
+	if (!g_keystone_shader_program && !init_keystone_shader()) {
+		LOG_WARN("Keystone shader failed to build at startup");
+	} else {
+		// The blend variant binds attributes to the keystone program's locations; the batched
+		// quad buffer draws with the keystone program itself
+		if (!g_blend_program && !g_blend_failed && !init_blend_shader()) g_blend_failed = true;
+		if (g_num_videos > 1 && !g_batch_units && !g_batch_failed && !init_batch_geometry()) g_batch_failed = true;
+	}
+	if (!g_overlay_program && !g_overlay_failed && !init_overlay_shader()) g_overlay_failed = true;
+	LOG_INFO("GL programs ready in %.1f ms (%d from cache, %d compiled)",
+		(double)(mono_now_us() - t0) / 1000.0, g_progcache_hits, g_progcache_builds);
+}
+
+/**
+ * Render thread: owns the EGL context, the mpv render contexts, page flip events
+ * and the flip queue. Control state arrives only through g_cmdq snapshots.
+ */
+static void *render_thread_main(void *arg) {
+	render_thread_ctx_t *rt = (render_thread_ctx_t *)arg;
+	kms_ctx_t *d = rt->drm;
+	egl_ctx_t *e = rt->egl;
+	if (!eglMakeCurrent(e->dpy, e->surf, e->surf, e->ctx)) {
+		fprintf(stderr, "[render] eglMakeCurrent failed (0x%04x)\n", eglGetError());
+		g_stop = 1;
+		return NULL;
+	}
+	gl_programs_warm();
+	int frames = 0;
+	while (!g_stop) {
+		int timeout_ms = -1;
+
+		// Calculate appropriate poll timeout based on frame rate and vsync
+		if (frames == 0 && flipq_can_render()) {
+			timeout_ms = 0; // first frame goes out as soon as possible
+		} else if (!rt->force_loop && g_sched_defer_until_us > 0) {
+			// A frame is pending but scheduled for a later vblank: sleep until its start time
+			int64_t wait_us = g_sched_defer_until_us - mono_now_us();
+			timeout_ms = wait_us > 0 ? (int)((wait_us + 999) / 1000) : 0;
+		} else if (((rt->force_loop && !g_damage_tracking) || g_damage ||
+		            (g_mpv_update_flags & MPV_RENDER_UPDATE_FRAME)) && flipq_can_render()) {
+			timeout_ms = 0; // don't block if render pending (otherwise the flip event wakes us)
+		} else if (rt->force_loop && g_damage_tracking) {
+			timeout_ms = 8; // poll mpv for frames its update callback may not have reported
+		} else if (g_sched_enabled && g_vblank_last_us) {
+			// Scheduler active: flips, mpv updates and commands arrive as fd events
+			timeout_ms = -1;
+		} else if (frames > 0 && g_vsync_enabled) {
+			// Estimate appropriate timeout based on refresh rate for vsync
+			double refresh_rate = d->mode.vrefresh ?
+				(double)d->mode.vrefresh :
+				(double)d->mode.clock / (d->mode.htotal * d->mode.vtotal);
+			if (refresh_rate > 0) {
+				timeout_ms = (int)(500.0 / refresh_rate); // half frame time in ms
+				if (timeout_ms < 4) timeout_ms = 4;
+				if (timeout_ms > 100) timeout_ms = 100;
+			} else {
+				timeout_ms = 16;
+			}
+		}
+		// Flip timeouts are serviced from here: wake for the in-flight flip's deadline
+		int flip_ms = g_scanout_disabled ? -1 : flipq_timeout_ms();
+		if (flip_ms >= 0 && (timeout_ms < 0 || flip_ms < timeout_ms)) timeout_ms = flip_ms;
+		if (timeout_ms < 0) timeout_ms = 100;
+
+		struct pollfd pfds[3]; int n = 0;
+		if (!g_scanout_disabled) { pfds[n].fd = d->fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++; }
+		if (g_render_wake[0] >= 0) { pfds[n].fd = g_render_wake[0]; pfds[n].events = POLLIN; pfds[n].revents = 0; n++; }
+		// Sync-file fds become readable when the GPU work behind them completes
+		if (g_gov.fence_fd >= 0) { pfds[n].fd = g_gov.fence_fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++; }
+		int pr = poll(pfds, (nfds_t)n, timeout_ms);
+		if (pr < 0) { if (errno == EINTR) continue; fprintf(stderr, "[render] poll failed (%s)\n", strerror(errno)); g_stop = 1; break; }
+		for (int i = 0; i < n; i++) {
+			if (!(pfds[i].revents & POLLIN)) continue;
+			if (pfds[i].fd == d->fd) {
+				drmEventContext ev = { .version = DRM_EVENT_CONTEXT_VERSION, .page_flip_handler = page_flip_handler };
+				drmHandleEvent(d->fd, &ev);
+			} else if (pfds[i].fd == g_gov.fence_fd) {
+				gov_fence_signalled();
+			} else {
+				unsigned char buf[64]; while (read(g_render_wake[0], buf, sizeof(buf)) > 0) { /* drain */ }
+			}
+		}
+		if (g_stop) break;
+		if (!g_scanout_disabled) flipq_service();
+
+		render_cmd_t cmd;
+		while (render_cmd_pop(&cmd)) {
+			switch (cmd.type) {
+			case RCMD_SNAPSHOT: {
+				render_snapshot_t *old = g_rs;
+				g_rs = &g_snap[cmd.arg];
+				g_damage |= snapshot_damage(old, g_rs); // before the ack hands the old slot back
+				atomic_store_explicit(&g_snap_acked, 1, memory_order_release);
+				break;
+			}
+			case RCMD_FLIP_RESET:
+				flipq_reset();
+				g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+				break;
+			case RCMD_PLAYER_ATTACH:
+				// Render contexts live on the thread that owns the GL context
+				atomic_store(&g_pl_attached, init_mpv_render(&rt->players[cmd.arg]) ? 1 : -1);
+				break;
+			case RCMD_PLAYER_SWAP: {
+				mpv_player_t *old = &rt->players[rt->active];
+				rt->active = cmd.arg;
+				g_sched_rctx[0] = rt->players[rt->active].rctx;
+				g_videos[0].player = &rt->players[rt->active];
+				if (old->rctx) { mpv_render_context_free(old->rctx); old->rctx = NULL; }
+				atomic_store_explicit(&g_pl_swapped, 1, memory_order_release); // control thread may now switch g_pl.cur
+				g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+				break;
+			}
+			case RCMD_PLAYER_DETACH: {
+				mpv_player_t *pl = &rt->players[cmd.arg];
+				if (pl->rctx) { mpv_render_context_free(pl->rctx); pl->rctx = NULL; }
+				atomic_store(&g_pl_swapped, 1);
+				break;
+			}
+			case RCMD_REDRAW:
+			default:
+				g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+				break;
+			}
+		}
+		if (atomic_exchange(&g_render_update, 0) || (rt->force_loop && g_damage_tracking)) {
+			for (int i = 0; i < rt->num_players; i++) {
+				mpv_player_t *pl = &rt->players[i];
+				if (!pl->rctx) continue;
+				// A pre-rolling standby's first frame must not trigger renders of the current item
+				if (g_pl.count && i != rt->active) { mpv_render_context_update(pl->rctx); continue; }
+				uint64_t flags = mpv_render_context_update(pl->rctx);
+				g_mpv_update_flags |= flags;
+				if (flags & MPV_RENDER_UPDATE_FRAME) atomic_store_explicit(&g_wd.frame_ready_us, mono_now_us(), memory_order_relaxed);
+				if ((flags & MPV_RENDER_UPDATE_FRAME) && !atomic_load_explicit(&g_boot.decoded_us, memory_order_relaxed))
+					atomic_store(&g_boot.decoded_us, mono_now_us());
+				// Per-instance flags feed the multi-video update scheduler
+				for (int v = 0; v < g_num_videos; v++) {
+					if (g_videos[v].player == pl) g_videos[v].update_flags |= flags;
 				}
-				struct fb_holder *nh = calloc(1, sizeof(*nh));
-				if (nh) { nh->fb = fb_id; nh->fd = d->fd; gbm_bo_set_user_data(bo, nh, bo_destroy_handler); }
 			}
-			if (g_fb_ring.produced < g_fb_ring.count) {
-				g_fb_ring.entries[g_fb_ring.produced].bo = bo;
-				g_fb_ring.entries[g_fb_ring.produced].fb_id = fb_id;
-				g_fb_ring.produced++;
+		}
+
+		// Check if we can render a new frame
+		// Rendering overlaps scanout: frame N+1 is drawn while N waits in the flip queue
+		int need_frame = 0;
+		bool can_render = flipq_can_render();
+		unsigned damage = g_damage;
+		if ((g_mpv_update_flags & MPV_RENDER_UPDATE_FRAME) || frames == 0 || (rt->force_loop && !g_damage_tracking))
+			damage |= DAMAGE_VIDEO;
+		if (frames == 0 && can_render) need_frame = 1; // guarantee first frame submission
+		else if (rt->force_loop && !g_damage_tracking && can_render) need_frame = 1; // continuous mode
+		else if (damage && can_render) need_frame = 1;
+		else if (rt->force_loop && can_render) atomic_fetch_add(&g_stats_idle, 1); // last frame stays on screen
+
+		// Presentation scheduling: hold the frame until just before its target vblank
+		g_sched_defer_until_us = 0;
+		// The first decoded frame goes out at once (time to first frame beats pacing)
+		bool first_video = atomic_load(&g_boot.decoded_us) && !atomic_load(&g_boot.render_us);
+		// Keystone/overlay-only changes are not paced against a video frame's target time
+		if (need_frame && frames > 0 && !rt->force_loop && !first_video && (damage & DAMAGE_VIDEO)) {
+			int64_t start = sched_render_start_us(&rt->players[rt->active]);
+			if (start > mono_now_us() + 500) {
+				need_frame = 0;
+				g_sched_defer_until_us = start;
+			}
+		}
+
+		// Nothing to draw and nothing waiting on the display: the screen is idle by design
+		// (paused, still image), which the stall watchdog must not take for a stall
+		if (!need_frame && !damage && !g_sched_defer_until_us && g_flipq.len == 0 && frames > 0)
+			atomic_store_explicit(&g_wd.idle_us, mono_now_us(), memory_order_relaxed);
+
+		// Frame pacing: if target FPS is set, throttle frame rate for smooth playback
+		if (need_frame && g_target_fps > 0 && frames > 0) {
+			struct timeval now;
+			gettimeofday(&now, NULL);
+			double elapsed_us = (double)(now.tv_sec - g_last_render_time.tv_sec) * 1000000.0 +
+			                    (double)(now.tv_usec - g_last_render_time.tv_usec);
+			if (elapsed_us < g_frame_interval_us) need_frame = 0;
+		}
+
+		if (need_frame) {
+			if (g_debug && frames < 10) fprintf(stderr, "[debug] rendering frame #%d flags=0x%llx queued_flips=%d\n", frames, (unsigned long long)g_mpv_update_flags, g_flipq.len);
+			int64_t render_start = mono_now_us();
+			if (!render_frame_fixed(d, e, &rt->players[rt->active], (damage & DAMAGE_VIDEO) != 0)) {
+				fprintf(stderr, "Render failed, exiting\n");
+				g_stop = 1;
+				break;
 			}
+			prof_frame_end();
+			if (first_video) {
+				atomic_store(&g_boot.render_us, render_start);
+				if (g_scanout_disabled) atomic_store(&g_boot.shown_us, mono_now_us());
+			}
+			// Smoothed render cost decides how early the scheduler starts the next frame
+			int64_t cost = mono_now_us() - render_start;
+			if (g_vblank_period_us > 0 && cost > g_vblank_period_us) cost = g_vblank_period_us;
+			g_render_cost_us = g_render_cost_us ? g_render_cost_us + (cost - g_render_cost_us) / 8 : cost;
+			frames++;
+			gov_frame_done();
+			atomic_store(&g_render_frames, frames);
+			g_mpv_update_flags &= ~(uint64_t)MPV_RENDER_UPDATE_FRAME;
+			g_damage = 0;
+			if (g_mv_backlog) g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME; // deferred instances go next
+			if (g_video_plane_refill) g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME; // the plane gets its frame next
+			g_video_plane_refill = 0;
+			atomic_fetch_add(&g_stats_frames, 1); // also read by the metrics endpoint
+			atomic_store(&g_last_frame_us, mono_now_us()); // Update last successful frame time
+			atomic_store_explicit(&g_wd.render_us, mono_now_us(), memory_order_relaxed);
 		}
-		// Release immediately so normal rendering path can reacquire; we only needed FB ID.
-		gbm_surface_release_buffer(e->gbm_surf, bo);
-		if (g_fb_ring.produced >= g_fb_ring.count) break;
+		if (rt->force_loop && !g_damage_tracking && !need_frame && can_render) usleep(1000); // light backoff
 	}
-	fprintf(stderr, "[fb-ring] Prepared %d unique framebuffer(s)\n", g_fb_ring.produced);
+	if (g_gov.fence_fd >= 0) { close(g_gov.fence_fd); g_gov.fence_fd = -1; }
+	eglMakeCurrent(e->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	return NULL;
 }
 
 int main(int argc, char **argv) {
+	g_boot.start_us = mono_now_us();
 	// Parse command line options
 	static struct option long_options[] = {
 		{"loop", no_argument, NULL, 'l'},
 		{"stats", no_argument, NULL, 's'},
 		{"help", no_argument, NULL, 'h'},
 		{"version", no_argument, NULL, 'V'},
+		{"bench", optional_argument, NULL, 'B'},
+		{"playlist", required_argument, NULL, 'p'},
 		{0, 0, 0, 0}
 	};
 
 	int opt;
-	while ((opt = getopt_long(argc, argv, "lshV", long_options, NULL)) != -1) {
+	while ((opt = getopt_long(argc, argv, "lshVp:", long_options, NULL)) != -1) {
 		switch (opt) {
 			case 'l':
 				g_loop_playback = 1;
@@ -3890,23 +9177,37 @@ int main(int argc, char **argv) {
 			case 's':
 				g_stats_enabled = 1;
 				break;
+			case 'p':
+				if (!playlist_load(optarg)) return 1;
+				break;
+			case 'B':
+				g_bench_frames = optarg ? atoi(optarg) : BENCH_DEFAULT_FRAMES;
+				if (g_bench_frames <= 0) {
+					fprintf(stderr, "Error: --bench frame count must be positive\n");
+					return 1;
+				}
+				break;
 			case 'V':
 				fprintf(stderr, "pickle %s (built %s)\n", PICKLE_VERSION_STRING, PICKLE_BUILD_DATE);
 				fprintf(stderr, "DRM/KMS + GBM + EGL + libmpv video player for Raspberry Pi 4\n");
 				return 0;
 			case 'h':
 				fprintf(stderr, "pickle %s - DRM/KMS video player for Raspberry Pi 4\n\n", PICKLE_VERSION_STRING);
-				fprintf(stderr, "Usage: %s [options] <video-file> [video-file2]\n", argv[0]);
+				fprintf(stderr, "Usage: %s [options] <video-file> [video-file2 ... video-file%d]\n", argv[0], MAX_VIDEOS);
 				fprintf(stderr, "Options:\n");
 				fprintf(stderr, "  -l, --loop            Loop playback continuously\n");
 				fprintf(stderr, "  -s, --stats           Enable performance statistics overlay\n");
 				fprintf(stderr, "  -h, --help            Show this help message\n");
 				fprintf(stderr, "  -V, --version         Show version information\n");
-				fprintf(stderr, "\nDual video mode:\n");
-				fprintf(stderr, "  When two video files are specified, each video plays in its own\n");
-				fprintf(stderr, "  keystone region. Use Tab to cycle corners (1-8) across both keystones.\n");
-				fprintf(stderr, "  Keystone 1 (green corners) = left half, Keystone 2 (blue corners) = right half.\n");
-				fprintf(stderr, "  Configs saved to keystone_0.conf and keystone_1.conf respectively.\n");
+				fprintf(stderr, "  -p, --playlist FILE   Play the files/URLs listed in FILE (one per line) gaplessly;\n");
+				fprintf(stderr, "                        with -l the list repeats\n");
+				fprintf(stderr, "      --bench[=N]       Run the offscreen benchmark scenarios, N frames each (default %d);\n", BENCH_DEFAULT_FRAMES);
+				fprintf(stderr, "                        files given are used as sources instead of lavfi testsrc2\n");
+				fprintf(stderr, "\nMulti-video mode:\n");
+				fprintf(stderr, "  When several video files are specified (up to %d), each video plays in its\n", MAX_VIDEOS);
+				fprintf(stderr, "  own keystone region. Use Tab to cycle corners across all keystones.\n");
+				fprintf(stderr, "  Two videos start as left/right halves, more as a grid (row by row).\n");
+				fprintf(stderr, "  Video N's config is saved to keystone_<N-1>.conf.\n");
 				fprintf(stderr, "\nSee README.md for environment variables and keystone controls.\n");
 				return 0;
 			default:
@@ -3915,23 +9216,100 @@ int main(int argc, char **argv) {
 		}
 	}
 
-	if (optind >= argc) {
+	// Benchmark mode: every scenario runs in a forked child that continues below
+	// as a normal (offscreen, unpaced) player of the benchmark sources
+	char **file_args = argv + optind;
+	int num_files = argc - optind;
+	char *bench_args[2];
+	if (g_bench_frames > 0) {
+		const char *src = optind < argc ? argv[optind] : getenv("PICKLE_BENCH_SOURCE");
+		if (!src || !*src) src = BENCH_DEFAULT_SOURCE;
+		const char *src2 = optind + 1 < argc ? argv[optind + 1] : src;
+		int rc = 0;
+		playlist_free(); // scenarios play their fixed sources
+		if (bench_run(src, &rc) < 0) return rc;
+		const bench_scenario_t *b = &g_bench_scenarios[g_bench_scenario];
+		bench_args[0] = (char *)src;
+		bench_args[1] = (char *)src2;
+		file_args = bench_args;
+		num_files = b->videos;
+		setenv("PICKLE_SINGLE_MPV", b->single_mpv ? "1" : "0", 1);
+		setenv("PICKLE_DUAL_SPLIT", b->dual_split ? "1" : "0", 1);
+		setenv("PICKLE_ALTERNATE_FRAMES", "1", 1);
+		setenv("PICKLE_KEYSTONE", "0", 1); // bench_apply_keystone() sets the scenario's warp
+		setenv("PICKLE_LOOP", "1", 1);
+		unsetenv("PICKLE_TARGET_FPS");
+		unsetenv("PICKLE_VIDEO_PLANE");
+		g_scanout_disabled = 1; // never touch the display: no modeset, no page flips
+		g_sched_enabled = 0;
+		g_prof_enabled = 1;     // frame-time histogram
+		g_prof_gpu_timing = 1;
+		fprintf(stderr, "[bench] scenario %s\n", b->name);
+	} else if (g_pl.count) {
+		if (optind < argc) LOG_WARN("--playlist given: ignoring %d file argument(s)", argc - optind);
+		file_args = g_pl.items;
+		num_files = 1;
+	} else if (optind >= argc) {
 		fprintf(stderr, "Error: No input file specified\n");
-		fprintf(stderr, "Usage: %s [options] <video-file> [video-file2]\n", argv[0]);
+		fprintf(stderr, "Usage: %s [options] <video-file> [video-file2 ...]\n", argv[0]);
 		return 1;
 	}
 
-	// Count video files (1 or 2 supported)
-	int num_files = argc - optind;
+	// Count video files (1..MAX_VIDEOS supported)
 	if (num_files > MAX_VIDEOS) {
 		fprintf(stderr, "Warning: Only %d video files supported, ignoring extras\n", MAX_VIDEOS);
 		num_files = MAX_VIDEOS;
 	}
 	g_num_videos = num_files;
-	if (g_num_videos == 1 && g_single_mpv_mode) {
-		// Single-mpv mode is only meaningful in dual-video; disable to avoid confusion
+	// Single mpv lavfi-complex mode (1=on, 0=off)
+	const char *single_mpv = getenv("PICKLE_SINGLE_MPV");
+	if (single_mpv && *single_mpv) g_single_mpv_mode = atoi(single_mpv) ? 1 : 0;
+	if (g_num_videos != 2 && g_single_mpv_mode) {
+		// Single-mpv mode composes exactly two inputs side by side; disable otherwise
+		if (g_num_videos > 2) LOG_WARN("PICKLE_SINGLE_MPV needs exactly two videos; using one mpv per video");
 		g_single_mpv_mode = 0;
 	}
+	// Dual split mode replaces the lavfi composite with two synchronized cores
+	const char *dual_split = getenv("PICKLE_DUAL_SPLIT");
+	if (dual_split && *dual_split) g_dual_split = atoi(dual_split) ? 1 : 0;
+	if (g_dual_split && g_num_videos != 2) {
+		if (g_num_videos > 2) LOG_WARN("PICKLE_DUAL_SPLIT needs exactly two videos; ignoring it");
+		g_dual_split = 0;
+	}
+	if (g_dual_split && g_single_mpv_mode) {
+		LOG_INFO("PICKLE_DUAL_SPLIT overrides PICKLE_SINGLE_MPV");
+		g_single_mpv_mode = 0;
+	}
+	
+	// Multi-video update scheduler: mpv renders per composite and the FBO pixel budget
+	const char *alt_frame = getenv("PICKLE_ALTERNATE_FRAMES");
+	if (alt_frame && *alt_frame) g_alternate_frame_mode = atoi(alt_frame) ? 1 : 0;
+	const char *mv_updates = getenv("PICKLE_MV_UPDATES");
+	if (mv_updates && *mv_updates) g_mv_updates_per_frame = atoi(mv_updates);
+	if (g_mv_updates_per_frame <= 0 || g_mv_updates_per_frame > g_num_videos) {
+		// Default: about half the instances per frame (one of two, as in dual-video alternation);
+		// synchronized split sources both update every composite, like the lavfi composite
+		g_mv_updates_per_frame = (g_alternate_frame_mode && !g_dual_split) ? (g_num_videos + 1) / 2 : g_num_videos;
+	}
+	const char *mv_budget = getenv("PICKLE_MV_FBO_BUDGET");
+	if (mv_budget && *mv_budget) {
+		float v = strtof(mv_budget, NULL);
+		if (v >= 0.05f && v <= 4.0f) g_mv_fbo_budget = v;
+		else LOG_WARN("PICKLE_MV_FBO_BUDGET=%s out of range (0.05-4), using %.2f", mv_budget, (double)g_mv_fbo_budget);
+	}
+	
+	// FBO resolution governor (on by default; 0 pins offscreen targets at level 0)
+	const char *gov_env = getenv("PICKLE_FBO_GOVERNOR");
+	if (gov_env && *gov_env == '0') g_gov.enabled = 0;
+	
+	// Offscreen target format: the cheapest one the driver and mpv accept, starting here
+	const char *fmt_env = getenv("PICKLE_FBO_FORMAT");
+	if (fmt_env && *fmt_env) {
+		int f = 0;
+		while (f < FBO_FORMATS && strcmp(fmt_env, g_fbo_formats[f].name) != 0) f++;
+		if (f < FBO_FORMATS) g_fbo_format = f;
+		else LOG_WARN("PICKLE_FBO_FORMAT=%s unknown (rgb565, rgb8, rgba8), using %s", fmt_env, g_fbo_formats[g_fbo_format].name);
+	}
 	
 	// Target FPS can be set via environment variable for frame pacing
 	// By default, let GPU render at natural rate (vsync handles timing)
@@ -3945,9 +9323,9 @@ int main(int argc, char **argv) {
 	}
 	
 	// Store video file paths
-	const char *files[MAX_VIDEOS] = {NULL, NULL};
+	const char *files[MAX_VIDEOS] = {NULL};
 	for (int i = 0; i < num_files; i++) {
-		files[i] = argv[optind + i];
+		files[i] = file_args[i];
 		g_videos[i].video_file = files[i];
 	}
 	
@@ -3959,6 +9337,13 @@ int main(int argc, char **argv) {
 	if (loop_env && *loop_env) {
 		g_loop_playback = atoi(loop_env);
 	}
+	// Playlist: looping repeats the list; individual items are never looped by mpv
+	if (g_pl.count) {
+		g_pl.loop = g_loop_playback;
+		g_loop_playback = 0;
+		g_pl.next = playlist_after(0);
+		LOG_INFO("Playlist: %d item%s%s", g_pl.count, g_pl.count == 1 ? "" : "s", g_pl.loop ? ", looping" : "");
+	}
 	
 	// If looping is enabled, set a longer stall detection threshold
 	// This helps prevent false stalls during loop transitions
@@ -3989,6 +9374,14 @@ int main(int argc, char **argv) {
 	const char *disable_triple = getenv("PICKLE_NO_TRIPLE_BUFFER");
 	if (disable_triple && *disable_triple) g_triple_buffer = 0;
 	
+	// Memory-footprint mode: decided before the mpv cores are created (decoder surfaces)
+	g_low_mem = low_mem_wanted();
+	if (g_low_mem) {
+		g_triple_buffer = 0;
+		LOG_INFO("Low-memory mode: double buffering, one %.2f Mpx offscreen level, shared multi-video target, halved mpv caches",
+			(double)LOW_MEM_FBO_MAX_PX / 1e6);
+	}
+	
 	// Vsync control
 	const char *disable_vsync = getenv("PICKLE_NO_VSYNC");
 	if (disable_vsync && *disable_vsync) g_vsync_enabled = 0;
@@ -4005,8 +9398,15 @@ int main(int argc, char **argv) {
 
 	struct kms_ctx drm = {0};
 	struct egl_ctx eglc = {0};
-	mpv_player_t player = {0};      // Primary player (for single video mode)
-	mpv_player_t player2 = {0};     // Secondary player (for dual video mode)
+	mpv_player_t players[MAX_VIDEOS]; // One mpv per video (only players[0] in single-mpv mode)
+	memset(players, 0, sizeof(players));
+	mpv_player_t *player = &players[0]; // Primary player: stats, help overlay, watchdog recovery
+	int num_players = (g_num_videos > 1 && g_single_mpv_mode) ? 1 : g_num_videos;
+	if (g_pl.count) {
+		num_players = 2; // current item + pre-rolled standby
+		g_pl.slot[0] = &players[0];
+		g_pl.slot[1] = &players[1];
+	}
 
 	// Parse stats env
 	const char *stats_env = getenv("PICKLE_STATS");
@@ -4019,6 +9419,15 @@ int main(int argc, char **argv) {
 		}
 	}
 	
+	// Per-stage profiler: periodic report at the stats interval, optional JSON dump at exit
+	const char *prof_env = getenv("PICKLE_PROFILE");
+	g_prof_dump_path = getenv("PICKLE_PROFILE_DUMP");
+	if (g_prof_dump_path && !*g_prof_dump_path) g_prof_dump_path = NULL;
+	if ((prof_env && *prof_env && strcmp(prof_env, "0") != 0) || g_prof_dump_path) {
+		g_prof_enabled = g_prof_gpu_timing = g_prof_report = 1;
+		gettimeofday(&g_prof_last, NULL);
+	}
+	
 	// Initialize stats timer if enabled (by flag or env)
 	if (g_stats_enabled) {
 		const char *ival = getenv("PICKLE_STATS_INTERVAL");
@@ -4031,21 +9440,58 @@ int main(int argc, char **argv) {
 		fprintf(stderr, "[stats] enabled interval=%.2fs\n", g_stats_interval_sec);
 	}
 
+	// mpv cores (mpv_create/mpv_initialize) and file readahead run on a worker while
+	// KMS and EGL come up; render contexts and loadfile follow once EGL exists
+	mpv_boot_ctx_t mpv_boot = { .players = players, .files = files, .count = num_players };
+	pthread_t mpv_boot_tid;
+	int mpv_boot_started = 0;
+	const char *no_mpv_env = getenv("PICKLE_NO_MPV");
+	if (!(g_num_videos > 1 && g_single_mpv_mode) && !(no_mpv_env && *no_mpv_env)) {
+		if (g_pl.count) mpv_boot.count = 1; // the standby slot is filled by playlist_step()
+		mpv_boot_started = pthread_create(&mpv_boot_tid, NULL, mpv_boot_main, &mpv_boot) == 0;
+		if (!mpv_boot_started) fprintf(stderr, "[boot] worker thread failed; initializing mpv in sequence\n");
+	}
+
 	if (!init_drm(&drm)) RET("init_drm");
+	g_boot.drm_us = mono_now_us();
 	if (!init_gbm_egl(&drm, &eglc)) RET("init_gbm_egl");
-	// Optional preallocation of FB ring (env PICKLE_FB_RING, default 3)
-	int fb_ring_n = 3; {
+	g_boot.egl_us = mono_now_us();
+	g_kms_for_mpv = &drm; // DRM handles for mpv's zero-copy drmprime interop
+	
+	// Presentation scheduler: seed the refresh period from the mode, refined from flip timestamps
+	const char *sched_env = getenv("PICKLE_SCHED");
+	if (sched_env && *sched_env && strcmp(sched_env, "0") == 0) g_sched_enabled = 0;
+	if (drm.mode.clock && drm.mode.htotal && drm.mode.vtotal) {
+		g_vblank_period_us = (int64_t)drm.mode.htotal * drm.mode.vtotal * 1000 / drm.mode.clock;
+	} else if (drm.mode.vrefresh) {
+		g_vblank_period_us = 1000000 / (int64_t)drm.mode.vrefresh;
+	}
+	uint64_t ts_cap = 0;
+	g_vblank_monotonic = (drmGetCap(drm.fd, DRM_CAP_TIMESTAMP_MONOTONIC, &ts_cap) == 0 && ts_cap) ? 1 : 0;
+	if (g_sched_enabled) {
+		g_mpv_block_for_target = 0; // we wait for the target ourselves instead of inside mpv
+		LOG_INFO("Presentation scheduler: period %.3f ms, %s vblank timestamps",
+			(double)g_vblank_period_us / 1000.0, g_vblank_monotonic ? "monotonic" : "local");
+	}
+	// Scanout FB ring (env PICKLE_FB_RING, 2-4 buffers, default 3, 2 in low-memory mode; 0 = EGL window surface)
+	int fb_ring_n = g_low_mem ? 2 : 3; {
 		const char *re = getenv("PICKLE_FB_RING");
 		if (re && *re) {
-			int v = atoi(re); if (v > 0 && v < 16) fb_ring_n = v; }
+			int v = atoi(re);
+			if (v == 0) fb_ring_n = 0;
+			else if (v >= 2 && v <= 4) fb_ring_n = v;
+			else LOG_WARN("PICKLE_FB_RING=%s out of range (2-4), using %d", re, fb_ring_n);
+		}
 	}
-	preallocate_fb_ring(&drm, &eglc, fb_ring_n);
+	init_fb_ring(&drm, &eglc, fb_ring_n);
+	g_boot.ring_us = mono_now_us();
 	
 	// Initialize keystone correction based on number of videos
 	if (g_num_videos == 1) {
 		// Single video mode: use legacy keystone_init()
 		keystone_init();
-		g_videos[0].player = &player;
+		if (g_bench_scenario >= 0) bench_apply_keystone();
+		g_videos[0].player = player;
 		g_videos[0].use_subrect = 0;
 	} else {
 		// Multi-video mode: initialize each video instance with split keystones
@@ -4057,30 +9503,64 @@ int main(int argc, char **argv) {
 		}
 		if (g_single_mpv_mode) {
 			// Both keystones sample from the same composite texture; set sub-rects
-			g_videos[0].player = &player;
-			g_videos[1].player = &player; // shared mpv
+			g_videos[0].player = player;
+			g_videos[1].player = player; // shared mpv
 			g_videos[0].use_subrect = 1; g_videos[0].u0 = 0.0f; g_videos[0].u1 = 0.5f; g_videos[0].v0 = 0.0f; g_videos[0].v1 = 1.0f;
 			g_videos[1].use_subrect = 1; g_videos[1].u0 = 0.5f; g_videos[1].u1 = 1.0f; g_videos[1].v0 = 0.0f; g_videos[1].v1 = 1.0f;
 		} else {
-			g_videos[0].player = &player;
-			g_videos[1].player = &player2;
+			for (int i = 0; i < g_num_videos; i++) g_videos[i].player = &players[i];
 		}
 		// Set initial active corner to video 0, corner 0 (top-left)
 		g_active_corner_global = 0;
 		g_videos[0].keystone.active_corner = 0;
-		fprintf(stderr, "\nDual video mode: %d videos loaded\n", g_num_videos);
+		fprintf(stderr, "\nMulti-video mode: %d videos loaded, %d mpv render%s per frame\n", g_num_videos,
+			g_single_mpv_mode ? 1 : g_mv_updates_per_frame, (g_single_mpv_mode || g_mv_updates_per_frame == 1) ? "" : "s");
+	}
+	
+	// Optional direct video plane scanout (PICKLE_VIDEO_PLANE=1): decoded frames go
+	// straight to a KMS overlay plane via mpv's drmprime-overlay interop. Single video
+	// only; while keystone, border or help are on the frame is composed by GL instead.
+	const char *vp_env = getenv("PICKLE_VIDEO_PLANE");
+	if (vp_env && *vp_env && strcmp(vp_env, "0") != 0) {
+		if (!drm.atomic || drm.overlay_planes == 0) {
+			LOG_WARN("PICKLE_VIDEO_PLANE ignored: needs atomic modesetting and a free overlay plane");
+		} else if (g_num_videos != 1) {
+			LOG_WARN("PICKLE_VIDEO_PLANE ignored: multiple videos need GL composition");
+		} else {
+			g_video_plane_wanted = 1;
+			g_video_plane = !(g_keystone.enabled || g_show_border);
+			LOG_INFO("Video plane scanout enabled (GPU composition bypassed%s)",
+				g_video_plane ? "" : " once keystone and border are off");
+		}
 	}
 	
 	// Initialize mpv player(s)
+	if (mpv_boot_started) {
+		pthread_join(mpv_boot_tid, NULL);
+		mpv_boot_started = 0;
+		if (!mpv_boot.ok) RET("mpv core init");
+	}
 	if (g_num_videos > 1 && g_single_mpv_mode) {
-		if (!init_mpv_lavfi_dual(&player, files[0], files[1])) RET("init_mpv_lavfi_dual");
+		if (!init_mpv_lavfi_dual(player, files[0], files[1])) RET("init_mpv_lavfi_dual");
 		// Shared player already assigned above
 	} else {
-		if (!init_mpv(&player, files[0])) RET("init_mpv");
-		if (g_num_videos > 1) {
-			if (!init_mpv(&player2, files[1])) RET("init_mpv (video 2)");
+		if (g_dual_split && !(no_mpv_env && *no_mpv_env)) {
+			// Without the startup worker the follower's core does not exist yet: create it
+			// here so the trim still lands before its file is loaded
+			if (!players[1].mpv && !init_mpv_handle(&players[1])) RET("follower mpv core");
+			dual_split_follower_setup(&players[1]);
+		}
+		for (int i = 0; i < g_num_videos; i++) {
+			if (!init_mpv(&players[i], files[i])) {
+				fprintf(stderr, "init_mpv failed for video %d (%s)\n", i + 1, files[i]);
+				goto fail;
+			}
 		}
 	}
+	g_boot.mpv_us = mono_now_us();
+	mem_budget_report(&drm, players, num_players);
+	// Completed flips are reported to every render context that presents through them
+	for (int i = 0; i < num_players; i++) g_sched_rctx[i] = players[i].rctx;
 	// Prime event processing in case mpv already queued wakeups before pipe creation.
 	g_mpv_wakeup = 1;
 
@@ -4106,10 +9586,11 @@ int main(int argc, char **argv) {
 		fprintf(stderr, "  k - Toggle keystone mode\n");
 		fprintf(stderr, "  1-4 - Select corner to adjust\n");
 	} else {
-		fprintf(stderr, "\nDual keystone mode. Controls:\n");
-		fprintf(stderr, "  Tab - Cycle through all 8 corners (both keystones)\n");
-		fprintf(stderr, "  1-4 - Select corner on keystone 1 (green)\n");
-		fprintf(stderr, "  5-8 - Select corner on keystone 2 (blue)\n");
+		fprintf(stderr, "\nMulti keystone mode. Controls:\n");
+		fprintf(stderr, "  Tab - Cycle through all %d corners (every keystone)\n", g_num_videos * 4);
+		fprintf(stderr, "  v then 1-%d - Select keystone\n", g_num_videos);
+		fprintf(stderr, "  1-4 - Select corner on the selected keystone (keystone 1 at start)\n");
+		fprintf(stderr, "  5-8 - Select corner on keystone 2\n");
 	}
 	fprintf(stderr, "  w/a/s/d - Move selected corner up/left/down/right\n");
 	fprintf(stderr, "  +/- - Increase/decrease adjustment step size\n");
@@ -4119,11 +9600,12 @@ int main(int argc, char **argv) {
 	fprintf(stderr, "  (border draws around keystone quad; background is always black)\n\n");
 
 	// Watchdog: if no frame submitted within WD_FIRST_MS, force a render attempt even if mpv flags missing.
-	int frames = 0;
 	int force_loop = getenv("PICKLE_FORCE_RENDER_LOOP") ? 1 : 0;
-	struct timeval wd_last_activity; gettimeofday(&wd_last_activity, NULL);
-	gettimeofday(&g_last_frame_time, NULL); // Initialize last frame time
+	const char *damage_env = getenv("PICKLE_DAMAGE");
+	if (damage_env && strcmp(damage_env, "0") == 0) g_damage_tracking = 0; // full render on every change
+	atomic_store(&g_last_frame_us, mono_now_us()); // Initialize last frame time
 	int wd_forced_first = 0;
+	int wd_frames_at_reset = 0;
 	// Create wakeup pipe (non-blocking) to integrate mpv callback into poll
 	if (g_mpv_pipe[0] < 0) {
 		if (pipe(g_mpv_pipe) == 0) {
@@ -4133,6 +9615,12 @@ int main(int argc, char **argv) {
 			fprintf(stderr, "[mpv] pipe() failed (%s)\n", strerror(errno));
 		}
 	}
+	// Metrics endpoint (PICKLE_METRICS_SOCKET=/path or @abstract); stage timings are recorded
+	// for it, but GPU timestamps and the stderr report stay with PICKLE_PROFILE
+	const char *metrics_env = getenv("PICKLE_METRICS_SOCKET");
+	if (metrics_env && *metrics_env && metrics_open(metrics_env)) g_prof_enabled = 1;
+	const char *ctl_env = getenv("PICKLE_CONTROL_SOCKET");
+	if (ctl_env && *ctl_env) ctl_open(ctl_env);
 	
 	// Configure terminal for raw input mode to capture keystrokes
 	struct termios old_term, new_term;
@@ -4157,59 +9645,50 @@ int main(int argc, char **argv) {
 	LOG_INFO("START+SELECT (hold 2s)=Quit");
 	}
 	
+	// Render thread: gets the EGL context, the first keystone snapshot and its wakeup pipe
+	render_snapshot_fill(&g_snap[0]);
+	if (pipe(g_render_wake) == 0) {
+		int fl = fcntl(g_render_wake[0], F_GETFL, 0); fcntl(g_render_wake[0], F_SETFL, fl | O_NONBLOCK);
+		fl = fcntl(g_render_wake[1], F_GETFL, 0); fcntl(g_render_wake[1], F_SETFL, fl | O_NONBLOCK);
+	} else {
+		fprintf(stderr, "[render] pipe() failed (%s)\n", strerror(errno));
+	}
+	render_thread_ctx_t rt = { .drm = &drm, .egl = &eglc, .players = players, .num_players = num_players,
+		.force_loop = force_loop };
+	pthread_t render_tid;
+	eglMakeCurrent(eglc.dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (pthread_create(&render_tid, NULL, render_thread_main, &rt) != 0) {
+		fprintf(stderr, "[render] pthread_create failed\n");
+		eglMakeCurrent(eglc.dpy, eglc.surf, eglc.surf, eglc.ctx);
+		goto fail;
+	}
+	
+	// Control loop: input, mpv events, stats and the watchdog. Never touches GL.
 	while (!g_stop) {
-		// Drain any pending mpv events BEFORE potentially blocking in poll to avoid startup deadlock
+		// Drain any pending mpv events BEFORE potentially blocking in poll
 		if (g_mpv_wakeup) {
 			g_mpv_wakeup = 0;
-			drain_mpv_events(player.mpv);
-			if (player.rctx) {
-				uint64_t flags = mpv_render_context_update(player.rctx);
-				g_mpv_update_flags |= flags;
-			}
-			// Handle second player in dual-video mode
-			if (g_num_videos > 1 && player2.mpv) {
-				drain_mpv_events(player2.mpv);
-				if (player2.rctx) {
-					uint64_t flags = mpv_render_context_update(player2.rctx);
-					g_mpv_update_flags |= flags;
-				}
-			}
-		}
-		// Check controller quit combo (START+SELECT 2s)
-		if (g_joystick_enabled) {
-			// Polling cadence: on every loop iteration; guarded by state flags
-			struct timeval now; gettimeofday(&now, NULL);
-			(void)now; // currently unused beyond gettimeofday side effect
-			// Reuse debounce window — quit independent of debounce thresholds
-			if (g_js_start_down && g_js_select_down) {
-				long ms_start = (now.tv_sec - g_js_start_time.tv_sec) * 1000 + (now.tv_usec - g_js_start_time.tv_usec) / 1000;
-				long ms_select = (now.tv_sec - g_js_select_time.tv_sec) * 1000 + (now.tv_usec - g_js_select_time.tv_usec) / 1000;
-				long held_ms = (ms_start < ms_select) ? ms_start : ms_select;
-				if (!g_js_quit_fired && held_ms >= 2000) {
-					LOG_INFO("Quit via controller: START+SELECT held for %ld ms", held_ms);
-					g_stop = 1;
-					g_js_quit_fired = true;
-				}
-			} else {
-				g_js_quit_fired = false;
-			}
+			// Every instance's mpv in multi-video mode
+			for (int i = 0; i < num_players; i++) drain_mpv_events(&players[i]);
 		}
-
 		// Process help toggle request from controller
 		if (g_help_toggle_request) {
 			g_help_toggle_request = 0;
 			if (!g_help_visible) {
-				show_help_overlay(player.mpv);
+				show_help_overlay(player->mpv);
 				g_help_visible = 1;
 			} else {
-				hide_help_overlay(player.mpv);
+				hide_help_overlay(player->mpv);
 				g_help_visible = 0;
 			}
-			g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+			render_cmd_push(RCMD_REDRAW, 0);
+			render_publish(); // plane mode leaves the plane while the help is up
 		}
-		// Prepare pollfds: DRM fd (for page flip events) + mpv wakeup pipe + stdin for keyboard + joystick
-		struct pollfd pfds[4]; int n=0;
-		if (!g_scanout_disabled) { pfds[n].fd = drm.fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++; }
+		// A keystone change that found the back snapshot busy goes out now
+		if (g_snap_pending) render_publish();
+		
+		// Prepare pollfds: mpv wakeup pipe + stdin for keyboard + joystick and its timers + metrics and control sockets/clients
+		struct pollfd pfds[7 + METRICS_MAX_CLIENTS + CTL_MAX_CLIENTS]; int n=0;
 		if (g_mpv_pipe[0] >= 0) { pfds[n].fd = g_mpv_pipe[0]; pfds[n].events = POLLIN; pfds[n].revents = 0; n++; }
 		
 		// Add stdin to the poll set to capture keyboard input
@@ -4218,49 +9697,29 @@ int main(int argc, char **argv) {
 		// Add joystick to poll set if available
 		if (g_joystick_enabled && g_joystick_fd >= 0) {
 			pfds[n].fd = g_joystick_fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++;
+			if (g_input_quit_fd >= 0) { pfds[n].fd = g_input_quit_fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++; }
+			if (g_input_repeat_fd >= 0) { pfds[n].fd = g_input_repeat_fd; pfds[n].events = POLLIN; pfds[n].revents = 0; n++; }
 		}
-		int timeout_ms = -1;
-		
-		// Calculate appropriate poll timeout based on frame rate and vsync
-		if (force_loop || (g_mpv_update_flags & MPV_RENDER_UPDATE_FRAME)) {
-			timeout_ms = 0; // don't block if render pending
-		} else if (frames > 0 && g_vsync_enabled) {
-			// Estimate appropriate timeout based on refresh rate for vsync
-			double refresh_rate = drm.mode.vrefresh ? 
-				(double)drm.mode.vrefresh : 
-				(double)drm.mode.clock / (drm.mode.htotal * drm.mode.vtotal);
-			
-			// Use a more aggressive timeout for better responsiveness
-			// Aim for half the frame interval to ensure we don't miss vsync
-			if (refresh_rate > 0) {
-				timeout_ms = (int)(500.0 / refresh_rate); // half frame time in ms
-				
-				// Clamp to reasonable bounds
-				if (timeout_ms < 4) timeout_ms = 4;       // min 4ms (250fps max)
-				if (timeout_ms > 100) timeout_ms = 100;   // max 100ms (10fps min)
-			} else {
-				timeout_ms = 16; // Default to 60Hz (16.6ms) if refresh rate unknown
-			}
-		}
-		
-		// Add a max timeout to avoid being stuck in poll forever even if no events come
-		// This allows our watchdog logic to run periodically
-		if (timeout_ms < 0) timeout_ms = 100; // max 100ms poll timeout
-
-	int pr = poll(pfds, (nfds_t)n, timeout_ms);
+		int metrics_first = n;
+		int metrics_n = metrics_poll_fds(&pfds[n]);
+		n += metrics_n;
+		int ctl_first = n;
+		n += ctl_poll_fds(&pfds[n]);
+		// Short timeout keeps the watchdog, stats and pending publishes running
+		int pr = poll(pfds, (nfds_t)n, g_snap_pending ? 2 : g_pl.poll_ms > 0 ? g_pl.poll_ms : 100);
 		if (pr < 0) { if (errno == EINTR) continue; fprintf(stderr, "poll failed (%s)\n", strerror(errno)); break; }
 		for (int i=0;i<n;i++) {
 			if (!(pfds[i].revents & POLLIN)) continue;
-			if (pfds[i].fd == drm.fd) {
-				drmEventContext ev = { .version = DRM_EVENT_CONTEXT_VERSION, .page_flip_handler = page_flip_handler };
-				drmHandleEvent(drm.fd, &ev);
-			} else if (pfds[i].fd == g_mpv_pipe[0]) {
+			if (pfds[i].fd == g_mpv_pipe[0]) {
 				unsigned char buf[64]; while (read(g_mpv_pipe[0], buf, sizeof(buf)) > 0) { /* drain */ }
 				g_mpv_wakeup = 1;
 			} else if (pfds[i].fd == STDIN_FILENO) {
-				// Handle keyboard input
-				char c;
-				if (read(STDIN_FILENO, &c, 1) > 0) {
+				// Handle keyboard input: everything buffered at once, one snapshot for all of it
+				char keys[64];
+				ssize_t nkeys = read(STDIN_FILENO, keys, sizeof(keys));
+				bool kb_publish = false;
+				for (ssize_t k = 0; k < nkeys && !g_stop; k++) {
+					char c = keys[k];
 					// Log keypress for debugging (quiet by default)
 					LOG_DEBUG("Key pressed: %d (0x%02x) '%c'", (int)c, (int)c, (c >= 32 && c < 127) ? c : '?');
 					
@@ -4273,20 +9732,20 @@ int main(int argc, char **argv) {
 						LOG_INFO("Keystone correction FORCE enabled, adjusting corner %d", g_keystone.active_corner + 1);
 						fprintf(stderr, "\rKeystone correction FORCE enabled, use arrow keys or WASD to adjust corner %d", 
 								g_keystone.active_corner + 1);
-						g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+						kb_publish = true;
 						continue;
 					}
 					
 					// Help overlay
 					if (c == 'h' && !g_key_seq_state.in_escape_seq) {
 						if (!g_help_visible) {
-							show_help_overlay(player.mpv);
+							show_help_overlay(player->mpv);
 							g_help_visible = 1;
 						} else {
-							hide_help_overlay(player.mpv);
+							hide_help_overlay(player->mpv);
 							g_help_visible = 0;
 						}
-						g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+						render_cmd_push(RCMD_REDRAW, 0);
 						continue;
 					}
 
@@ -4294,8 +9753,7 @@ int main(int argc, char **argv) {
 					bool keystone_handled = keystone_handle_key(c);
 					LOG_DEBUG("Keystone handler returned: %d", keystone_handled);
 					if (keystone_handled) {
-						// Force a redraw when keystone parameters change
-						g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
+						kb_publish = true;
 						continue;
 					}
 					// If not handled by keystone, allow 'q' to quit
@@ -4305,137 +9763,90 @@ int main(int argc, char **argv) {
 						break;
 					}
 				}
+				// Hand the new keystone state to the render thread (implies a redraw)
+				if (kb_publish) render_publish();
 			} else if (g_joystick_enabled && pfds[i].fd == g_joystick_fd) {
-				// Handle joystick input
-				struct js_event event;
-				while (read(g_joystick_fd, &event, sizeof(event)) > 0) {
-					if (handle_joystick_event(&event)) {
-						// Force a redraw when keystone parameters change
-						g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME;
-					}
+				// Handle joystick input: one keystone update and one snapshot per batch
+				bool publish = g_input_evdev ? evdev_read() : joydev_read();
+				input_flush_moves();
+				if (publish) render_publish();
+			} else if (g_joystick_enabled && pfds[i].fd == g_input_repeat_fd) {
+				if (input_timer_read(g_input_repeat_fd) && input_repeat_fire()) {
+					input_flush_moves();
+					render_publish();
+				}
+			} else if (g_joystick_enabled && pfds[i].fd == g_input_quit_fd) {
+				if (input_timer_read(g_input_quit_fd) && g_js_start_down && g_js_select_down) {
+					LOG_INFO("Quit via controller: START+SELECT held for %d ms", INPUT_QUIT_HOLD_MS);
+					g_stop = 1;
 				}
 			}
 		}
+		metrics_service(&pfds[metrics_first], metrics_n, players, num_players);
+		ctl_service(&pfds[ctl_first], n - ctl_first, players, num_players);
 		if (g_mpv_wakeup) {
 			g_mpv_wakeup = 0;
-			drain_mpv_events(player.mpv);
-			if (player.rctx) {
-				uint64_t flags = mpv_render_context_update(player.rctx);
-				g_mpv_update_flags |= flags;
-			}
+			for (int i = 0; i < num_players; i++) drain_mpv_events(&players[i]);
+		}
+		if (g_pl.count) {
+			playlist_step();
+			player = &players[g_pl.cur]; // stats, help overlay and watchdog follow the current item
 		}
 		if (g_stop) break;
 		
-		// Check if we can render a new frame
-		// With triple buffering, we could allow more parallelism, but for stability
-		// we wait until the current flip completes
-		int need_frame = 0;
-		if (frames == 0 && !g_pending_flip) need_frame = 1; // guarantee first frame submission
-		else if (force_loop && !g_pending_flip) need_frame = 1; // continuous mode
-		else if ((g_mpv_update_flags & MPV_RENDER_UPDATE_FRAME) && !g_pending_flip) need_frame = 1;
+		int frames = atomic_load(&g_render_frames);
+		if (g_stats_enabled) stats_log_periodic(player);
+		prof_log_periodic();
+		boot_log_phases();
+		if (g_bench_scenario >= 0) bench_poll(players, num_players);
+		if (g_dual_split) dual_split_sync(&players[0], &players[1]);
+		for (int i = 0; i < num_players; i++) cache_adapt(&players[i]);
 		
-		// Frame pacing: if target FPS is set, throttle frame rate for smooth playback
-		if (need_frame && g_target_fps > 0 && frames > 0) {
-			struct timeval now;
-			gettimeofday(&now, NULL);
-			double elapsed_us = (double)(now.tv_sec - g_last_render_time.tv_sec) * 1000000.0 +
-			                    (double)(now.tv_usec - g_last_render_time.tv_usec);
-			if (elapsed_us < g_frame_interval_us) {
-				// Not enough time has passed, skip this frame
-				need_frame = 0;
-			}
-		}
-
 		// Watchdog: if still no frame after WD_FIRST_MS since start, force once.
-		if (!frames && !need_frame && !wd_forced_first) {
+		if (!frames && !wd_forced_first) {
 			struct timeval now; gettimeofday(&now, NULL);
 			double since = tv_diff(&now, &g_prog_start) * 1000.0; // ms
 			if (since > g_wd_first_ms) {
 				if (g_debug) fprintf(stderr, "[wd] forcing first frame after %.1f ms inactivity\n", since);
-				need_frame = 1; wd_forced_first = 1;
+				render_cmd_push(RCMD_REDRAW, 0);
+				wd_forced_first = 1;
 			}
 		}
 		
+		// Reset stall counter once the render thread has produced frames again
+		if (g_stall_reset_count > 0 && frames > wd_frames_at_reset) wd_stall_cleared();
+		
 		// Ongoing playback stall detection
-		if (frames > 0 && !need_frame && !g_pending_flip) {
-			struct timeval now; gettimeofday(&now, NULL);
-			double since_last_frame = tv_diff(&now, &g_last_frame_time) * 1000.0; // ms
+		if (frames > 0) {
+			double since_last_frame = (double)(mono_now_us() - atomic_load(&g_last_frame_us)) / 1000.0; // ms
 			
-			// If we haven't rendered a frame in g_wd_ongoing_ms, try to recover
-			if (since_last_frame > g_wd_ongoing_ms && g_stall_reset_count < g_max_stall_resets) {
-				fprintf(stderr, "[wd] playback stall detected - no frames for %.1f ms, attempting recovery (attempt %d/%d)\n", 
-					since_last_frame, g_stall_reset_count+1, g_max_stall_resets);
-				
-				// Reset potential stuck state
-				g_pending_flip = 0;
-				g_pending_flips = 0;
-				g_mpv_update_flags |= MPV_RENDER_UPDATE_FRAME; // Force frame rendering
-				need_frame = 1;
-				g_stall_reset_count++;
-				
-				// Try to get mpv back on track by forcing an update
-				if (player.rctx) {
-					uint64_t flags = mpv_render_context_update(player.rctx);
-					g_mpv_update_flags |= flags;
-					
-					// Reset decoder if needed (for more aggressive recovery)
-					if (g_stall_reset_count > 1) {
-						// When looping, first check if we're at the end of the file
-						if (g_loop_playback) {
-							// Get current position and duration
-							double pos = 0, duration = 0;
-							mpv_get_property(player.mpv, "time-pos", MPV_FORMAT_DOUBLE, &pos);
-							mpv_get_property(player.mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
-							
-							// If we're near the end, force a restart
-							if (duration > 0 && pos > (duration - 1.0)) {
-								fprintf(stderr, "[wd] near end of file (%.1f/%.1f), forcing restart for loop\n", pos, duration);
-								const char *cmd[] = {"loadfile", mpv_get_property_string(player.mpv, "path"), "replace", NULL};
-								mpv_command_async(player.mpv, 0, cmd);
-							} else {
-								// Just try to step forward
-								const char *cmd[] = {"frame-step", NULL};
-								mpv_command_async(player.mpv, 0, cmd);
-								fprintf(stderr, "[wd] requesting explicit frame-step for recovery\n");
-							}
-						}
-						
-						// If we're still having issues, try cycling the hardware decoder
-						if (g_stall_reset_count > 2) {
-							const char *cmd[] = {"cycle-values", "hwdec", "drm-copy", "auto-safe", "no", NULL};
-							mpv_command_async(player.mpv, 0, cmd);
-							fprintf(stderr, "[wd] cycling hwdec as part of recovery\n");
-						}
-					}
+			// If we haven't rendered a frame in g_wd_ongoing_ms, classify the stall and try the cheapest fix
+			// (a playlist item holding its last frame while the next one loads is not a stall)
+			if (since_last_frame > g_wd_ongoing_ms && g_stall_reset_count < g_max_stall_resets && !g_pl.eof) {
+				if (wd_idle_by_design(player)) {
+					atomic_store(&g_last_frame_us, mono_now_us()); // idle screen, not a stall
+				} else {
+					wd_stall_recover(player, since_last_frame);
+					wd_frames_at_reset = frames;
 				}
 			}
 		}
-		if (need_frame) {
-			if (g_debug && frames < 10) fprintf(stderr, "[debug] rendering frame #%d flags=0x%llx pending_flip=%d\n", frames, (unsigned long long)g_mpv_update_flags, g_pending_flip);
-			if (!render_frame_fixed(&drm, &eglc, &player)) { 
-				fprintf(stderr, "Render failed, exiting\n"); 
-				break; 
-			}
-			frames++;
-			g_mpv_update_flags &= ~(uint64_t)MPV_RENDER_UPDATE_FRAME;
-			if (g_stats_enabled) { g_stats_frames++; stats_log_periodic(&player); }
-			gettimeofday(&wd_last_activity, NULL);
-			gettimeofday(&g_last_frame_time, NULL); // Update last successful frame time
-			
-			// Reset stall counter after successful frames
-			if (g_stall_reset_count > 0) {
-				// Reset stall counter immediately after successful frame render
-				fprintf(stderr, "[wd] playback resumed normally, resetting stall counter\n");
-				g_stall_reset_count = 0;
-			}
-		}
-		if (force_loop && !need_frame && !g_pending_flip) usleep(1000); // light backoff
 	}
-
-	stats_log_final(&player);
 	
-	// Save keystone settings based on mode
-	if (g_num_videos == 1) {
+	// Stop the render thread and take the EGL context back for teardown
+	g_stop = 1;
+	render_wake();
+	pthread_join(render_tid, NULL);
+	eglMakeCurrent(eglc.dpy, eglc.surf, eglc.surf, eglc.ctx);
+
+	stats_log_final(player);
+	if (g_prof_dump_path) prof_dump(g_prof_dump_path);
+	prof_gpu_destroy();
+	
+	// Save keystone settings based on mode (benchmark scenarios leave saved configs alone)
+	if (g_bench_scenario >= 0) {
+		// nothing to save
+	} else if (g_num_videos == 1) {
 		// Single video mode: save legacy keystone
 		if (g_keystone.enabled) {
 			if (keystone_save_config("./keystone.conf")) {
@@ -4472,10 +9883,10 @@ int main(int argc, char **argv) {
 		cleanup_joystick();
 	}
 	
-	destroy_mpv(&player);
-	if (g_num_videos > 1) {
-		destroy_mpv(&player2);
-	}
+	metrics_close();
+	ctl_close();
+	for (int i = 0; i < MAX_VIDEOS; i++) destroy_mpv(&players[i]);
+	fb_ring_destroy(&eglc);
 	deinit_gbm_egl(&eglc);
 	deinit_drm(&drm);
 	return 0;
@@ -4488,10 +9899,11 @@ fail:
 		cleanup_joystick();
 	}
 	
-	destroy_mpv(&player);
-	if (g_num_videos > 1) {
-		destroy_mpv(&player2);
-	}
+	metrics_close();
+	ctl_close();
+	if (mpv_boot_started) pthread_join(mpv_boot_tid, NULL);
+	for (int i = 0; i < MAX_VIDEOS; i++) destroy_mpv(&players[i]);
+	fb_ring_destroy(&eglc);
 	deinit_gbm_egl(&eglc);
 	deinit_drm(&drm);
 	
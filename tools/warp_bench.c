@@ -0,0 +1,80 @@
+// Microbenchmark for the CPU warp kernels in warp.h (make warp-bench)
+//
+// Times full-grid rebuilds for mesh warps at the sizes keystone
+// adjustment produces, so kernel changes can be compared on the target (RPi4 / Zero 2).
+// Output goes to a plain heap buffer; in the player it is a mapped VBO.
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "warp.h"
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Keep the compiler from discarding the output
+static volatile float g_sink;
+
+static void report(const char *name, int grid, int iters, double secs) {
+    double per_us = secs * 1e6 / iters;
+    double mvert = (double)grid * grid * iters / secs / 1e6;
+    printf("%-28s %4dx%-4d %9.2f us/rebuild %8.1f Mvert/s\n", name, grid, grid, per_us, mvert);
+}
+
+static int bench_mesh(int n, int subdiv, double budget_s) {
+    int grid = (n - 1) * subdiv + 1;
+    float *mx = malloc((size_t)n * (size_t)n * sizeof(float));
+    float *my = malloc((size_t)n * (size_t)n * sizeof(float));
+    float *scratch = malloc(warp_mesh_scratch_floats(n, subdiv) * sizeof(float));
+    float *out = malloc((size_t)grid * (size_t)grid * WARP_VERTEX_FLOATS * sizeof(float));
+    if (!mx || !my || !scratch || !out) {
+        fprintf(stderr, "warp_bench: out of memory\n");
+        free(mx); free(my); free(scratch); free(out);
+        return 1;
+    }
+    // Slightly bowed mesh so the spline does real work
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            float s = (float)c / (float)(n - 1), t = (float)r / (float)(n - 1);
+            mx[r * n + c] = s + 0.02f * t * (1.0f - t);
+            my[r * n + c] = t + 0.02f * s * (1.0f - s);
+        }
+    }
+    const float tex[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+    int iters = 0;
+    double t0 = now_s(), t1;
+    do {
+        for (int k = 0; k < 16; k++, iters++) {
+            mx[0] = 0.001f * (float)(iters & 7);   // a "corner nudge" per rebuild
+            warp_mesh_grid(mx, my, n, subdiv, tex, scratch, out);
+            g_sink = out[(size_t)iters % ((size_t)grid * (size_t)grid * WARP_VERTEX_FLOATS)];
+        }
+        t1 = now_s();
+    } while (t1 - t0 < budget_s);
+    char name[48];
+    snprintf(name, sizeof(name), "mesh %dx%d subdiv %d", n, n, subdiv);
+    report(name, grid, iters, t1 - t0);
+    free(mx); free(my); free(scratch); free(out);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    double budget = argc > 1 ? atof(argv[1]) : 0.5;   // seconds per case
+    if (budget <= 0.0) budget = 0.5;
+#if defined(__ARM_NEON)
+    printf("warp kernels: NEON\n");
+#else
+    printf("warp kernels: scalar\n");
+#endif
+    int rc = 0;
+    rc |= bench_mesh(4, 8, budget);
+    rc |= bench_mesh(10, 8, budget);
+    rc |= bench_mesh(10, 7, budget);        // 64x64 grid
+    rc |= bench_mesh(16, 16, budget);       // densest grid keeping 16-bit indices
+    return rc;
+}
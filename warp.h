@@ -0,0 +1,146 @@
+// CPU warp geometry kernels for pickle: bicubic mesh vertex grids.
+//
+// Header-only so pickle.c stays a single translation unit; tools/warp_bench.c includes
+// the same code for the microbenchmark (make warp-bench). Every kernel writes
+// interleaved x,y,u,v vertices (clip space, texcoords) straight to the output pointer,
+// which may be a mapped VBO: output is written sequentially and never read back.
+// Columns are processed four at a time with NEON, with a scalar loop for the tail
+// and for builds without NEON.
+
+#ifndef PICKLE_WARP_H
+#define PICKLE_WARP_H
+
+#include <stddef.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define WARP_VERTEX_FLOATS 4     // x, y, u, v
+
+// Uniform Catmull-Rom basis at t for control points p0..p3 (the weights sum to 1)
+static inline void warp_catmull_rom_weights(float t, float w[4]) {
+    float t2 = t * t, t3 = t2 * t;
+    w[0] = 0.5f * (-t + 2.0f * t2 - t3);
+    w[1] = 0.5f * (2.0f - 5.0f * t2 + 3.0f * t3);
+    w[2] = 0.5f * (t + 4.0f * t2 - 3.0f * t3);
+    w[3] = 0.5f * (-t2 + t3);
+}
+
+// One control plane padded to (n+2)^2 with the edges linearly extrapolated one point
+// outwards, mapped to clip space on the way (affine maps commute with the spline)
+static inline void warp_pad_plane(const float *src, int n, float scale, float bias, float *dst) {
+    int np = n + 2;
+    for (int r = 0; r < n; r++) {
+        float *d = dst + (size_t)(r + 1) * (size_t)np;
+        const float *s = src + (size_t)r * (size_t)n;
+        for (int c = 0; c < n; c++) d[c + 1] = s[c] * scale + bias;
+        d[0] = 2.0f * d[1] - d[2];
+        d[n + 1] = 2.0f * d[n] - d[n - 1];
+    }
+    const float *r0 = dst + np, *r1 = dst + 2 * np;
+    const float *rl = dst + (size_t)n * (size_t)np, *rl1 = dst + (size_t)(n - 1) * (size_t)np;
+    float *top = dst, *bottom = dst + (size_t)(n + 1) * (size_t)np;
+    for (int c = 0; c < np; c++) {
+        top[c] = 2.0f * r0[c] - r1[c];
+        bottom[c] = 2.0f * rl[c] - rl1[c];
+    }
+}
+
+// Horizontal pass: every padded control row evaluated at each grid column
+static inline void warp_spline_rows(const float *pad, int n, int subdiv, int grid, const float (*w)[4], float *out) {
+    int np = n + 2;
+    for (int r = 0; r < np; r++) {
+        const float *p = pad + (size_t)r * (size_t)np;
+        float *o = out + (size_t)r * (size_t)grid;
+        for (int g = 0; g < grid; g++) {
+            int c = g / subdiv; if (c > n - 2) c = n - 2;
+            const float *wk = w[g - c * subdiv];
+            o[g] = wk[0] * p[c] + wk[1] * p[c + 1] + wk[2] * p[c + 2] + wk[3] * p[c + 3];
+        }
+    }
+}
+
+// Vertical pass for one grid row: blend four horizontal-pass rows and write x,y,u,v vertices
+static inline void warp_emit_mesh_row(const float *hx[4], const float *hy[4], const float wy[4],
+                                      const float *u, float v, int grid, float *out) {
+    int g = 0;
+#if defined(__ARM_NEON)
+    float32x4_t vv = vdupq_n_f32(v);
+    for (; g + 4 <= grid; g += 4) {
+        float32x4x4_t q;
+        q.val[0] = vmulq_n_f32(vld1q_f32(hx[0] + g), wy[0]);
+        q.val[0] = vmlaq_n_f32(q.val[0], vld1q_f32(hx[1] + g), wy[1]);
+        q.val[0] = vmlaq_n_f32(q.val[0], vld1q_f32(hx[2] + g), wy[2]);
+        q.val[0] = vmlaq_n_f32(q.val[0], vld1q_f32(hx[3] + g), wy[3]);
+        q.val[1] = vmulq_n_f32(vld1q_f32(hy[0] + g), wy[0]);
+        q.val[1] = vmlaq_n_f32(q.val[1], vld1q_f32(hy[1] + g), wy[1]);
+        q.val[1] = vmlaq_n_f32(q.val[1], vld1q_f32(hy[2] + g), wy[2]);
+        q.val[1] = vmlaq_n_f32(q.val[1], vld1q_f32(hy[3] + g), wy[3]);
+        q.val[2] = vld1q_f32(u + g);
+        q.val[3] = vv;
+        vst4q_f32(out + (size_t)g * WARP_VERTEX_FLOATS, q); // interleaves the four planes into x,y,u,v
+    }
+#endif
+    for (; g < grid; g++) {
+        float *o = out + (size_t)g * WARP_VERTEX_FLOATS;
+        o[0] = wy[0] * hx[0][g] + wy[1] * hx[1][g] + wy[2] * hx[2][g] + wy[3] * hx[3][g];
+        o[1] = wy[0] * hy[0][g] + wy[1] * hy[1][g] + wy[2] * hy[2][g] + wy[3] * hy[3][g];
+        o[2] = u[g];
+        o[3] = v;
+    }
+}
+
+/**
+ * Scratch floats warp_mesh_grid() needs for an n x n mesh at a subdivision
+ *
+ * @param n Control points per side (>= 2)
+ * @param subdiv Grid steps per mesh cell (>= 1)
+ */
+static inline size_t warp_mesh_scratch_floats(int n, int subdiv) {
+    size_t np = (size_t)n + 2, grid = (size_t)(n - 1) * (size_t)subdiv + 1;
+    return 2 * np * np + 2 * np * grid + grid + ((size_t)subdiv + 1) * 4;
+}
+
+/**
+ * Tessellate a bicubic Catmull-Rom control mesh into a grid of x,y,u,v vertices.
+ * The surface is separable: each padded control row is splined along x once, then
+ * every output row blends four of those rows.
+ *
+ * @param mx,my Control points, normalized screen coordinates (SoA, row-major n x n)
+ * @param n Control points per side (>= 2)
+ * @param subdiv Grid steps per cell; the grid has (n-1)*subdiv+1 vertices per side
+ * @param tex u0, u1, v0, v1 at the left/right/top/bottom edges
+ * @param scratch warp_mesh_scratch_floats(n, subdiv) floats
+ * @param out grid*grid*WARP_VERTEX_FLOATS floats, written in order (may be a mapped VBO)
+ */
+static inline void warp_mesh_grid(const float *mx, const float *my, int n, int subdiv, const float tex[4],
+                                  float *scratch, float *out) {
+    int grid = (n - 1) * subdiv + 1;
+    size_t np = (size_t)n + 2;
+    size_t pad_n = np * np, rows_n = np * (size_t)grid;
+    float *pad_x = scratch, *pad_y = pad_x + pad_n;
+    float *rows_x = pad_y + pad_n, *rows_y = rows_x + rows_n;
+    float *u = rows_y + rows_n;
+    float (*w)[4] = (float (*)[4])(u + grid);
+
+    for (int k = 0; k <= subdiv; k++) warp_catmull_rom_weights((float)k / (float)subdiv, w[k]);
+    for (int g = 0; g < grid; g++) u[g] = tex[0] + (tex[1] - tex[0]) * (float)g / (float)(grid - 1);
+    warp_pad_plane(mx, n, 2.0f, -1.0f, pad_x);   // normalized -> clip space
+    warp_pad_plane(my, n, -2.0f, 1.0f, pad_y);
+    warp_spline_rows(pad_x, n, subdiv, grid, (const float (*)[4])w, rows_x);
+    warp_spline_rows(pad_y, n, subdiv, grid, (const float (*)[4])w, rows_y);
+
+    for (int gi = 0; gi < grid; gi++) {
+        int ci = gi / subdiv; if (ci > n - 2) ci = n - 2;
+        const float *hx[4], *hy[4];
+        for (int a = 0; a < 4; a++) {
+            hx[a] = rows_x + (size_t)(ci + a) * (size_t)grid;
+            hy[a] = rows_y + (size_t)(ci + a) * (size_t)grid;
+        }
+        float tv = (float)gi / (float)(grid - 1);
+        warp_emit_mesh_row(hx, hy, w[gi - ci * subdiv], u, tex[2] + (tex[3] - tex[2]) * tv, grid,
+                           out + (size_t)gi * (size_t)grid * WARP_VERTEX_FLOATS);
+    }
+}
+
+#endif // PICKLE_WARP_H